@@ -383,6 +383,7 @@ endif
 	ifeq ($(strip $(LED_MATRIX_DRIVER)), IS31FL3742A)
         OPT_DEFS += -DIS31FLCOMMON -DIS31FL3742A -DSTM32_I2C -DHAL_USE_I2C=TRUE
         COMMON_VPATH += $(DRIVER_PATH)/led/issi
+        COMMON_VPATH += $(DRIVER_PATH)/led
         SRC += is31flcommon.c
         QUANTUM_LIB_SRC += i2c_master.c
     endif
@@ -390,6 +391,7 @@ endif
 	ifeq ($(strip $(LED_MATRIX_DRIVER)), IS31FL3743A)
         OPT_DEFS += -DIS31FLCOMMON -DIS31FL3743A -DSTM32_I2C -DHAL_USE_I2C=TRUE
         COMMON_VPATH += $(DRIVER_PATH)/led/issi
+        COMMON_VPATH += $(DRIVER_PATH)/led
         SRC += is31flcommon.c
         QUANTUM_LIB_SRC += i2c_master.c
     endif
@@ -397,6 +399,7 @@ endif
 	ifeq ($(strip $(LED_MATRIX_DRIVER)), IS31FL3745)
         OPT_DEFS += -DIS31FLCOMMON -DIS31FL3745 -DSTM32_I2C -DHAL_USE_I2C=TRUE
         COMMON_VPATH += $(DRIVER_PATH)/led/issi
+        COMMON_VPATH += $(DRIVER_PATH)/led
         SRC += is31flcommon.c
         QUANTUM_LIB_SRC += i2c_master.c
     endif
@@ -404,6 +407,7 @@ endif
 	ifeq ($(strip $(LED_MATRIX_DRIVER)), IS31FL3746A)
         OPT_DEFS += -DIS31FLCOMMON -DIS31FL3746A -DSTM32_I2C -DHAL_USE_I2C=TRUE
         COMMON_VPATH += $(DRIVER_PATH)/led/issi
+        COMMON_VPATH += $(DRIVER_PATH)/led
         SRC += is31flcommon.c
         QUANTUM_LIB_SRC += i2c_master.c
     endif
@@ -435,6 +439,7 @@ endif
     SRC += $(QUANTUM_DIR)/color.c
     SRC += $(QUANTUM_DIR)/rgb_matrix/rgb_matrix.c
     SRC += $(QUANTUM_DIR)/rgb_matrix/rgb_matrix_drivers.c
+    SRC += $(QUANTUM_DIR)/rgb_matrix/rgb_matrix_grid.c
     SRC += $(LIB_PATH)/lib8tion/lib8tion.c
     CIE1931_CURVE := yes
     RGB_KEYCODES_ENABLE := yes
@@ -477,6 +482,7 @@ endif
 	ifeq ($(strip $(RGB_MATRIX_DRIVER)), IS31FL3742A)
         OPT_DEFS += -DIS31FLCOMMON -DIS31FL3742A -DSTM32_I2C -DHAL_USE_I2C=TRUE
         COMMON_VPATH += $(DRIVER_PATH)/led/issi
+        COMMON_VPATH += $(DRIVER_PATH)/led
         SRC += is31flcommon.c
         QUANTUM_LIB_SRC += i2c_master.c
     endif
@@ -484,6 +490,7 @@ endif
 	ifeq ($(strip $(RGB_MATRIX_DRIVER)), IS31FL3743A)
         OPT_DEFS += -DIS31FLCOMMON -DIS31FL3743A -DSTM32_I2C -DHAL_USE_I2C=TRUE
         COMMON_VPATH += $(DRIVER_PATH)/led/issi
+        COMMON_VPATH += $(DRIVER_PATH)/led
         SRC += is31flcommon.c
         QUANTUM_LIB_SRC += i2c_master.c
     endif
@@ -491,6 +498,7 @@ endif
 	ifeq ($(strip $(RGB_MATRIX_DRIVER)), IS31FL3745)
         OPT_DEFS += -DIS31FLCOMMON -DIS31FL3745 -DSTM32_I2C -DHAL_USE_I2C=TRUE
         COMMON_VPATH += $(DRIVER_PATH)/led/issi
+        COMMON_VPATH += $(DRIVER_PATH)/led
         SRC += is31flcommon.c
         QUANTUM_LIB_SRC += i2c_master.c
     endif
@@ -498,6 +506,7 @@ endif
 	ifeq ($(strip $(RGB_MATRIX_DRIVER)), IS31FL3746A)
         OPT_DEFS += -DIS31FLCOMMON -DIS31FL3746A -DSTM32_I2C -DHAL_USE_I2C=TRUE
         COMMON_VPATH += $(DRIVER_PATH)/led/issi
+        COMMON_VPATH += $(DRIVER_PATH)/led
         SRC += is31flcommon.c
         QUANTUM_LIB_SRC += i2c_master.c
     endif
@@ -541,6 +550,11 @@ ifneq ($(strip $(VARIABLE_TRACE)),no)
     endif
 endif
 
+ifeq ($(strip $(LATENCY_TRACE_ENABLE)), yes)
+    SRC += $(QUANTUM_DIR)/latency_trace.c
+    OPT_DEFS += -DLATENCY_TRACE_ENABLE
+endif
+
 ifeq ($(strip $(SLEEP_LED_ENABLE)), yes)
     SRC += $(PLATFORM_COMMON_DIR)/sleep_led.c
     OPT_DEFS += -DSLEEP_LED_ENABLE
@@ -548,6 +562,18 @@ ifeq ($(strip $(SLEEP_LED_ENABLE)), yes)
     NO_SUSPEND_POWER_DOWN := yes
 endif
 
+ifeq ($(strip $(MATRIX_INTERRUPT_ENABLE)), yes)
+    ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
+        $(call CATASTROPHIC_ERROR,Invalid MATRIX_INTERRUPT_ENABLE,MATRIX_INTERRUPT_ENABLE is not supported on split keyboards)
+    endif
+    SRC += $(PLATFORM_COMMON_DIR)/matrix_interrupt.c
+    OPT_DEFS += -DMATRIX_INTERRUPT_ENABLE
+endif
+
+ifeq ($(strip $(TICKLESS_IDLE_ENABLE)), yes)
+    OPT_DEFS += -DTICKLESS_IDLE_ENABLE
+endif
+
 VALID_BACKLIGHT_TYPES := pwm timer software custom
 
 BACKLIGHT_ENABLE ?= no
@@ -683,7 +709,8 @@ ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
     # Determine which (if any) transport files are required
     ifneq ($(strip $(SPLIT_TRANSPORT)), custom)
         QUANTUM_SRC += $(QUANTUM_DIR)/split_common/transport.c \
-                       $(QUANTUM_DIR)/split_common/transactions.c
+                       $(QUANTUM_DIR)/split_common/transactions.c \
+                       $(QUANTUM_DIR)/split_common/matrix_delta.c
 
         OPT_DEFS += -DSPLIT_COMMON_TRANSACTIONS
 
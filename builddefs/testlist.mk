@@ -4,9 +4,14 @@ FULL_TESTS := $(notdir $(TEST_LIST))
 include $(QUANTUM_PATH)/debounce/tests/testlist.mk
 include $(QUANTUM_PATH)/encoder/tests/testlist.mk
 include $(QUANTUM_PATH)/os_detection/tests/testlist.mk
+include $(QUANTUM_PATH)/painter/tests/testlist.mk
+include $(QUANTUM_PATH)/rgb_matrix/tests/testlist.mk
 include $(QUANTUM_PATH)/sequencer/tests/testlist.mk
+include $(QUANTUM_PATH)/split_common/tests/testlist.mk
 include $(QUANTUM_PATH)/wear_leveling/tests/testlist.mk
 include $(PLATFORM_PATH)/test/testlist.mk
+include $(PLATFORM_PATH)/chibios/drivers/tests/testlist.mk
+include $(TMK_PATH)/protocol/chibios/tests/testlist.mk
 
 define VALIDATE_TEST_LIST
     ifneq ($1,)
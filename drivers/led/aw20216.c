@@ -16,6 +16,7 @@
 
 #include "aw20216.h"
 #include "spi_master.h"
+#include "led_flush.h"
 
 /* The AW20216 appears to be somewhat similar to the IS31FL743, although quite
  * a few things are different, such as the command byte format and page ordering.
@@ -61,12 +62,27 @@
 #    define AW_SPI_DIVISOR 4
 #endif
 
-uint8_t g_pwm_buffer[DRIVER_COUNT][AW_PWM_REGISTER_COUNT];
-bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
+// Each bit marks a changed SW row (CS1~CS18) of the PWM buffer.
+// Only changed rows are sent by AW20216_update_pwm_buffers().
+#define AW_PWM_CHUNK_SIZE 18
+#define AW_PWM_CHUNK_COUNT (AW_PWM_REGISTER_COUNT / AW_PWM_CHUNK_SIZE)
+
+uint8_t                  g_pwm_buffer[DRIVER_COUNT][AW_PWM_REGISTER_COUNT];
+bool                     g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
+static volatile uint16_t g_pwm_buffer_dirty[DRIVER_COUNT]           = {0};
+
+// Bytes sent over SPI, counted over the last whole second
+static led_flush_counter_t bytes_sent = {0};
+
+uint32_t AW20216_get_bytes_per_second(void) {
+    return led_flush_bytes_per_second(&bytes_sent);
+}
 
 bool AW20216_write(pin_t cs_pin, uint8_t page, uint8_t reg, uint8_t* data, uint8_t len) {
     static uint8_t s_spi_transfer_buffer[2] = {0};
 
+    led_flush_count_bytes(&bytes_sent, len + 2);
+
     if (!spi_start(cs_pin, false, AW_SPI_MODE, AW_SPI_DIVISOR)) {
         spi_stop();
         return false;
@@ -122,14 +138,22 @@ void AW20216_init(pin_t cs_pin, pin_t en_pin) {
     AW20216_soft_enable(cs_pin);
 }
 
+// Only mark the buffer for an update when the value actually changes
+static inline void AW20216_set_pwm_buffer(uint8_t driver, uint8_t reg, uint8_t value) {
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        led_flush_mark_dirty(&g_pwm_buffer_dirty[driver], reg / AW_PWM_CHUNK_SIZE);
+        g_pwm_buffer_update_required[driver] = true;
+    }
+}
+
 void AW20216_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     aw_led led;
     memcpy_P(&led, (&g_aw_leds[index]), sizeof(led));
 
-    g_pwm_buffer[led.driver][led.r]          = red;
-    g_pwm_buffer[led.driver][led.g]          = green;
-    g_pwm_buffer[led.driver][led.b]          = blue;
-    g_pwm_buffer_update_required[led.driver] = true;
+    AW20216_set_pwm_buffer(led.driver, led.r, red);
+    AW20216_set_pwm_buffer(led.driver, led.g, green);
+    AW20216_set_pwm_buffer(led.driver, led.b, blue);
 }
 
 void AW20216_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
@@ -140,7 +164,21 @@ void AW20216_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
 
 void AW20216_update_pwm_buffers(pin_t cs_pin, uint8_t index) {
     if (g_pwm_buffer_update_required[index]) {
-        AW20216_write(cs_pin, AW_PAGE_PWM, 0, g_pwm_buffer[index], AW_PWM_REGISTER_COUNT);
+        // Take the changed rows before sending, so changes made meanwhile go out with the next update
+        g_pwm_buffer_update_required[index] = false;
+        uint16_t dirty                      = led_flush_take_dirty(&g_pwm_buffer_dirty[index]);
+
+        // Send each run of changed rows as one transfer, rows which failed
+        // to send are retried on the next update
+        uint8_t first, end = 0;
+        while (led_flush_next_run(dirty, AW_PWM_CHUNK_COUNT, &first, &end)) {
+            uint8_t offset = first * AW_PWM_CHUNK_SIZE;
+            if (!AW20216_write(cs_pin, AW_PAGE_PWM, offset, g_pwm_buffer[index] + offset, (end - first) * AW_PWM_CHUNK_SIZE)) {
+                led_flush_restore_dirty(&g_pwm_buffer_dirty[index], dirty);
+                g_pwm_buffer_update_required[index] = true;
+                break;
+            }
+            dirty &= ~led_flush_run_mask(first, end);
+        }
     }
-    g_pwm_buffer_update_required[index] = false;
 }
@@ -35,6 +35,9 @@ void AW20216_set_color(int index, uint8_t red, uint8_t green, uint8_t blue);
 void AW20216_set_color_all(uint8_t red, uint8_t green, uint8_t blue);
 void AW20216_update_pwm_buffers(pin_t cs_pin, uint8_t index);
 
+// Bytes written over SPI during the last second, for tuning the flush rate
+uint32_t AW20216_get_bytes_per_second(void);
+
 #define CS1_SW1 0x00
 #define CS2_SW1 0x01
 #define CS3_SW1 0x02
@@ -16,6 +16,8 @@
 
 #include "ckled2001.h"
 #include "i2c_master.h"
+#include "led_flush.h"
+#include "util.h"
 #include "wait.h"
 
 #ifndef CKLED2001_TIMEOUT
@@ -47,13 +49,27 @@ uint8_t g_twi_transfer_buffer[65];
 uint8_t g_pwm_buffer[DRIVER_COUNT][192];
 bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
 
+// Each bit marks a changed 16 byte chunk of the PWM buffer.
+// Only changed chunks are sent by CKLED2001_update_pwm_buffers().
+#define CKLED2001_PWM_CHUNK_SIZE 16
+#define CKLED2001_PWM_CHUNK_COUNT (192 / CKLED2001_PWM_CHUNK_SIZE)
+static volatile uint16_t g_pwm_buffer_dirty[DRIVER_COUNT] = {0};
+
 uint8_t g_led_control_registers[DRIVER_COUNT][24]             = {0};
 bool    g_led_control_registers_update_required[DRIVER_COUNT] = {false};
 
+// Bytes sent over I2C, counted over the last whole second
+static led_flush_counter_t bytes_sent = {0};
+
+uint32_t CKLED2001_get_bytes_per_second(void) {
+    return led_flush_bytes_per_second(&bytes_sent);
+}
+
 bool CKLED2001_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
     // If the transaction fails function returns false.
     g_twi_transfer_buffer[0] = reg;
     g_twi_transfer_buffer[1] = data;
+    led_flush_count_bytes(&bytes_sent, 2);
 
 #if CKLED2001_PERSISTENCE > 0
     for (uint8_t i = 0; i < CKLED2001_PERSISTENCE; i++) {
@@ -69,29 +85,32 @@ bool CKLED2001_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
     return true;
 }
 
-bool CKLED2001_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+static bool CKLED2001_write_pwm_range(uint8_t addr, uint8_t *pwm_buffer, uint8_t start, uint8_t length) {
     // Assumes PG1 is already selected.
     // If any of the transactions fails function returns false.
-    // Transmit PWM registers in 3 transfers of 64 bytes.
+    // Transmit PWM registers in transfers of at most 64 bytes.
 
     // Iterate over the pwm_buffer contents at 64 byte intervals.
-    for (uint8_t i = 0; i < 192; i += 64) {
+    for (uint8_t i = start; i < start + length; i += 64) {
+        uint8_t transfer_size = MIN(start + length - i, 64);
+
         g_twi_transfer_buffer[0] = i;
-        // Copy the data from i to i+63.
+        // Copy the data from i to i+transfer_size-1.
         // Device will auto-increment register for data after the first byte
         // Thus this sets registers 0x00-0x0F, 0x10-0x1F, etc. in one transfer.
-        for (uint8_t j = 0; j < 64; j++) {
+        for (uint8_t j = 0; j < transfer_size; j++) {
             g_twi_transfer_buffer[1 + j] = pwm_buffer[i + j];
         }
+        led_flush_count_bytes(&bytes_sent, transfer_size + 1);
 
 #if CKLED2001_PERSISTENCE > 0
         for (uint8_t i = 0; i < CKLED2001_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 65, CKLED2001_TIMEOUT) != 0) {
+            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, transfer_size + 1, CKLED2001_TIMEOUT) != 0) {
                 return false;
             }
         }
 #else
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 65, CKLED2001_TIMEOUT) != 0) {
+        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, transfer_size + 1, CKLED2001_TIMEOUT) != 0) {
             return false;
         }
 #endif
@@ -99,6 +118,10 @@ bool CKLED2001_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
     return true;
 }
 
+bool CKLED2001_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+    return CKLED2001_write_pwm_range(addr, pwm_buffer, 0, 192);
+}
+
 void CKLED2001_init(uint8_t addr) {
     // Select to function page
     CKLED2001_write_register(addr, CONFIGURE_CMD_PAGE, FUNCTION_PAGE);
@@ -145,15 +168,23 @@ void CKLED2001_init(uint8_t addr) {
     CKLED2001_write_register(addr, CONFIGURATION_REG, MSKSW_NORMAL_MODE);
 }
 
+// Only mark the buffer for an update when the value actually changes
+static inline void CKLED2001_set_pwm_buffer(uint8_t driver, uint8_t reg, uint8_t value) {
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        led_flush_mark_dirty(&g_pwm_buffer_dirty[driver], reg / CKLED2001_PWM_CHUNK_SIZE);
+        g_pwm_buffer_update_required[driver] = true;
+    }
+}
+
 void CKLED2001_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     ckled2001_led led;
     if (index >= 0 && index < RGB_MATRIX_LED_COUNT) {
         memcpy_P(&led, (&g_ckled2001_leds[index]), sizeof(led));
 
-        g_pwm_buffer[led.driver][led.r]          = red;
-        g_pwm_buffer[led.driver][led.g]          = green;
-        g_pwm_buffer[led.driver][led.b]          = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        CKLED2001_set_pwm_buffer(led.driver, led.r, red);
+        CKLED2001_set_pwm_buffer(led.driver, led.g, green);
+        CKLED2001_set_pwm_buffer(led.driver, led.b, blue);
     }
 }
 
@@ -195,15 +226,27 @@ void CKLED2001_set_led_control_register(uint8_t index, bool red, bool green, boo
 
 void CKLED2001_update_pwm_buffers(uint8_t addr, uint8_t index) {
     if (g_pwm_buffer_update_required[index]) {
+        // Take the changed chunks before sending, so changes made meanwhile go out with the next update
+        g_pwm_buffer_update_required[index] = false;
+        uint16_t dirty                      = led_flush_take_dirty(&g_pwm_buffer_dirty[index]);
+
         CKLED2001_write_register(addr, CONFIGURE_CMD_PAGE, LED_PWM_PAGE);
 
+        // Send each run of changed chunks as one transfer.
         // If any of the transactions fail we risk writing dirty PG0,
-        // refresh page 0 just in case.
-        if (!CKLED2001_write_pwm_buffer(addr, g_pwm_buffer[index])) {
-            g_led_control_registers_update_required[index] = true;
+        // refresh page 0 just in case. Chunks not yet sent are retried
+        // on the next update.
+        uint8_t first, end = 0;
+        while (led_flush_next_run(dirty, CKLED2001_PWM_CHUNK_COUNT, &first, &end)) {
+            if (!CKLED2001_write_pwm_range(addr, g_pwm_buffer[index], first * CKLED2001_PWM_CHUNK_SIZE, (end - first) * CKLED2001_PWM_CHUNK_SIZE)) {
+                led_flush_restore_dirty(&g_pwm_buffer_dirty[index], dirty);
+                g_pwm_buffer_update_required[index]            = true;
+                g_led_control_registers_update_required[index] = true;
+                break;
+            }
+            dirty &= ~led_flush_run_mask(first, end);
         }
     }
-    g_pwm_buffer_update_required[index] = false;
 }
 
 void CKLED2001_update_led_control_registers(uint8_t addr, uint8_t index) {
@@ -48,6 +48,9 @@ void CKLED2001_update_led_control_registers(uint8_t addr, uint8_t index);
 void CKLED2001_sw_return_normal(uint8_t addr);
 void CKLED2001_sw_shutdown(uint8_t addr);
 
+// Bytes written over I2C during the last second, for tuning the flush rate
+uint32_t CKLED2001_get_bytes_per_second(void);
+
 // Registers Page Define
 #define CONFIGURE_CMD_PAGE 0xFD
 #define LED_CONTROL_PAGE 0x00
@@ -20,6 +20,7 @@
 
 #include "is31flcommon.h"
 #include "i2c_master.h"
+#include "led_flush.h"
 #include "wait.h"
 #include <string.h>
 
@@ -39,6 +40,20 @@ uint8_t g_twi_transfer_buffer[20];
 uint8_t g_pwm_buffer[DRIVER_COUNT][ISSI_MAX_LEDS];
 bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
 
+// The PWM buffer is flushed in ISSI_PWM_TRF_SIZE chunks, only those which changed are written.
+#define ISSI_PWM_CHUNK_COUNT ((ISSI_MAX_LEDS + ISSI_PWM_TRF_SIZE - 1) / ISSI_PWM_TRF_SIZE)
+#if ISSI_PWM_CHUNK_COUNT > 16
+#    error "Too many PWM transfer chunks, increase ISSI_PWM_TRF_SIZE"
+#endif
+static volatile uint16_t g_pwm_buffer_dirty[DRIVER_COUNT] = {0};
+
+// Bytes sent over I2C, counted over the last whole second
+static led_flush_counter_t bytes_sent = {0};
+
+uint32_t IS31FL_get_bytes_per_second(void) {
+    return led_flush_bytes_per_second(&bytes_sent);
+}
+
 uint8_t g_scaling_buffer[DRIVER_COUNT][ISSI_SCALING_SIZE];
 bool    g_scaling_buffer_update_required[DRIVER_COUNT] = {false};
 
@@ -48,6 +63,7 @@ void IS31FL_write_single_register(uint8_t addr, uint8_t reg, uint8_t data) {
     g_twi_transfer_buffer[0] = reg;
     g_twi_transfer_buffer[1] = data;
 
+    led_flush_count_bytes(&bytes_sent, 2);
 #if ISSI_PERSISTENCE > 0
     for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
         if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT) == 0) break;
@@ -68,6 +84,7 @@ bool IS31FL_write_multi_registers(uint8_t addr, uint8_t *source_buffer, uint8_t
         // Copy the section of our source buffer into the transfer buffer after first register address
         memcpy(g_twi_transfer_buffer + 1, source_buffer + i, transfer_size);
 
+        led_flush_count_bytes(&bytes_sent, transfer_size + 1);
 #if ISSI_PERSISTENCE > 0
         for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
             if (i2c_transmit(addr << 1, g_twi_transfer_buffer, transfer_size + 1, ISSI_TIMEOUT) != 0) {
@@ -122,12 +139,33 @@ void IS31FL_common_init(uint8_t addr, uint8_t ssr) {
 
 void IS31FL_common_update_pwm_register(uint8_t addr, uint8_t index) {
     if (g_pwm_buffer_update_required[index]) {
+        // Take the changed chunks before sending, so changes made meanwhile go out with the next update
+        g_pwm_buffer_update_required[index] = false;
+        uint16_t dirty                      = led_flush_take_dirty(&g_pwm_buffer_dirty[index]);
+
         // Queue up the correct page
         IS31FL_unlock_register(addr, ISSI_PAGE_PWM);
-        // Hand off the update to IS31FL_write_multi_registers
-        IS31FL_write_multi_registers(addr, g_pwm_buffer[index], ISSI_MAX_LEDS, ISSI_PWM_TRF_SIZE, ISSI_PWM_REG_1ST);
-        // Update flags that pwm_buffer has been updated
-        g_pwm_buffer_update_required[index] = false;
+        // Hand off each run of changed chunks to IS31FL_write_multi_registers,
+        // chunks which failed to send are retried on the next update
+        uint8_t first, end = 0;
+        while (led_flush_next_run(dirty, ISSI_PWM_CHUNK_COUNT, &first, &end)) {
+            uint8_t offset = first * ISSI_PWM_TRF_SIZE;
+            if (!IS31FL_write_multi_registers(addr, g_pwm_buffer[index] + offset, (end - first) * ISSI_PWM_TRF_SIZE, ISSI_PWM_TRF_SIZE, ISSI_PWM_REG_1ST + offset)) {
+                led_flush_restore_dirty(&g_pwm_buffer_dirty[index], dirty);
+                g_pwm_buffer_update_required[index] = true;
+                break;
+            }
+            dirty &= ~led_flush_run_mask(first, end);
+        }
+    }
+}
+
+// Only mark the buffer for an update when the value actually changes
+static inline void IS31FL_set_pwm_buffer(uint8_t driver, uint8_t reg, uint8_t value) {
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        led_flush_mark_dirty(&g_pwm_buffer_dirty[driver], reg / ISSI_PWM_TRF_SIZE);
+        g_pwm_buffer_update_required[driver] = true;
     }
 }
 
@@ -171,10 +209,9 @@ void IS31FL_RGB_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < RGB_MATRIX_LED_COUNT) {
         is31_led led = g_is31_leds[index];
 
-        g_pwm_buffer[led.driver][led.r]          = red;
-        g_pwm_buffer[led.driver][led.g]          = green;
-        g_pwm_buffer[led.driver][led.b]          = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL_set_pwm_buffer(led.driver, led.r, red);
+        IS31FL_set_pwm_buffer(led.driver, led.g, green);
+        IS31FL_set_pwm_buffer(led.driver, led.b, blue);
     }
 }
 
@@ -220,8 +257,7 @@ void IS31FL_simple_set_scaling_buffer(uint8_t index, bool value) {
 void IS31FL_simple_set_brightness(int index, uint8_t value) {
     if (index >= 0 && index < LED_MATRIX_LED_COUNT) {
         is31_led led = g_is31_leds[index];
-        g_pwm_buffer[led.driver][led.v] = value;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL_set_pwm_buffer(led.driver, led.v, value);
     }
 }
 
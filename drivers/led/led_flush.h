@@ -0,0 +1,81 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "timer.h"
+#include "atomic_util.h"
+
+/* Helpers shared by the LED drivers which only flush the changed chunks of their PWM buffers */
+
+/* Finds the next run of dirty chunks at or after *end, returning it as [*first, *end) */
+static inline bool led_flush_next_run(uint16_t dirty, uint8_t chunk_count, uint8_t *first, uint8_t *end) {
+    uint8_t chunk = *end;
+    while (chunk < chunk_count && !(dirty & (1 << chunk))) {
+        chunk++;
+    }
+    if (chunk >= chunk_count) {
+        return false;
+    }
+    *first = chunk;
+    while (chunk < chunk_count && (dirty & (1 << chunk))) {
+        chunk++;
+    }
+    *end = chunk;
+    return true;
+}
+
+/* Marks a chunk as changed since it was last sent */
+static inline void led_flush_mark_dirty(volatile uint16_t *dirty, uint8_t chunk) {
+    ATOMIC_BLOCK_FORCEON {
+        *dirty |= 1 << chunk;
+    }
+}
+
+/* Takes the dirty bits before sending, so chunks changed while the transfer
+ * is in flight, e.g. from another thread, stay dirty for the next one */
+static inline uint16_t led_flush_take_dirty(volatile uint16_t *dirty) {
+    uint16_t taken;
+    ATOMIC_BLOCK_FORCEON {
+        taken  = *dirty;
+        *dirty = 0;
+    }
+    return taken;
+}
+
+/* Hands back the dirty bits of chunks which could not be sent */
+static inline void led_flush_restore_dirty(volatile uint16_t *dirty, uint16_t bits) {
+    ATOMIC_BLOCK_FORCEON {
+        *dirty |= bits;
+    }
+}
+
+/* Dirty bits of the chunks in [first, end) */
+static inline uint16_t led_flush_run_mask(uint8_t first, uint8_t end) {
+    return (uint16_t)(((1UL << end) - 1) & ~((1UL << first) - 1));
+}
+
+/* Bytes sent over the bus, counted over the last whole second */
+typedef struct {
+    uint32_t bytes;
+    uint32_t bytes_last_second;
+    uint32_t timestamp;
+} led_flush_counter_t;
+
+static inline void led_flush_count_bytes(led_flush_counter_t *counter, uint32_t length) {
+    uint32_t elapsed = timer_elapsed32(counter->timestamp);
+    if (elapsed >= 1000) {
+        counter->bytes_last_second = elapsed < 2000 ? counter->bytes : 0;
+        counter->bytes             = 0;
+        counter->timestamp         = timer_read32();
+    }
+    counter->bytes += length;
+}
+
+static inline uint32_t led_flush_bytes_per_second(led_flush_counter_t *counter) {
+    led_flush_count_bytes(counter, 0);
+    return counter->bytes_last_second;
+}
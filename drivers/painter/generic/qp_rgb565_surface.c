@@ -7,6 +7,14 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Common
 
+// Dirty region, inclusive on all sides
+typedef struct surface_dirty_rect_t {
+    uint16_t l;
+    uint16_t t;
+    uint16_t r;
+    uint16_t b;
+} surface_dirty_rect_t;
+
 // Device definition
 typedef struct rgb565_surface_painter_device_t {
     struct painter_driver_t base; // must be first, so it can be cast to/from the painter_device_t* type
@@ -24,12 +32,13 @@ typedef struct rgb565_surface_painter_device_t {
     uint16_t pixdata_x;
     uint16_t pixdata_y;
 
-    // Maintain a dirty region so we can stream only what we need
-    bool     is_dirty;
-    uint16_t dirty_l;
-    uint16_t dirty_t;
-    uint16_t dirty_r;
-    uint16_t dirty_b;
+    // Maintain dirty regions so we can stream only what we need
+    surface_dirty_rect_t dirty[RGB565_SURFACE_DIRTY_RECTS];
+    uint8_t              dirty_count;
+    uint8_t              dirty_last; // the region most recently grown, checked first
+
+    // Transfer statistics of the last draw
+    qp_rgb565_surface_stats_t stats;
 
 } rgb565_surface_painter_device_t;
 
@@ -55,25 +64,91 @@ static inline void increment_pixdata_location(rgb565_surface_painter_device_t *s
     }
 }
 
-static inline void setpixel(rgb565_surface_painter_device_t *surface, uint16_t x, uint16_t y, uint16_t rgb565) {
-    // Skip messing with the dirty info if the original value already matches
-    if (surface->buffer[y * surface->base.panel_width + x] != rgb565) {
-        // Maintain dirty region
-        if (surface->dirty_l > x) {
-            surface->dirty_l = x;
-        }
-        if (surface->dirty_r < x) {
-            surface->dirty_r = x;
+static inline uint32_t dirty_rect_area(uint16_t l, uint16_t t, uint16_t r, uint16_t b) {
+    return (uint32_t)(r - l + 1) * (b - t + 1);
+}
+
+// Whether the point is inside the region, or close enough to it that growing the region is cheaper than a new transfer
+static inline bool dirty_rect_near(const surface_dirty_rect_t *rect, uint16_t x, uint16_t y) {
+    return x + RGB565_SURFACE_DIRTY_MERGE_DISTANCE >= rect->l && x <= rect->r + RGB565_SURFACE_DIRTY_MERGE_DISTANCE && y + RGB565_SURFACE_DIRTY_MERGE_DISTANCE >= rect->t && y <= rect->b + RGB565_SURFACE_DIRTY_MERGE_DISTANCE;
+}
+
+static inline void dirty_rect_grow(surface_dirty_rect_t *rect, uint16_t l, uint16_t t, uint16_t r, uint16_t b) {
+    if (rect->l > l) {
+        rect->l = l;
+    }
+    if (rect->t > t) {
+        rect->t = t;
+    }
+    if (rect->r < r) {
+        rect->r = r;
+    }
+    if (rect->b < b) {
+        rect->b = b;
+    }
+}
+
+static void mark_dirty(rgb565_surface_painter_device_t *surface, uint16_t x, uint16_t y) {
+    // Streamed pixels usually land in the same region as the previous one
+    if (surface->dirty_count > 0 && dirty_rect_near(&surface->dirty[surface->dirty_last], x, y)) {
+        dirty_rect_grow(&surface->dirty[surface->dirty_last], x, y, x, y);
+        return;
+    }
+
+    for (uint8_t i = 0; i < surface->dirty_count; ++i) {
+        if (dirty_rect_near(&surface->dirty[i], x, y)) {
+            dirty_rect_grow(&surface->dirty[i], x, y, x, y);
+            surface->dirty_last = i;
+            return;
         }
-        if (surface->dirty_t > y) {
-            surface->dirty_t = y;
+    }
+
+    if (surface->dirty_count < RGB565_SURFACE_DIRTY_RECTS) {
+        surface->dirty[surface->dirty_count] = (surface_dirty_rect_t){x, y, x, y};
+        surface->dirty_last                  = surface->dirty_count++;
+        return;
+    }
+
+    // Out of regions, grow whichever one gains the least area
+    uint8_t  best        = 0;
+    uint32_t best_growth = UINT32_MAX;
+    for (uint8_t i = 0; i < surface->dirty_count; ++i) {
+        surface_dirty_rect_t grown = surface->dirty[i];
+        dirty_rect_grow(&grown, x, y, x, y);
+        uint32_t growth = dirty_rect_area(grown.l, grown.t, grown.r, grown.b) - dirty_rect_area(surface->dirty[i].l, surface->dirty[i].t, surface->dirty[i].r, surface->dirty[i].b);
+        if (growth < best_growth) {
+            best        = i;
+            best_growth = growth;
         }
-        if (surface->dirty_b < y) {
-            surface->dirty_b = y;
+    }
+    dirty_rect_grow(&surface->dirty[best], x, y, x, y);
+    surface->dirty_last = best;
+}
+
+// Regions grow independently and can end up overlapping, merge those so no pixel is sent twice
+static void coalesce_dirty(rgb565_surface_painter_device_t *surface) {
+    bool merged;
+    do {
+        merged = false;
+        for (uint8_t i = 0; i < surface->dirty_count && !merged; ++i) {
+            for (uint8_t j = i + 1; j < surface->dirty_count && !merged; ++j) {
+                surface_dirty_rect_t *a = &surface->dirty[i];
+                surface_dirty_rect_t *b = &surface->dirty[j];
+                if (a->l <= b->r && b->l <= a->r && a->t <= b->b && b->t <= a->b) {
+                    dirty_rect_grow(a, b->l, b->t, b->r, b->b);
+                    *b     = surface->dirty[--surface->dirty_count];
+                    merged = true;
+                }
+            }
         }
+    } while (merged);
+}
 
-        // Always dirty after a setpixel
-        surface->is_dirty = true;
+static inline void setpixel(rgb565_surface_painter_device_t *surface, uint16_t x, uint16_t y, uint16_t rgb565) {
+    // Skip messing with the dirty info if the original value already matches
+    if (surface->buffer[y * surface->base.panel_width + x] != rgb565) {
+        // Maintain dirty regions
+        mark_dirty(surface, x, y);
 
         // Update the pixel data in the buffer
         surface->buffer[y * surface->base.panel_width + x] = rgb565;
@@ -115,9 +190,8 @@ static bool qp_rgb565_surface_clear(painter_device_t device) {
 static bool qp_rgb565_surface_flush(painter_device_t device) {
     struct painter_driver_t *        driver  = (struct painter_driver_t *)device;
     rgb565_surface_painter_device_t *surface = (rgb565_surface_painter_device_t *)driver;
-    surface->dirty_l = surface->dirty_t = UINT16_MAX;
-    surface->dirty_r = surface->dirty_b = 0;
-    surface->is_dirty                   = false;
+    surface->dirty_count = 0;
+    surface->dirty_last  = 0;
     return true;
 }
 
@@ -233,17 +307,9 @@ painter_device_t qp_rgb565_make_surface(uint16_t panel_width, uint16_t panel_hei
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Drawing routine to copy out the dirty region and send it to another device
 
-bool qp_rgb565_surface_draw(painter_device_t surface, painter_device_t display, uint16_t x, uint16_t y) {
-    struct painter_driver_t *        surface_driver = (struct painter_driver_t *)surface;
-    rgb565_surface_painter_device_t *surface_handle = (rgb565_surface_painter_device_t *)surface_driver;
-
-    // If we're not dirty... we're done.
-    if (!surface_handle->is_dirty) {
-        return true;
-    }
-
+static bool qp_rgb565_surface_draw_rect(rgb565_surface_painter_device_t *surface_handle, painter_device_t display, uint16_t x, uint16_t y, const surface_dirty_rect_t *rect) {
     // Set the target drawing area
-    bool ok = qp_viewport(display, x + surface_handle->dirty_l, y + surface_handle->dirty_t, x + surface_handle->dirty_r, y + surface_handle->dirty_b);
+    bool ok = qp_viewport(display, x + rect->l, y + rect->t, x + rect->r, y + rect->b);
     if (!ok) {
         return false;
     }
@@ -254,8 +320,8 @@ bool qp_rgb565_surface_draw(painter_device_t surface, painter_device_t display,
     uint16_t *target_buffer     = (uint16_t *)qp_internal_global_pixdata_buffer;
 
     // Fill the global pixdata area so that we can start transferring to the panel
-    for (uint16_t y = surface_handle->dirty_t; y <= surface_handle->dirty_b; ++y) {
-        for (uint16_t x = surface_handle->dirty_l; x <= surface_handle->dirty_r; ++x) {
+    for (uint16_t y = rect->t; y <= rect->b; ++y) {
+        for (uint16_t x = rect->l; x <= rect->r; ++x) {
             // Update the target buffer
             target_buffer[pixel_counter++] = surface_handle->buffer[y * surface_handle->base.panel_width + x];
 
@@ -279,6 +345,38 @@ bool qp_rgb565_surface_draw(painter_device_t surface, painter_device_t display,
         }
     }
 
+    surface_handle->stats.rects++;
+    surface_handle->stats.bytes += dirty_rect_area(rect->l, rect->t, rect->r, rect->b) * sizeof(uint16_t);
+    return true;
+}
+
+bool qp_rgb565_surface_draw(painter_device_t surface, painter_device_t display, uint16_t x, uint16_t y) {
+    struct painter_driver_t *        surface_driver = (struct painter_driver_t *)surface;
+    rgb565_surface_painter_device_t *surface_handle = (rgb565_surface_painter_device_t *)surface_driver;
+
+    surface_handle->stats.rects = 0;
+    surface_handle->stats.bytes = 0;
+
+    // If we're not dirty... we're done.
+    if (surface_handle->dirty_count == 0) {
+        return true;
+    }
+
+    // Send each dirty region through its own viewport
+    coalesce_dirty(surface_handle);
+    surface_handle->dirty_last = 0;
+    for (uint8_t i = 0; i < surface_handle->dirty_count; ++i) {
+        if (!qp_rgb565_surface_draw_rect(surface_handle, display, x, y, &surface_handle->dirty[i])) {
+            return false;
+        }
+    }
+
     // Clear the dirty info for the surface
     return qp_flush(surface);
 }
+
+qp_rgb565_surface_stats_t qp_rgb565_surface_get_stats(painter_device_t surface) {
+    struct painter_driver_t *        surface_driver = (struct painter_driver_t *)surface;
+    rgb565_surface_painter_device_t *surface_handle = (rgb565_surface_painter_device_t *)surface_driver;
+    return surface_handle->stats;
+}
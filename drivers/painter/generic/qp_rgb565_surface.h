@@ -1,5 +1,7 @@
 // Copyright 2022 Nick Brassel (@tzarc)
 // SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
 #include "qp_internal.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -13,6 +15,22 @@
 #    define RGB565_SURFACE_NUM_DEVICES 1
 #endif
 
+#ifndef RGB565_SURFACE_DIRTY_RECTS
+/**
+ * @def This controls the maximum number of separate dirty regions tracked per surface. Each region is sent to the
+ *      display through its own viewport, so changes far apart on the surface do not drag the area in between along.
+ */
+#    define RGB565_SURFACE_DIRTY_RECTS 4
+#endif
+
+#ifndef RGB565_SURFACE_DIRTY_MERGE_DISTANCE
+/**
+ * @def Changed pixels within this many pixels of an existing dirty region grow that region rather than starting a new
+ *      one, as setting up another viewport costs more than sending a few extra pixels.
+ */
+#    define RGB565_SURFACE_DIRTY_MERGE_DISTANCE 8
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Forward declarations
 
@@ -39,4 +57,17 @@ painter_device_t qp_rgb565_make_surface(uint16_t panel_width, uint16_t panel_hei
  * @return whether the draw operation completed successfully
  */
 bool qp_rgb565_surface_draw(painter_device_t surface, painter_device_t display, uint16_t x, uint16_t y);
+
+typedef struct qp_rgb565_surface_stats_t {
+    uint32_t bytes; // pixel data sent to the display
+    uint8_t  rects; // dirty regions sent, each with its own viewport
+} qp_rgb565_surface_stats_t;
+
+/**
+ * Retrieves the amount of data sent by the last call to qp_rgb565_surface_draw().
+ *
+ * @param surface[in] the surface to query
+ * @return the transfer statistics of the last draw
+ */
+qp_rgb565_surface_stats_t qp_rgb565_surface_get_stats(painter_device_t surface);
 #endif // QUANTUM_PAINTER_RGB565_SURFACE_ENABLE
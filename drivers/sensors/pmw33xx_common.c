@@ -27,6 +27,35 @@ static bool in_burst_right[ARRAY_SIZE(cs_pins_right)] = {0};
 bool __attribute__((cold)) pmw33xx_upload_firmware(uint8_t sensor);
 bool __attribute__((cold)) pmw33xx_check_signature(uint8_t sensor);
 
+#ifdef PMW33XX_MOTION_INTERRUPT
+#    if !defined(PROTOCOL_CHIBIOS)
+#        error "PMW33XX_MOTION_INTERRUPT is only supported on ChibiOS"
+#    endif
+#    if !defined(PMW33XX_MOTION_PIN)
+#        error "PMW33XX_MOTION_INTERRUPT requires PMW33XX_MOTION_PIN"
+#    endif
+#    if defined(POINTING_DEVICE_MOTION_PIN)
+#        error "POINTING_DEVICE_MOTION_PIN cannot be used with PMW33XX_MOTION_INTERRUPT, use PMW33XX_MOTION_PIN instead"
+#    endif
+#    if !defined(PAL_USE_CALLBACKS) || (PAL_USE_CALLBACKS != TRUE)
+#        error "PMW33XX_MOTION_INTERRUPT requires PAL_USE_CALLBACKS to be set to TRUE in halconf.h"
+#    endif
+#    if !defined(SPI_USE_MUTUAL_EXCLUSION) || (SPI_USE_MUTUAL_EXCLUSION != TRUE)
+#        error "PMW33XX_MOTION_INTERRUPT requires SPI_USE_MUTUAL_EXCLUSION to be set to TRUE in halconf.h"
+#    endif
+
+// Keeps the sampling thread from reading the sensor in the middle of, or too soon after, another register access
+static MUTEX_DECL(sensor_mutex);
+#    define pmw33xx_lock() chMtxLock(&sensor_mutex)
+#    define pmw33xx_unlock() chMtxUnlock(&sensor_mutex)
+
+static void             pmw33xx_motion_start(void);
+static pmw33xx_report_t pmw33xx_motion_take(void);
+#else
+#    define pmw33xx_lock()
+#    define pmw33xx_unlock()
+#endif
+
 void pmw33xx_set_cpi_all_sensors(uint16_t cpi) {
     for (uint8_t sensor = 0; sensor < pmw33xx_number_of_sensors; sensor++) {
         pmw33xx_set_cpi(sensor, cpi);
@@ -43,7 +72,7 @@ bool pmw33xx_spi_start(uint8_t sensor) {
     return true;
 }
 
-bool pmw33xx_write(uint8_t sensor, uint8_t reg_addr, uint8_t data) {
+static bool pmw33xx_write_register(uint8_t sensor, uint8_t reg_addr, uint8_t data) {
     if (!pmw33xx_spi_start(sensor)) {
         return false;
     }
@@ -68,7 +97,14 @@ bool pmw33xx_write(uint8_t sensor, uint8_t reg_addr, uint8_t data) {
     return true;
 }
 
-uint8_t pmw33xx_read(uint8_t sensor, uint8_t reg_addr) {
+bool pmw33xx_write(uint8_t sensor, uint8_t reg_addr, uint8_t data) {
+    pmw33xx_lock();
+    bool success = pmw33xx_write_register(sensor, reg_addr, data);
+    pmw33xx_unlock();
+    return success;
+}
+
+static uint8_t pmw33xx_read_register(uint8_t sensor, uint8_t reg_addr) {
     if (!pmw33xx_spi_start(sensor)) {
         return 0;
     }
@@ -88,6 +124,13 @@ uint8_t pmw33xx_read(uint8_t sensor, uint8_t reg_addr) {
     return data;
 }
 
+uint8_t pmw33xx_read(uint8_t sensor, uint8_t reg_addr) {
+    pmw33xx_lock();
+    uint8_t data = pmw33xx_read_register(sensor, reg_addr);
+    pmw33xx_unlock();
+    return data;
+}
+
 bool pmw33xx_check_signature(uint8_t sensor) {
     uint8_t signature_dump[3] = {
         pmw33xx_read(sensor, REG_Product_ID),
@@ -175,19 +218,21 @@ bool pmw33xx_init(uint8_t sensor) {
         return false;
     }
 
+#ifdef PMW33XX_MOTION_INTERRUPT
+    if (sensor == 0) {
+        pmw33xx_motion_start();
+    }
+#endif
+
     return true;
 }
 
-pmw33xx_report_t pmw33xx_read_burst(uint8_t sensor) {
+static pmw33xx_report_t pmw33xx_read_burst_register(uint8_t sensor) {
     pmw33xx_report_t report = {0};
 
-    if (sensor >= pmw33xx_number_of_sensors) {
-        return report;
-    }
-
     if (!in_burst[sensor]) {
         pd_dprintf("PMW33XX (%d): burst\n", sensor);
-        if (!pmw33xx_write(sensor, REG_Motion_Burst, 0x00)) {
+        if (!pmw33xx_write_register(sensor, REG_Motion_Burst, 0x00)) {
             return report;
         }
         in_burst[sensor] = true;
@@ -209,10 +254,140 @@ pmw33xx_report_t pmw33xx_read_burst(uint8_t sensor) {
 
     spi_stop();
 
-    pd_dprintf("PMW33XX (%d): motion: 0x%x dx: %i dy: %i\n", sensor, report.motion.w, report.delta_x, report.delta_y);
-
     report.delta_x *= -1;
     report.delta_y *= -1;
 
     return report;
 }
+
+pmw33xx_report_t pmw33xx_read_burst(uint8_t sensor) {
+    pmw33xx_report_t report = {0};
+
+    if (sensor >= pmw33xx_number_of_sensors) {
+        return report;
+    }
+
+#ifdef PMW33XX_MOTION_INTERRUPT
+    if (sensor == 0) {
+        report = pmw33xx_motion_take();
+    } else
+#endif
+    {
+        pmw33xx_lock();
+        report = pmw33xx_read_burst_register(sensor);
+        pmw33xx_unlock();
+    }
+
+    pd_dprintf("PMW33XX (%d): motion: 0x%x dx: %i dy: %i\n", sensor, report.motion.w, report.delta_x, report.delta_y);
+
+    return report;
+}
+
+#ifdef PMW33XX_MOTION_INTERRUPT
+/* The first sensor is sampled by a thread woken by its MOTION pin, rather than
+ * by the pointing device task. Each sample is a single burst read, and samples
+ * wait in a ring buffer until the pointing device task takes them.
+ */
+
+static pmw33xx_report_t   motion_buffer[PMW33XX_MOTION_BUFFER_SIZE];
+static uint8_t            motion_head    = 0;
+static uint8_t            motion_count   = 0;
+static uint16_t           motion_dropped = 0;
+static volatile bool      motion_pending = false;
+static thread_reference_t motion_thread  = NULL;
+
+/* Adds the motion in one report to another, unless it would overflow */
+static bool pmw33xx_motion_add(pmw33xx_report_t* into, const pmw33xx_report_t* report) {
+    int32_t x = (int32_t)into->delta_x + report->delta_x;
+    int32_t y = (int32_t)into->delta_y + report->delta_y;
+    if (x != (int16_t)x || y != (int16_t)y) {
+        return false;
+    }
+    into->motion.w    = report->motion.w;
+    into->observation = report->observation;
+    into->delta_x     = x;
+    into->delta_y     = y;
+    return true;
+}
+
+static void pmw33xx_motion_push(const pmw33xx_report_t* report) {
+    chSysLock();
+    if (motion_count < PMW33XX_MOTION_BUFFER_SIZE) {
+        motion_buffer[(motion_head + motion_count) % PMW33XX_MOTION_BUFFER_SIZE] = *report;
+        motion_count++;
+    } else if (!pmw33xx_motion_add(&motion_buffer[(motion_head + motion_count - 1) % PMW33XX_MOTION_BUFFER_SIZE], report)) {
+        motion_dropped++;
+    }
+    chSysUnlock();
+}
+
+/* Sums up the waiting samples, leaving any that would overflow the report for next time */
+static pmw33xx_report_t pmw33xx_motion_take(void) {
+    pmw33xx_report_t report = {0};
+    uint16_t         dropped;
+
+    chSysLock();
+    while (motion_count > 0 && pmw33xx_motion_add(&report, &motion_buffer[motion_head])) {
+        motion_head = (motion_head + 1) % PMW33XX_MOTION_BUFFER_SIZE;
+        motion_count--;
+    }
+    dropped        = motion_dropped;
+    motion_dropped = 0;
+    chSysUnlock();
+
+    if (dropped) {
+        pd_dprintf("PMW33XX (0): %u samples dropped\n", dropped);
+    }
+    return report;
+}
+
+static void pmw33xx_motion_callback(void* arg) {
+    (void)arg;
+
+    chSysLockFromISR();
+    motion_pending = true;
+    chThdResumeI(&motion_thread, MSG_OK);
+    chSysUnlockFromISR();
+}
+
+static THD_WORKING_AREA(pmw33xx_motion_thread_wa, PMW33XX_MOTION_THREAD_STACK);
+static THD_FUNCTION(pmw33xx_motion_thread, arg) {
+    (void)arg;
+    chRegSetThreadName("pmw33xx");
+
+    while (true) {
+        // MOTION stays asserted until the burst has been read, so only sleep once it has been released
+        chSysLock();
+        if (!motion_pending && readPin(PMW33XX_MOTION_PIN)) {
+            chThdSuspendS(&motion_thread);
+        }
+        motion_pending = false;
+        chSysUnlock();
+
+        pmw33xx_lock();
+        pmw33xx_report_t report = pmw33xx_read_burst_register(0);
+        pmw33xx_unlock();
+
+        if (report.motion.b.is_motion) {
+            pmw33xx_motion_push(&report);
+        } else {
+            // Nothing to read, most likely a failed read; don't spin on a stuck MOTION pin
+            chThdSleepMilliseconds(1);
+        }
+    }
+}
+
+static void pmw33xx_motion_start(void) {
+    static bool started = false;
+    if (started) {
+        return;
+    }
+    started = true;
+
+    // MOTION is an open drain output, and asserted low
+    setPinInputHigh(PMW33XX_MOTION_PIN);
+    palEnableLineEvent(PMW33XX_MOTION_PIN, PAL_EVENT_MODE_FALLING_EDGE);
+    palSetLineCallback(PMW33XX_MOTION_PIN, pmw33xx_motion_callback, NULL);
+    chThdCreateStatic(pmw33xx_motion_thread_wa, sizeof(pmw33xx_motion_thread_wa), PMW33XX_MOTION_THREAD_PRIORITY, pmw33xx_motion_thread, NULL);
+}
+#endif
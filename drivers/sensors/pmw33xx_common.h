@@ -61,6 +61,22 @@ _Static_assert(sizeof((pmw33xx_report_t){0}.motion) == 1, "pmw33xx_report_t.moti
 #    define ROTATIONAL_TRANSFORM_ANGLE 0x00
 #endif
 
+#ifdef PMW33XX_MOTION_INTERRUPT
+// Samples which can wait for the pointing device task, further samples are added to the last one
+#    if !defined(PMW33XX_MOTION_BUFFER_SIZE)
+#        define PMW33XX_MOTION_BUFFER_SIZE 16
+#    endif
+
+#    if !defined(PMW33XX_MOTION_THREAD_PRIORITY)
+#        define PMW33XX_MOTION_THREAD_PRIORITY (NORMALPRIO + 1)
+#    endif
+
+// Enough for pd_dprintf() in the burst read when POINTING_DEVICE_DEBUG is on
+#    if !defined(PMW33XX_MOTION_THREAD_STACK)
+#        define PMW33XX_MOTION_THREAD_STACK 512
+#    endif
+#endif
+
 #if ROTATIONAL_TRANSFORM_ANGLE > 127 || ROTATIONAL_TRANSFORM_ANGLE < (-127)
 #    error ROTATIONAL_TRANSFORM_ANGLE has to be in the range of +/- 127 for all PMW33XX sensors.
 #endif
@@ -143,7 +159,8 @@ void pmw33xx_set_cpi_all_sensors(uint16_t cpi);
 
 /**
  * @brief Reads and clears the current delta, and motion register values on the
- * given sensor.
+ * given sensor. With PMW33XX_MOTION_INTERRUPT, the first sensor's samples since
+ * the last call are summed instead.
  *
  * @param sensor Index of the sensors chip select pin
  * @return pmw33xx_report_t Current values of the sensor, if errors occurred all
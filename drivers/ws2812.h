@@ -74,3 +74,20 @@
  *         - Wait 50us to reset the LEDs
  */
 void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds);
+
+#ifdef WS2812_DOUBLE_BUFFER
+#    if !defined(WS2812_DRIVER_SPI) && !defined(WS2812_DRIVER_PWM)
+#        error "WS2812_DOUBLE_BUFFER is only supported by the spi and pwm drivers"
+#    endif
+
+// Longest ws2812_setleds() waits for a queued frame to start sending, in ms: a little over two frames
+#    ifndef WS2812_DOUBLE_BUFFER_TIMEOUT
+#        define WS2812_DOUBLE_BUFFER_TIMEOUT (2 * (WS2812_LED_COUNT * 32 * WS2812_TIMING / 1000 + WS2812_TRST_US) / 1000 + 2)
+#    endif
+
+/*
+ * Returns false while a frame is queued behind the one being sent. Calling
+ * ws2812_setleds() then waits for the queued frame to start sending.
+ */
+bool ws2812_ready(void);
+#endif
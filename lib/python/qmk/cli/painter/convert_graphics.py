@@ -14,6 +14,7 @@ from PIL import Image
 @cli.argument('-o', '--output', default='', help='Specify output directory. Defaults to same directory as input.')
 @cli.argument('-f', '--format', required=True, help='Output format, valid types: %s' % (', '.join(valid_formats.keys())))
 @cli.argument('-r', '--no-rle', arg_only=True, action='store_true', help='Disables the use of RLE when encoding images.')
+@cli.argument('-l', '--lz', arg_only=True, action='store_true', help='Allows QMK LZ compression when it is smaller than RLE. Requires QUANTUM_PAINTER_SUPPORTS_LZ in firmware.')
 @cli.argument('-d', '--no-deltas', arg_only=True, action='store_true', help='Disables the use of delta frames when encoding animations.')
 @cli.argument('-w', '--raw', arg_only=True, action='store_true', help='Writes out the QGF file as raw data instead of c/h combo.')
 @cli.subcommand('Converts an input image to something QMK understands')
@@ -51,7 +52,7 @@ def painter_convert_graphics(cli):
 
     # Convert the image to QGF using PIL
     out_data = BytesIO()
-    input_img.save(out_data, "QGF", use_deltas=(not cli.args.no_deltas), use_rle=(not cli.args.no_rle), qmk_format=format, verbose=cli.args.verbose)
+    input_img.save(out_data, "QGF", use_deltas=(not cli.args.no_deltas), use_rle=(not cli.args.no_rle), use_lz=cli.args.lz, qmk_format=format, verbose=cli.args.verbose)
     out_bytes = out_data.getvalue()
 
     if cli.args.raw:
@@ -64,7 +65,7 @@ def painter_convert_graphics(cli):
     subs = {
         'generated_type': 'image',
         'var_prefix': 'gfx',
-        'generator_command': f'qmk painter-convert-graphics -i {cli.args.input.name} -f {cli.args.format}',
+        'generator_command': f'qmk painter-convert-graphics -i {cli.args.input.name} -f {cli.args.format}{" --lz" if cli.args.lz else ""}',
         'year': datetime.date.today().strftime("%Y"),
         'input_file': cli.args.input.name,
         'sane_name': re.sub(r"[^a-zA-Z0-9]", "_", cli.args.input.stem),
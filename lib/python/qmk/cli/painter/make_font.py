@@ -33,6 +33,7 @@ def painter_make_font_image(cli):
 @cli.argument('-u', '--unicode-glyphs', default='', help='Also generate the specified unicode glyphs.')
 @cli.argument('-f', '--format', required=True, help='Output format, valid types: %s' % (', '.join(valid_formats.keys())))
 @cli.argument('-r', '--no-rle', arg_only=True, action='store_true', help='Disable the use of RLE to minimise converted image size.')
+@cli.argument('-l', '--lz', arg_only=True, action='store_true', help='Allows QMK LZ compression when it is smaller than RLE. Requires QUANTUM_PAINTER_SUPPORTS_LZ in firmware.')
 @cli.argument('-w', '--raw', arg_only=True, action='store_true', help='Writes out the QFF file as raw data instead of c/h combo.')
 @cli.subcommand('Converts an input font image to something QMK firmware understands')
 def painter_convert_font_image(cli):
@@ -53,7 +54,7 @@ def painter_convert_font_image(cli):
 
     # Render out the data
     out_data = BytesIO()
-    font.save_to_qff(format, (False if cli.args.no_rle else True), out_data)
+    font.save_to_qff(format, (False if cli.args.no_rle else True), out_data, use_lz=cli.args.lz)
     out_bytes = out_data.getvalue()
 
     if cli.args.raw:
@@ -66,7 +67,7 @@ def painter_convert_font_image(cli):
     subs = {
         'generated_type': 'font',
         'var_prefix': 'font',
-        'generator_command': f'qmk painter-convert-font-image -i {cli.args.input.name} -f {cli.args.format}',
+        'generator_command': f'qmk painter-convert-font-image -i {cli.args.input.name} -f {cli.args.format}{" --lz" if cli.args.lz else ""}',
         'year': datetime.date.today().strftime("%Y"),
         'input_file': cli.args.input.name,
         'sane_name': re.sub(r"[^a-zA-Z0-9]", "_", cli.args.input.stem),
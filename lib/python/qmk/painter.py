@@ -336,3 +336,62 @@ def compress_bytes_qmk_rle(bytearray):
                 temp = []
                 repeat = False
     return output
+
+
+def compress_bytes_qmk_lz(bytearray):
+    """Compresses using QMK LZ: literal runs as per QMK RLE, and copies of up to 130 bytes from the last 256 bytes of output.
+    """
+    min_match = 3
+    max_match = 130
+    max_literal = 128
+    window = 256
+
+    output = []
+    literals = []
+    chains = {}
+
+    def flush_literals():
+        while len(literals) > 0:
+            run = literals[:max_literal]
+            del literals[:max_literal]
+            output.append(127 + len(run))
+            output.extend(run)
+
+    def remember(pos):
+        if pos + min_match <= len(bytearray):
+            chains.setdefault(bytes(bytearray[pos:pos + min_match]), []).append(pos)
+
+    n = 0
+    while n < len(bytearray):
+        # Find the longest match within the window, preferring the closest
+        best_len = 0
+        best_dist = 0
+        candidates = chains.get(bytes(bytearray[n:n + min_match]), [])
+        for start in reversed(candidates):
+            if n - start > window:
+                break
+            length = 0
+            limit = min(max_match, len(bytearray) - n)
+            while length < limit and bytearray[start + length] == bytearray[n + length]:
+                length += 1
+            if length > best_len:
+                best_len = length
+                best_dist = n - start
+                if length == limit:
+                    break
+
+        if best_len >= min_match:
+            flush_literals()
+            output.append(best_len - min_match)
+            output.append(best_dist - 1)
+            for i in range(best_len):
+                remember(n + i)
+            n += best_len
+        else:
+            literals.append(bytearray[n])
+            remember(n)
+            n += 1
+
+    flush_literals()
+    return output
+
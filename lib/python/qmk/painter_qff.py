@@ -185,9 +185,10 @@ class QFFFont:
         self.glyph_height = 0
         return
 
-    def _extract_glyphs(self, format):
+    def _extract_glyphs(self, format, use_lz: bool = False):
         total_data_size = 0
         total_rle_data_size = 0
+        total_lz_data_size = 0
 
         converted_img = qmk.painter.convert_requested_format(self.image, format)
         (self.palette, _) = qmk.painter.convert_image_bytes(converted_img, format)
@@ -201,8 +202,12 @@ class QFFFont:
             total_rle_data_size += len(this_glyph_rle_bytes)
             glyph_entry['image_uncompressed_bytes'] = this_glyph_image_bytes
             glyph_entry['image_compressed_bytes'] = this_glyph_rle_bytes
+            if use_lz:
+                this_glyph_lz_bytes = qmk.painter.compress_bytes_qmk_lz(this_glyph_image_bytes)
+                total_lz_data_size += len(this_glyph_lz_bytes)
+                glyph_entry['image_lz_bytes'] = this_glyph_lz_bytes
 
-        return (total_data_size, total_rle_data_size)
+        return (total_data_size, total_rle_data_size, total_lz_data_size)
 
     def _parse_image(self, img, include_ascii_glyphs: bool = True, unicode_glyphs: str = ''):
         # Clear out any existing font metadata
@@ -325,22 +330,28 @@ class QFFFont:
         self._parse_image(Image.open(str(img_file)), include_ascii_glyphs, unicode_glyphs)
         return
 
-    def save_to_qff(self, format: Dict[str, Any], use_rle: bool, fp):
+    def save_to_qff(self, format: Dict[str, Any], use_rle: bool, fp, use_lz: bool = False):
         # Drop out if there's no image loaded
         if self.image is None:
             self.logger.error('No image is loaded.')
             return
 
-        # Work out if we want to use RLE at all, skipping it if it's not any smaller (it's applied per-glyph)
-        (total_data_size, total_rle_data_size) = self._extract_glyphs(format)
+        # Work out if we want to use RLE or LZ at all, skipping them if they're not any smaller (they're applied per-glyph)
+        (total_data_size, total_rle_data_size, total_lz_data_size) = self._extract_glyphs(format, use_lz)
         if use_rle:
             use_rle = (total_rle_data_size < total_data_size)
+        if use_lz:
+            use_lz = (total_lz_data_size < (total_rle_data_size if use_rle else total_data_size))
+            use_rle = use_rle and not use_lz
 
         # For each glyph, work out which image data we want to use and append it to the image buffer, recording the byte-wise offset
         img_buffer = bytes()
         for _, glyph_entry in self.glyph_data.items():
             glyph_entry['data_offset'] = len(img_buffer)
-            glyph_img_bytes = glyph_entry.image_compressed_bytes if use_rle else glyph_entry.image_uncompressed_bytes
+            if use_lz:
+                glyph_img_bytes = glyph_entry.image_lz_bytes
+            else:
+                glyph_img_bytes = glyph_entry.image_compressed_bytes if use_rle else glyph_entry.image_uncompressed_bytes
             img_buffer += bytes(glyph_img_bytes)
 
         font_descriptor = QFFFontDescriptor()
@@ -365,7 +376,7 @@ class QFFFont:
         font_descriptor.unicode_glyph_count = len(unicode_table.glyphs.keys())
         font_descriptor.is_transparent = False
         font_descriptor.format = format['image_format_byte']
-        font_descriptor.compression = 0x01 if use_rle else 0x00
+        font_descriptor.compression = 0x02 if use_lz else (0x01 if use_rle else 0x00)  # See qp.h, painter_compression_t
 
         # Write a dummy font descriptor -- we'll have to come back and write it properly once we've rendered out everything else
         font_descriptor_location = fp.tell()
@@ -0,0 +1,97 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+#include "matrix_interrupt.h"
+#include "timer.h"
+
+/* Pin change interrupts are used, which are only available on a subset of
+ * ports. Port B is PCINT0..7 on every supported part with pin change
+ * interrupts; the ATmega328 additionally maps ports C and D.
+ */
+
+static volatile bool edge_pending = false;
+
+static volatile uint8_t *pcmsk_for_pin(pin_t pin, uint8_t *pcie) {
+    switch (pin >> PORT_SHIFTER) {
+#if defined(PCMSK0) && defined(PINB_ADDRESS)
+        case PINB_ADDRESS:
+            *pcie = _BV(PCIE0);
+            return &PCMSK0;
+#endif
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__)
+        case PINC_ADDRESS:
+            *pcie = _BV(PCIE1);
+            return &PCMSK1;
+        case PIND_ADDRESS:
+            *pcie = _BV(PCIE2);
+            return &PCMSK2;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+bool matrix_interrupt_enable_pin(pin_t pin) {
+    uint8_t           pcie;
+    volatile uint8_t *pcmsk = pcmsk_for_pin(pin, &pcie);
+    if (!pcmsk) {
+        return false;
+    }
+
+    *pcmsk |= _BV(pin & 0xF);
+    PCIFR = pcie;
+    PCICR |= pcie;
+    return true;
+}
+
+void matrix_interrupt_disable_pin(pin_t pin) {
+    uint8_t           pcie;
+    volatile uint8_t *pcmsk = pcmsk_for_pin(pin, &pcie);
+    if (!pcmsk) {
+        return;
+    }
+
+    *pcmsk &= ~_BV(pin & 0xF);
+    if (!*pcmsk) {
+        PCICR &= ~pcie;
+    }
+}
+
+bool matrix_interrupt_pending(void) {
+    return edge_pending;
+}
+
+void matrix_interrupt_clear(void) {
+    edge_pending = false;
+}
+
+void matrix_interrupt_wait(uint32_t timeout_ms) {
+    // Idle sleep keeps timer0 running, so the 1ms timer interrupt wakes us up
+    // to check the timeout and tapping/housekeeping timers keep working.
+    const uint32_t start = timer_read32();
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    while (timer_elapsed32(start) < timeout_ms) {
+        cli();
+        if (edge_pending) {
+            sei();
+            break;
+        }
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+    }
+}
+
+#if defined(PCINT0_vect)
+ISR(PCINT0_vect) {
+    edge_pending = true;
+}
+#endif
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__)
+ISR(PCINT1_vect, ISR_ALIASOF(PCINT0_vect));
+ISR(PCINT2_vect, ISR_ALIASOF(PCINT0_vect));
+#endif
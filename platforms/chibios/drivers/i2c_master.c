@@ -107,6 +107,19 @@ static const I2CConfig i2cconfig = {
 #endif
 };
 
+/**
+ * @brief Serialises transactions when the bus is shared between threads, for
+ * example with RGB_MATRIX_FLUSH_ASYNC. Requires I2C_USE_MUTUAL_EXCLUSION in
+ * halconf.h, otherwise these are no-ops.
+ */
+#if I2C_USE_MUTUAL_EXCLUSION == TRUE
+#    define i2c_acquire_bus() i2cAcquireBus(&I2C_DRIVER)
+#    define i2c_release_bus() i2cReleaseBus(&I2C_DRIVER)
+#else
+#    define i2c_acquire_bus()
+#    define i2c_release_bus()
+#endif
+
 /**
  * @brief Handles any I2C error condition by stopping the I2C peripheral and
  * aborting any ongoing transactions. Furthermore ChibiOS status codes are
@@ -117,13 +130,16 @@ static const I2CConfig i2cconfig = {
  */
 static i2c_status_t i2c_epilogue(const msg_t status) {
     if (status == MSG_OK) {
+        i2c_release_bus();
         return I2C_STATUS_SUCCESS;
     }
 
     // From ChibiOS HAL: "After a timeout the driver must be stopped and
     // restarted because the bus is in an uncertain state." We also issue that
-    // hard stop in case of any error.
-    i2c_stop();
+    // hard stop in case of any error. The bus is still held here, so stop the
+    // driver directly rather than through i2c_stop().
+    i2cStop(&I2C_DRIVER);
+    i2c_release_bus();
 
     return status == MSG_TIMEOUT ? I2C_STATUS_TIMEOUT : I2C_STATUS_ERROR;
 }
@@ -149,12 +165,15 @@ __attribute__((weak)) void i2c_init(void) {
 }
 
 i2c_status_t i2c_start(uint8_t address) {
+    i2c_acquire_bus();
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
+    i2c_release_bus();
     return I2C_STATUS_SUCCESS;
 }
 
 i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_acquire_bus();
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, 0, 0, TIME_MS2I(timeout));
@@ -162,6 +181,7 @@ i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length,
 }
 
 i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_acquire_bus();
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterReceiveTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, TIME_MS2I(timeout));
@@ -169,6 +189,7 @@ i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16
 }
 
 i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_acquire_bus();
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
 
@@ -183,6 +204,7 @@ i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data,
 }
 
 i2c_status_t i2c_writeReg16(uint8_t devaddr, uint16_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_acquire_bus();
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
 
@@ -198,6 +220,7 @@ i2c_status_t i2c_writeReg16(uint8_t devaddr, uint16_t regaddr, const uint8_t* da
 }
 
 i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_acquire_bus();
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), &regaddr, 1, data, length, TIME_MS2I(timeout));
@@ -205,6 +228,7 @@ i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16
 }
 
 i2c_status_t i2c_readReg16(uint8_t devaddr, uint16_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_acquire_bus();
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     uint8_t register_packet[2] = {regaddr >> 8, regaddr & 0xFF};
@@ -213,5 +237,7 @@ i2c_status_t i2c_readReg16(uint8_t devaddr, uint16_t regaddr, uint8_t* data, uin
 }
 
 void i2c_stop(void) {
+    i2c_acquire_bus();
     i2cStop(&I2C_DRIVER);
+    i2c_release_bus();
 }
@@ -19,6 +19,9 @@
 #include "timer.h"
 
 static pin_t currentSlavePin = NO_PIN;
+#if SPI_USE_MUTUAL_EXCLUSION == TRUE
+static thread_t *currentOwner = NULL;
+#endif
 
 #if defined(K20x) || defined(KL2x) || defined(RP2040)
 static SPIConfig spiConfig = {NULL, 0, 0, 0};
@@ -52,10 +55,23 @@ __attribute__((weak)) void spi_init(void) {
 }
 
 bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
-    if (currentSlavePin != NO_PIN || slavePin == NO_PIN) {
+    if (slavePin == NO_PIN) {
         return false;
     }
 
+#if SPI_USE_MUTUAL_EXCLUSION == TRUE
+    // The bus mutex isn't recursive, so a second start from the thread already holding it has to fail rather than block
+    if (currentSlavePin != NO_PIN && currentOwner == chThdGetSelfX()) {
+        return false;
+    }
+    // Wait for any other thread to finish its transaction, spi_stop() releases the bus
+    spiAcquireBus(&SPI_DRIVER);
+#else
+    if (currentSlavePin != NO_PIN) {
+        return false;
+    }
+#endif
+
 #if !(defined(WB32F3G71xx) || defined(WB32FQ95xx))
     uint16_t roundedDivisor = 2;
     while (roundedDivisor < divisor) {
@@ -63,6 +79,9 @@ bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
     }
 
     if (roundedDivisor < 2 || roundedDivisor > 256) {
+#    if SPI_USE_MUTUAL_EXCLUSION == TRUE
+        spiReleaseBus(&SPI_DRIVER);
+#    endif
         return false;
     }
 #endif
@@ -248,6 +267,9 @@ bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
 #endif
 
     currentSlavePin  = slavePin;
+#if SPI_USE_MUTUAL_EXCLUSION == TRUE
+    currentOwner = chThdGetSelfX();
+#endif
     spiConfig.ssport = PAL_PORT(slavePin);
     spiConfig.sspad  = PAL_PAD(slavePin);
 
@@ -287,5 +309,8 @@ void spi_stop(void) {
         spiUnselect(&SPI_DRIVER);
         spiStop(&SPI_DRIVER);
         currentSlavePin = NO_PIN;
+#if SPI_USE_MUTUAL_EXCLUSION == TRUE
+        spiReleaseBus(&SPI_DRIVER);
+#endif
     }
 }
@@ -0,0 +1,4 @@
+ws2812_spi_encode_DEFS := -DMATRIX_ROWS=1 -DMATRIX_COLS=1
+
+ws2812_spi_encode_SRC := \
+	$(PLATFORM_PATH)/chibios/drivers/tests/ws2812_spi_encode_tests.cpp
@@ -0,0 +1 @@
+TEST_LIST += ws2812_spi_encode
@@ -0,0 +1,169 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#    define BENCHMARK_CYCLES() __rdtsc()
+#endif
+
+extern "C" {
+#include "../ws2812_spi_encode.h"
+}
+
+namespace {
+
+#define BENCHMARK_LED_COUNT 150
+#define BENCHMARK_FRAMES 2000
+
+/* The encoder the lookup table replaced, kept as the reference bitstream. */
+uint8_t get_protocol_eq(uint8_t data, int pos) {
+    uint8_t eq = 0;
+    if (data & (1 << (2 * (3 - pos))))
+        eq = 0b1110;
+    else
+        eq = 0b1000;
+    if (data & (2 << (2 * (3 - pos))))
+        eq += 0b11100000;
+    else
+        eq += 0b10000000;
+    return eq;
+}
+
+void reference_encode_led(uint8_t *dst, const uint8_t *colors, int channels) {
+    for (int c = 0; c < channels; c++) {
+        for (int j = 0; j < 4; j++) {
+            dst[c * 4 + j] = get_protocol_eq(colors[c], j);
+        }
+    }
+}
+
+void lut_encode_led(uint8_t *dst, const uint8_t *colors, int channels) {
+    if (channels == 4) {
+        ws2812_spi_encode_led_rgbw(dst, colors[0], colors[1], colors[2], colors[3]);
+    } else {
+        ws2812_spi_encode_led(dst, colors[0], colors[1], colors[2]);
+    }
+}
+
+std::vector<uint8_t> random_colors(size_t count) {
+    std::vector<uint8_t> colors(count);
+    uint32_t             state = 0x12345678;
+    for (auto &color : colors) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        color = state;
+    }
+    return colors;
+}
+
+double time_encoder(void (*encode)(uint8_t *, const uint8_t *, int), const std::vector<uint8_t> &colors, int channels, std::vector<uint8_t> &out, uint64_t *cycles) {
+    using clock = std::chrono::steady_clock;
+
+    auto start = clock::now();
+#ifdef BENCHMARK_CYCLES
+    uint64_t start_cycles = BENCHMARK_CYCLES();
+#endif
+    for (int frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+        for (int led = 0; led < BENCHMARK_LED_COUNT; led++) {
+            encode(&out[led * channels * 4], &colors[((frame + led) % BENCHMARK_LED_COUNT) * channels], channels);
+        }
+    }
+#ifdef BENCHMARK_CYCLES
+    *cycles = BENCHMARK_CYCLES() - start_cycles;
+#else
+    *cycles = 0;
+#endif
+    auto elapsed = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+
+    return elapsed / ((double)BENCHMARK_FRAMES * BENCHMARK_LED_COUNT);
+}
+
+} // namespace
+
+TEST(Ws2812SpiEncode, EveryByteMatchesReference) {
+    for (int value = 0; value < 256; value++) {
+        uint8_t expected[WS2812_SPI_BYTES_PER_COLOR];
+        uint8_t actual[WS2812_SPI_BYTES_PER_COLOR];
+        for (int j = 0; j < 4; j++) {
+            expected[j] = get_protocol_eq(value, j);
+        }
+        ws2812_spi_encode_color(actual, value);
+        EXPECT_EQ(0, memcmp(expected, actual, sizeof(expected))) << "value " << value;
+    }
+}
+
+TEST(Ws2812SpiEncode, KnownPatterns) {
+    uint8_t actual[WS2812_SPI_BYTES_PER_COLOR];
+
+    ws2812_spi_encode_color(actual, 0x00);
+    EXPECT_EQ(0x88, actual[0]);
+    EXPECT_EQ(0x88, actual[3]);
+
+    ws2812_spi_encode_color(actual, 0xFF);
+    EXPECT_EQ(0xEE, actual[0]);
+    EXPECT_EQ(0xEE, actual[3]);
+
+    // Most significant bit first
+    ws2812_spi_encode_color(actual, 0x80);
+    EXPECT_EQ(0xE8, actual[0]);
+    EXPECT_EQ(0x88, actual[1]);
+    EXPECT_EQ(0x88, actual[2]);
+    EXPECT_EQ(0x88, actual[3]);
+}
+
+TEST(Ws2812SpiEncode, RgbStreamMatchesReference) {
+    auto                 colors = random_colors(BENCHMARK_LED_COUNT * 3);
+    std::vector<uint8_t> expected(BENCHMARK_LED_COUNT * 12);
+    std::vector<uint8_t> actual(BENCHMARK_LED_COUNT * 12);
+
+    for (int led = 0; led < BENCHMARK_LED_COUNT; led++) {
+        reference_encode_led(&expected[led * 12], &colors[led * 3], 3);
+        lut_encode_led(&actual[led * 12], &colors[led * 3], 3);
+    }
+    EXPECT_EQ(expected, actual);
+}
+
+TEST(Ws2812SpiEncode, RgbwStreamMatchesReference) {
+    auto                 colors = random_colors(BENCHMARK_LED_COUNT * 4);
+    std::vector<uint8_t> expected(BENCHMARK_LED_COUNT * 16);
+    std::vector<uint8_t> actual(BENCHMARK_LED_COUNT * 16);
+
+    for (int led = 0; led < BENCHMARK_LED_COUNT; led++) {
+        reference_encode_led(&expected[led * 16], &colors[led * 4], 4);
+        lut_encode_led(&actual[led * 16], &colors[led * 4], 4);
+    }
+    EXPECT_EQ(expected, actual);
+}
+
+TEST(Ws2812SpiEncode, Benchmark) {
+    for (int channels = 3; channels <= 4; channels++) {
+        auto                 colors = random_colors(BENCHMARK_LED_COUNT * channels);
+        std::vector<uint8_t> reference(BENCHMARK_LED_COUNT * channels * 4);
+        std::vector<uint8_t> lut(BENCHMARK_LED_COUNT * channels * 4);
+        uint64_t             reference_cycles, lut_cycles;
+
+        double reference_ns = time_encoder(reference_encode_led, colors, channels, reference, &reference_cycles);
+        double lut_ns       = time_encoder(lut_encode_led, colors, channels, lut, &lut_cycles);
+        EXPECT_EQ(reference, lut);
+
+        double leds = (double)BENCHMARK_FRAMES * BENCHMARK_LED_COUNT;
+        std::cout << "[ BENCHMARK] " << (channels == 4 ? "RGBW" : "RGB ") << std::fixed << std::setprecision(1) << " reference " << reference_ns << " ns/LED";
+#ifdef BENCHMARK_CYCLES
+        std::cout << " (" << reference_cycles / leds << " cycles)";
+#endif
+        std::cout << ", lookup table " << lut_ns << " ns/LED";
+#ifdef BENCHMARK_CYCLES
+        std::cout << " (" << lut_cycles / leds << " cycles)";
+#endif
+        std::cout << std::endl;
+    }
+}
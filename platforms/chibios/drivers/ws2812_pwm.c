@@ -1,6 +1,7 @@
 #include "ws2812.h"
 #include "quantum.h"
 #include <hal.h>
+#include <string.h>
 
 /* Adapted from https://github.com/joewa/WS2812-LED-Driver_ChibiOS/ */
 
@@ -91,6 +92,19 @@
 #define WS2812_COLOR_BIT_N (WS2812_LED_COUNT * WS2812_COLOR_BITS) /**< Number of data bits */
 #define WS2812_BIT_N (WS2812_COLOR_BIT_N + WS2812_RESET_BIT_N)    /**< Total number of bits in a frame */
 
+#ifdef WS2812_DOUBLE_BUFFER
+/*
+ * The reset period leads the frame, so that when the transfer complete interrupt
+ * comes in at the end of the color bits, the buffers can be swapped for as long
+ * as the stream is still sending reset bits.
+ */
+#    define WS2812_RESET_BIT_OFFSET 0
+#    define WS2812_COLOR_BIT_OFFSET WS2812_RESET_BIT_N
+#else
+#    define WS2812_COLOR_BIT_OFFSET 0
+#    define WS2812_RESET_BIT_OFFSET WS2812_COLOR_BIT_N
+#endif
+
 /**
  * @brief   High period for a zero, in ticks
  *
@@ -139,7 +153,7 @@
  *
  * @return                          The bit index
  */
-#define WS2812_BIT(led, byte, bit) (WS2812_COLOR_BITS * (led) + 8 * (byte) + (7 - (bit)))
+#define WS2812_BIT(led, byte, bit) (WS2812_COLOR_BIT_OFFSET + WS2812_COLOR_BITS * (led) + 8 * (byte) + (7 - (bit)))
 
 #if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
 /**
@@ -291,22 +305,70 @@ typedef uint16_t ws2812_buffer_t;
 typedef uint8_t ws2812_buffer_t;
 #endif
 
-static ws2812_buffer_t ws2812_frame_buffer[WS2812_BIT_N + 1]; /**< Buffer for a frame */
+#ifdef WS2812_DOUBLE_BUFFER
+#    if defined(WB32F3G71xx) || defined(WB32FQ95xx)
+#        error "WS2812_DOUBLE_BUFFER is not supported by the WB32 PWM driver"
+#    endif
 
-/* --- PUBLIC FUNCTIONS ----------------------------------------------------- */
 /*
- * Gedanke: Double-buffer type transactions: double buffer transfers using two memory pointers for
- * the memory (while the DMA is reading/writing from/to a buffer, the application can
- * write/read to/from the other buffer).
+ * Double-buffer type transactions: the DMA keeps streaming ws2812_send_buffer while the
+ * next frame is written into ws2812_frame_buffer. The buffers are swapped at the end of a
+ * pass, while the stream has wrapped around into the reset period.
  */
+static ws2812_buffer_t  ws2812_frame_buffers[2][WS2812_BIT_N + 1];
+static ws2812_buffer_t* ws2812_frame_buffer = ws2812_frame_buffers[0]; /**< Buffer for the next frame */
+static ws2812_buffer_t* ws2812_send_buffer  = ws2812_frame_buffers[1]; /**< Buffer being sent */
+static volatile bool    ws2812_queued       = false;
+
+// Bits that may still go out between checking the stream position and stopping it
+#    define WS2812_SWAP_MARGIN 8
+#    if (WS2812_RESET_BIT_N <= 2 * WS2812_SWAP_MARGIN)
+#        error "WS2812_TRST_US is too short for WS2812_DOUBLE_BUFFER"
+#    endif
+
+static void ws2812_dma_isr(void* p, uint32_t flags) {
+    if (!(flags & STM32_DMA_ISR_TCIF) || !ws2812_queued) {
+        return;
+    }
+
+    // Restarting the stream past the reset period would cut a frame short, if the interrupt
+    // came in that late the swap waits for the next pass instead
+    if (dmaStreamGetTransactionSize(WS2812_DMA_STREAM) <= WS2812_COLOR_BIT_N + WS2812_SWAP_MARGIN) {
+        return;
+    }
+
+    ws2812_buffer_t* tmp = ws2812_send_buffer;
+    ws2812_send_buffer   = ws2812_frame_buffer;
+    ws2812_frame_buffer  = tmp;
+
+    // Only reset bits are cut short, the next pass starts with a full reset period
+    dmaStreamDisable(WS2812_DMA_STREAM);
+    dmaStreamSetMemory0(WS2812_DMA_STREAM, ws2812_send_buffer);
+    dmaStreamSetTransactionSize(WS2812_DMA_STREAM, WS2812_BIT_N);
+    dmaStreamEnable(WS2812_DMA_STREAM);
+
+    ws2812_queued = false;
+}
+
+bool ws2812_ready(void) {
+    return !ws2812_queued;
+}
+#else
+static ws2812_buffer_t ws2812_frame_buffer[WS2812_BIT_N + 1]; /**< Buffer for a frame */
+#endif
+
+/* --- PUBLIC FUNCTIONS ----------------------------------------------------- */
 
 void ws2812_init(void) {
     // Initialize led frame buffer
     uint32_t i;
     for (i = 0; i < WS2812_COLOR_BIT_N; i++)
-        ws2812_frame_buffer[i] = WS2812_DUTYCYCLE_0; // All color bits are zero duty cycle
+        ws2812_frame_buffer[i + WS2812_COLOR_BIT_OFFSET] = WS2812_DUTYCYCLE_0; // All color bits are zero duty cycle
     for (i = 0; i < WS2812_RESET_BIT_N; i++)
-        ws2812_frame_buffer[i + WS2812_COLOR_BIT_N] = 0; // All reset bits are zero
+        ws2812_frame_buffer[i + WS2812_RESET_BIT_OFFSET] = 0; // All reset bits are zero
+#ifdef WS2812_DOUBLE_BUFFER
+    memcpy(ws2812_send_buffer, ws2812_frame_buffer, sizeof(ws2812_frame_buffers[0]));
+#endif
 
     palSetLineMode(RGB_DI_PIN, WS2812_OUTPUT_MODE);
 
@@ -334,10 +396,17 @@ void ws2812_init(void) {
     dmaStreamSetDestination(WS2812_DMA_STREAM, &(WS2812_PWM_DRIVER.tim->CCR[WS2812_PWM_CHANNEL - 1])); // Ziel ist der An-Zeit im Cap-Comp-Register
     dmaStreamSetMode(WS2812_DMA_STREAM, WB32_DMA_CHCFG_HWHIF(WS2812_DMA_CHANNEL) | WB32_DMA_CHCFG_DIR_M2P | WB32_DMA_CHCFG_PSIZE_WORD | WB32_DMA_CHCFG_MSIZE_WORD | WB32_DMA_CHCFG_MINC | WB32_DMA_CHCFG_CIRC | WB32_DMA_CHCFG_TCIE | WB32_DMA_CHCFG_PL(3));
 #else
+#    ifdef WS2812_DOUBLE_BUFFER
+    dmaStreamAlloc(WS2812_DMA_STREAM - STM32_DMA_STREAM(0), 10, ws2812_dma_isr, NULL);
+    dmaStreamSetPeripheral(WS2812_DMA_STREAM, &(WS2812_PWM_DRIVER.tim->CCR[WS2812_PWM_CHANNEL - 1]));
+    dmaStreamSetMemory0(WS2812_DMA_STREAM, ws2812_send_buffer);
+    dmaStreamSetMode(WS2812_DMA_STREAM, STM32_DMA_CR_CHSEL(WS2812_DMA_CHANNEL) | STM32_DMA_CR_DIR_M2P | WS2812_DMA_PERIPHERAL_WIDTH | WS2812_DMA_MEMORY_WIDTH | STM32_DMA_CR_MINC | STM32_DMA_CR_CIRC | STM32_DMA_CR_TCIE | STM32_DMA_CR_PL(3));
+#    else
     dmaStreamAlloc(WS2812_DMA_STREAM - STM32_DMA_STREAM(0), 10, NULL, NULL);
     dmaStreamSetPeripheral(WS2812_DMA_STREAM, &(WS2812_PWM_DRIVER.tim->CCR[WS2812_PWM_CHANNEL - 1])); // Ziel ist der An-Zeit im Cap-Comp-Register
     dmaStreamSetMemory0(WS2812_DMA_STREAM, ws2812_frame_buffer);
     dmaStreamSetMode(WS2812_DMA_STREAM, STM32_DMA_CR_CHSEL(WS2812_DMA_CHANNEL) | STM32_DMA_CR_DIR_M2P | WS2812_DMA_PERIPHERAL_WIDTH | WS2812_DMA_MEMORY_WIDTH | STM32_DMA_CR_MINC | STM32_DMA_CR_CIRC | STM32_DMA_CR_PL(3));
+#    endif
 #endif
     dmaStreamSetTransactionSize(WS2812_DMA_STREAM, WS2812_BIT_N);
     // M2P: Memory 2 Periph; PL: Priority Level
@@ -386,6 +455,19 @@ void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
         s_init = true;
     }
 
+#ifdef WS2812_DOUBLE_BUFFER
+    // Wait for a queued frame to start sending before reusing its buffer. If the stream has
+    // stalled, take the buffer back and overwrite that frame rather than hang.
+    systime_t start = chVTGetSystemTimeX();
+    while (ws2812_queued && chTimeDiffX(start, chVTGetSystemTimeX()) < TIME_MS2I(WS2812_DOUBLE_BUFFER_TIMEOUT)) {
+    }
+    ws2812_queued = false;
+    // LEDs past the end of ledarray keep the colors of the last frame
+    if (leds < WS2812_LED_COUNT) {
+        memcpy(&ws2812_frame_buffer[WS2812_BIT(leds, 0, 7)], &ws2812_send_buffer[WS2812_BIT(leds, 0, 7)], sizeof(ws2812_buffer_t) * (WS2812_LED_COUNT - leds) * WS2812_COLOR_BITS);
+    }
+#endif
+
     for (uint16_t i = 0; i < leds; i++) {
 #ifdef RGBW
         ws2812_write_led_rgbw(i, ledarray[i].r, ledarray[i].g, ledarray[i].b, ledarray[i].w);
@@ -393,4 +475,8 @@ void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
         ws2812_write_led(i, ledarray[i].r, ledarray[i].g, ledarray[i].b);
 #endif
     }
+
+#ifdef WS2812_DOUBLE_BUFFER
+    ws2812_queued = true;
+#endif
 }
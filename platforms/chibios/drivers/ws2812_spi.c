@@ -1,5 +1,7 @@
 #include "quantum.h"
 #include "ws2812.h"
+#include "ws2812_spi_encode.h"
+#include <string.h>
 
 /* Adapted from https://github.com/gamazeps/ws2812b-chibios-SPIDMA/ */
 
@@ -73,7 +75,7 @@
 #    define WS2812_SCK_OUTPUT_MODE PAL_MODE_ALTERNATE(WS2812_SPI_SCK_PAL_MODE) | PAL_OUTPUT_TYPE_PUSHPULL
 #endif
 
-#define BYTES_FOR_LED_BYTE 4
+#define BYTES_FOR_LED_BYTE WS2812_SPI_BYTES_PER_COLOR
 #ifdef RGBW
 #    define WS2812_CHANNELS 4
 #else
@@ -83,56 +85,67 @@
 #define DATA_SIZE (BYTES_FOR_LED * WS2812_LED_COUNT)
 #define RESET_SIZE (1000 * WS2812_TRST_US / (2 * WS2812_TIMING))
 #define PREAMBLE_SIZE 4
+#define TXBUF_SIZE (PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE)
 
-static uint8_t txbuf[PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE] = {0};
+#ifdef WS2812_DOUBLE_BUFFER
+#    if defined(WS2812_SPI_USE_CIRCULAR_BUFFER) || defined(WS2812_SPI_SYNC)
+#        error "WS2812_DOUBLE_BUFFER cannot be used with WS2812_SPI_USE_CIRCULAR_BUFFER or WS2812_SPI_SYNC"
+#    endif
+
+// The next frame is encoded into txbuf while txbuf_send is being sent.
+// A frame encoded during a transfer is queued, and sent from the end callback.
+static uint8_t       txbufs[2][TXBUF_SIZE] = {0};
+static uint8_t*      txbuf                 = txbufs[0];
+static uint8_t*      txbuf_send            = txbufs[1];
+static volatile bool ws2812_sending        = false;
+static volatile bool ws2812_queued         = false;
+
+static void ws2812_swap_buffers(void) {
+    uint8_t* tmp = txbuf_send;
+    txbuf_send   = txbuf;
+    txbuf        = tmp;
+}
+
+static void ws2812_spi_end_cb(SPIDriver* spip) {
+    chSysLockFromISR();
+    if (ws2812_queued) {
+        ws2812_swap_buffers();
+        ws2812_queued = false;
+        spiStartSendI(spip, TXBUF_SIZE, txbuf_send);
+    } else {
+        ws2812_sending = false;
+    }
+    chSysUnlockFromISR();
+}
+
+bool ws2812_ready(void) {
+    return !ws2812_queued;
+}
+#else
+static uint8_t txbuf[TXBUF_SIZE] = {0};
+#endif
 
 /*
  * As the trick here is to use the SPI to send a huge pattern of 0 and 1 to
- * the ws2812b protocol, we use this helper function to translate bytes into
- * 0s and 1s for the LED (with the appropriate timing).
+ * the ws2812b protocol, each color byte is translated into 0s and 1s for the
+ * LED (with the appropriate timing) through a lookup table.
  */
-static uint8_t get_protocol_eq(uint8_t data, int pos) {
-    uint8_t eq = 0;
-    if (data & (1 << (2 * (3 - pos))))
-        eq = 0b1110;
-    else
-        eq = 0b1000;
-    if (data & (2 << (2 * (3 - pos))))
-        eq += 0b11100000;
-    else
-        eq += 0b10000000;
-    return eq;
-}
-
 static void set_led_color_rgb(LED_TYPE color, int pos) {
-    uint8_t* tx_start = &txbuf[PREAMBLE_SIZE];
+    uint8_t* tx_start = &txbuf[PREAMBLE_SIZE + BYTES_FOR_LED * pos];
 
 #if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.r, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.b, j);
+#    define WS2812_SPI_COLORS color.g, color.r, color.b
 #elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_RGB)
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.r, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.b, j);
+#    define WS2812_SPI_COLORS color.r, color.g, color.b
 #elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_BGR)
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.b, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.r, j);
+#    define WS2812_SPI_COLORS color.b, color.g, color.r
 #endif
 #ifdef RGBW
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 4 + j] = get_protocol_eq(color.w, j);
+    ws2812_spi_encode_led_rgbw(tx_start, WS2812_SPI_COLORS, color.w);
+#else
+    ws2812_spi_encode_led(tx_start, WS2812_SPI_COLORS);
 #endif
+#undef WS2812_SPI_COLORS
 }
 
 void ws2812_init(void) {
@@ -149,7 +162,11 @@ void ws2812_init(void) {
 #    if SPI_SUPPORTS_CIRCULAR == TRUE
         WS2812_SPI_BUFFER_MODE,
 #    endif
+#    ifdef WS2812_DOUBLE_BUFFER
+        ws2812_spi_end_cb,
+#    else
         NULL, // end_cb
+#    endif
         PAL_PORT(RGB_DI_PIN),
         PAL_PAD(RGB_DI_PIN),
 #    if defined(WB32F3G71xx) || defined(WB32FQ95xx)
@@ -168,7 +185,11 @@ void ws2812_init(void) {
 #    if SPI_SUPPORTS_SLAVE_MODE == TRUE
         false,
 #    endif
+#    ifdef WS2812_DOUBLE_BUFFER
+        ws2812_spi_end_cb,
+#    else
         NULL, // data_cb
+#    endif
         NULL, // error_cb
         PAL_PORT(RGB_DI_PIN),
         PAL_PAD(RGB_DI_PIN),
@@ -181,7 +202,7 @@ void ws2812_init(void) {
     spiStart(&WS2812_SPI, &spicfg); /* Setup transfer parameters.       */
     spiSelect(&WS2812_SPI);         /* Slave Select assertion.          */
 #ifdef WS2812_SPI_USE_CIRCULAR_BUFFER
-    spiStartSend(&WS2812_SPI, ARRAY_SIZE(txbuf), txbuf);
+    spiStartSend(&WS2812_SPI, TXBUF_SIZE, txbuf);
 #endif
 }
 
@@ -192,17 +213,40 @@ void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
         s_init = true;
     }
 
-    for (uint8_t i = 0; i < leds; i++) {
+#ifdef WS2812_DOUBLE_BUFFER
+    // Wait for a queued frame to start sending before reusing its buffer. If the transfer has
+    // stalled, take the buffer back and overwrite that frame rather than hang.
+    systime_t start = chVTGetSystemTimeX();
+    while (ws2812_queued && chTimeDiffX(start, chVTGetSystemTimeX()) < TIME_MS2I(WS2812_DOUBLE_BUFFER_TIMEOUT)) {
+    }
+    ws2812_queued = false;
+    // LEDs past the end of ledarray keep the colors of the last frame
+    if (leds < WS2812_LED_COUNT) {
+        memcpy(&txbuf[PREAMBLE_SIZE + BYTES_FOR_LED * leds], &txbuf_send[PREAMBLE_SIZE + BYTES_FOR_LED * leds], BYTES_FOR_LED * (WS2812_LED_COUNT - leds));
+    }
+#endif
+
+    for (uint16_t i = 0; i < leds; i++) {
         set_led_color_rgb(ledarray[i], i);
     }
 
+#ifdef WS2812_DOUBLE_BUFFER
+    chSysLock();
+    if (ws2812_sending) {
+        ws2812_queued = true;
+    } else {
+        ws2812_swap_buffers();
+        ws2812_sending = true;
+        spiStartSendI(&WS2812_SPI, TXBUF_SIZE, txbuf_send);
+    }
+    chSysUnlock();
+#elif !defined(WS2812_SPI_USE_CIRCULAR_BUFFER)
     // Send async - each led takes ~0.03ms, 50 leds ~1.5ms, animations flushing faster than send will cause issues.
-    // Instead spiSend can be used to send synchronously (or the thread logic can be added back).
-#ifndef WS2812_SPI_USE_CIRCULAR_BUFFER
+    // Instead spiSend can be used to send synchronously, or WS2812_DOUBLE_BUFFER to queue frames.
 #    ifdef WS2812_SPI_SYNC
-    spiSend(&WS2812_SPI, ARRAY_SIZE(txbuf), txbuf);
+    spiSend(&WS2812_SPI, TXBUF_SIZE, txbuf);
 #    else
-    spiStartSend(&WS2812_SPI, ARRAY_SIZE(txbuf), txbuf);
+    spiStartSend(&WS2812_SPI, TXBUF_SIZE, txbuf);
 #    endif
 #endif
 }
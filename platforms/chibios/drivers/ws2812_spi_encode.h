@@ -0,0 +1,53 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * The SPI driver sends each WS2812 bit as a nibble: 0b1110 for a 1 and 0b1000
+ * for a 0, so every color byte expands to 4 bytes on the wire, most significant
+ * bit first. The expansion of every possible byte is precomputed, which turns
+ * encoding into one table lookup and a 4 byte copy per color.
+ */
+
+#define WS2812_SPI_BYTES_PER_COLOR 4
+
+#define WS2812_SPI_NIBBLE(bit) ((bit) ? 0b1110 : 0b1000)
+#define WS2812_SPI_PAIR(value, pos) (uint8_t)((WS2812_SPI_NIBBLE((value) & (2 << (2 * (3 - (pos))))) << 4) | WS2812_SPI_NIBBLE((value) & (1 << (2 * (3 - (pos))))))
+#define WS2812_SPI_PATTERN(value) \
+    { WS2812_SPI_PAIR(value, 0), WS2812_SPI_PAIR(value, 1), WS2812_SPI_PAIR(value, 2), WS2812_SPI_PAIR(value, 3) }
+
+#define WS2812_SPI_PATTERN_4(value) WS2812_SPI_PATTERN(value), WS2812_SPI_PATTERN(value + 1), WS2812_SPI_PATTERN(value + 2), WS2812_SPI_PATTERN(value + 3)
+#define WS2812_SPI_PATTERN_16(value) WS2812_SPI_PATTERN_4(value), WS2812_SPI_PATTERN_4(value + 4), WS2812_SPI_PATTERN_4(value + 8), WS2812_SPI_PATTERN_4(value + 12)
+#define WS2812_SPI_PATTERN_64(value) WS2812_SPI_PATTERN_16(value), WS2812_SPI_PATTERN_16(value + 16), WS2812_SPI_PATTERN_16(value + 32), WS2812_SPI_PATTERN_16(value + 48)
+
+// Flash reads stall on some MCUs, the table can be copied to RAM at startup instead (1KB)
+#ifdef WS2812_SPI_LUT_IN_RAM
+static uint8_t ws2812_spi_lut[256][WS2812_SPI_BYTES_PER_COLOR] = {
+#else
+static const uint8_t ws2812_spi_lut[256][WS2812_SPI_BYTES_PER_COLOR] = {
+#endif
+    WS2812_SPI_PATTERN_64(0),
+    WS2812_SPI_PATTERN_64(64),
+    WS2812_SPI_PATTERN_64(128),
+    WS2812_SPI_PATTERN_64(192),
+};
+
+static inline void ws2812_spi_encode_color(uint8_t *dst, uint8_t value) {
+    memcpy(dst, ws2812_spi_lut[value], WS2812_SPI_BYTES_PER_COLOR);
+}
+
+/* Encodes one LED, with its colors already in wire order. */
+static inline void ws2812_spi_encode_led(uint8_t *dst, uint8_t c0, uint8_t c1, uint8_t c2) {
+    ws2812_spi_encode_color(dst, c0);
+    ws2812_spi_encode_color(dst + WS2812_SPI_BYTES_PER_COLOR, c1);
+    ws2812_spi_encode_color(dst + WS2812_SPI_BYTES_PER_COLOR * 2, c2);
+}
+
+static inline void ws2812_spi_encode_led_rgbw(uint8_t *dst, uint8_t c0, uint8_t c1, uint8_t c2, uint8_t w) {
+    ws2812_spi_encode_led(dst, c0, c1, c2);
+    ws2812_spi_encode_color(dst + WS2812_SPI_BYTES_PER_COLOR * 3, w);
+}
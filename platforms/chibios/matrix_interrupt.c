@@ -0,0 +1,80 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <ch.h>
+#include <hal.h>
+
+#include "matrix_interrupt.h"
+
+#if !defined(PAL_USE_CALLBACKS) || (PAL_USE_CALLBACKS != TRUE)
+#    error "MATRIX_INTERRUPT_ENABLE requires PAL_USE_CALLBACKS to be set to TRUE in halconf.h"
+#endif
+
+static volatile bool      edge_pending   = false;
+static thread_reference_t waiting_thread = NULL;
+
+#if defined(MCU_STM32) || defined(MCU_GD32V) || defined(MCU_WB32)
+/* EXTI based parts share one interrupt line between all pins with the same
+ * number (PA1, PB1, ...), so only the first of them can be armed.
+ */
+#    define EXTI_LINE_COUNT 16
+static pin_t exti_line_owner[EXTI_LINE_COUNT] = {[0 ... EXTI_LINE_COUNT - 1] = NO_PIN};
+#endif
+
+static void matrix_interrupt_callback(void *arg) {
+    (void)arg;
+
+    chSysLockFromISR();
+    edge_pending = true;
+    chThdResumeI(&waiting_thread, MSG_OK);
+    chSysUnlockFromISR();
+}
+
+bool matrix_interrupt_enable_pin(pin_t pin) {
+#if defined(MCU_STM32) || defined(MCU_GD32V) || defined(MCU_WB32)
+    uint8_t line = PAL_PAD(pin);
+    if (line >= EXTI_LINE_COUNT || (exti_line_owner[line] != NO_PIN && exti_line_owner[line] != pin)) {
+        return false;
+    }
+    exti_line_owner[line] = pin;
+#endif
+
+    palEnableLineEvent(pin, PAL_EVENT_MODE_BOTH_EDGES);
+    palSetLineCallback(pin, matrix_interrupt_callback, NULL);
+    return true;
+}
+
+void matrix_interrupt_disable_pin(pin_t pin) {
+#if defined(MCU_STM32) || defined(MCU_GD32V) || defined(MCU_WB32)
+    uint8_t line = PAL_PAD(pin);
+    if (line >= EXTI_LINE_COUNT || exti_line_owner[line] != pin) {
+        // Never armed, or the line belongs to another pin
+        return;
+    }
+    exti_line_owner[line] = NO_PIN;
+#endif
+
+    palDisableLineEvent(pin);
+}
+
+bool matrix_interrupt_pending(void) {
+    return edge_pending;
+}
+
+void matrix_interrupt_clear(void) {
+    edge_pending = false;
+}
+
+void matrix_interrupt_wait(uint32_t timeout_ms) {
+    if (timeout_ms == 0) {
+        return;
+    }
+
+    // Suspend the main thread until an edge or the timeout; the idle thread
+    // takes care of putting the core to sleep.
+    chSysLock();
+    if (!edge_pending) {
+        chThdSuspendTimeoutS(&waiting_thread, TIME_MS2I(timeout_ms));
+    }
+    chSysUnlock();
+}
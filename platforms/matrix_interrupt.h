@@ -0,0 +1,32 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gpio.h"
+
+/** \brief Arm a pin so that any edge on it wakes the matrix
+ *
+ * Returns false if the platform cannot generate an interrupt for the given pin.
+ */
+bool matrix_interrupt_enable_pin(pin_t pin);
+
+/** \brief Stop a pin from generating matrix wakeup interrupts
+ */
+void matrix_interrupt_disable_pin(pin_t pin);
+
+/** \brief Whether an edge has been seen on an armed pin since the last clear
+ */
+bool matrix_interrupt_pending(void);
+
+/** \brief Forget any previously seen edge
+ */
+void matrix_interrupt_clear(void);
+
+/** \brief Put the MCU to sleep until an armed pin changes or the timeout expires
+ *
+ * Returns immediately if the timeout is zero.
+ */
+void matrix_interrupt_wait(uint32_t timeout_ms);
@@ -30,6 +30,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action.h"
 #include "wait.h"
 #include "keycode_config.h"
+#include "latency_trace.h"
+#include "deadline.h"
 
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
@@ -133,6 +135,24 @@ void action_exec(keyevent_t event) {
 #endif
 }
 
+/** \brief Milliseconds until action_exec next needs a tick event
+ *
+ * Tick events only drive one shot timeouts and the tapping state machine, so
+ * while neither has anything pending they can be skipped entirely.
+ */
+uint32_t action_next_deadline(void) {
+    uint32_t deadline = DEADLINE_NONE;
+#ifndef NO_ACTION_ONESHOT
+    if (keymap_config.oneshot_enable) {
+        deadline = oneshot_next_deadline();
+    }
+#endif
+#ifndef NO_ACTION_TAPPING
+    deadline = deadline_min(deadline, action_tapping_next_deadline());
+#endif
+    return deadline;
+}
+
 #ifdef SWAP_HANDS_ENABLE
 extern const keypos_t PROGMEM hand_swap_config[MATRIX_ROWS][MATRIX_COLS];
 #    ifdef ENCODER_MAP_ENABLE
@@ -254,7 +274,11 @@ void process_record(keyrecord_t *record) {
         return;
     }
 
-    if (!process_record_quantum(record)) {
+    LATENCY_TRACE_BEGIN(LATENCY_STAGE_PROCESS_RECORD);
+    const bool process_further = process_record_quantum(record);
+    LATENCY_TRACE_END(LATENCY_STAGE_PROCESS_RECORD);
+
+    if (!process_further) {
 #ifndef NO_ACTION_ONESHOT
         if (is_oneshot_layer_active() && record->event.pressed && keymap_config.oneshot_enable) {
             clear_oneshot_layer_state(ONESHOT_OTHER_KEY_PRESSED);
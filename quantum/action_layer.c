@@ -1,5 +1,6 @@
 #include <limits.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "keyboard.h"
 #include "keymap.h"
@@ -316,6 +317,44 @@ action_t store_or_get_action(bool pressed, keypos_t key) {
 #endif
 }
 
+#if defined(LAYER_RESOLUTION_CACHE) && !defined(NO_ACTION_LAYER)
+#    define LAYER_RESOLUTION_UNKNOWN UINT8_MAX
+
+/** \brief Resolved layers cache
+ *
+ * The topmost non-transparent layer of each matrix position, for the layer
+ * state stored alongside. Entries are resolved lazily on first lookup, so a
+ * layer change only costs a reset of the table.
+ */
+static layer_state_t layer_resolution_state = 0;
+static bool          layer_resolution_valid = false;
+static uint8_t       layer_resolution[MATRIX_ROWS][MATRIX_COLS];
+
+/** \brief Invalidate the resolved layers cache
+ *
+ * Needs to be called when keycodes are changed at runtime, e.g. by dynamic keymaps.
+ */
+void layer_resolution_cache_invalidate(void) {
+    layer_resolution_valid = false;
+}
+
+/** \brief Resolved layers cache entry
+ *
+ * Gets the cache entry for the key in the current layer state, or NULL for keys outside the matrix.
+ */
+static uint8_t *layer_resolution_entry(keypos_t key, layer_state_t layers) {
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return NULL;
+    }
+    if (!layer_resolution_valid || layer_resolution_state != layers) {
+        memset(layer_resolution, LAYER_RESOLUTION_UNKNOWN, sizeof(layer_resolution));
+        layer_resolution_state = layers;
+        layer_resolution_valid = true;
+    }
+    return &layer_resolution[key.row][key.col];
+}
+#endif
+
 /** \brief Layer switch get layer
  *
  * Gets the layer based on key info
@@ -326,16 +365,28 @@ uint8_t layer_switch_get_layer(keypos_t key) {
     action.code = ACTION_TRANSPARENT;
 
     layer_state_t layers = layer_state | default_layer_state;
+#    ifdef LAYER_RESOLUTION_CACHE
+    uint8_t *cached = layer_resolution_entry(key, layers);
+    if (cached && *cached != LAYER_RESOLUTION_UNKNOWN) {
+        return *cached;
+    }
+#    endif
     /* check top layer first */
     for (int8_t i = MAX_LAYER - 1; i >= 0; i--) {
         if (layers & ((layer_state_t)1 << i)) {
             action = action_for_key(i, key);
             if (action.code != ACTION_TRANSPARENT) {
+#    ifdef LAYER_RESOLUTION_CACHE
+                if (cached) *cached = i;
+#    endif
                 return i;
             }
         }
     }
     /* fall back to layer 0 */
+#    ifdef LAYER_RESOLUTION_CACHE
+    if (cached) *cached = 0;
+#    endif
     return 0;
 #else
     return get_highest_layer(default_layer_state);
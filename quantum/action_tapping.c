@@ -1,11 +1,13 @@
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "action.h"
 #include "action_layer.h"
 #include "action_tapping.h"
 #include "keycode.h"
 #include "timer.h"
+#include "deadline.h"
 
 #ifndef NO_ACTION_TAPPING
 
@@ -65,13 +67,28 @@ __attribute__((weak)) bool get_hold_on_other_key_press(uint16_t keycode, keyreco
 #        include "process_auto_shift.h"
 #    endif
 
+#    if WAITING_BUFFER_SIZE < 2 || WAITING_BUFFER_SIZE > 31
+#        error "WAITING_BUFFER_SIZE must be between 2 and 31"
+#    endif
+
 static keyrecord_t tapping_key                         = {};
 static keyrecord_t waiting_buffer[WAITING_BUFFER_SIZE] = {};
 static uint8_t     waiting_buffer_head                 = 0;
 static uint8_t     waiting_buffer_tail                 = 0;
 
+/* Incremental bookkeeping of the waiting buffer contents, so that queries
+ * don't need to scan it. Per matrix position, the high nibble counts buffered
+ * presses and the low nibble buffered releases; a buffer of at most 31
+ * entries can never hold more than 15 of either for one key.
+ */
+static uint8_t waiting_buffer_pressed                            = 0;
+static uint8_t waiting_buffer_key_events[MATRIX_ROWS][MATRIX_COLS] = {};
+
 static bool process_tapping(keyrecord_t *record);
 static bool waiting_buffer_enq(keyrecord_t record);
+static void waiting_buffer_deq(void);
+static void waiting_buffer_process(void);
+static bool waiting_buffer_settle(void);
 static void waiting_buffer_clear(void);
 static bool waiting_buffer_typed(keyevent_t event);
 static bool waiting_buffer_has_anykey_pressed(void);
@@ -91,12 +108,16 @@ void action_tapping_process(keyrecord_t record) {
             ac_dprintf("\n");
         }
     } else {
-        if (!waiting_buffer_enq(record)) {
-            // clear all in case of overflow.
-            ac_dprintf("OVERFLOW: CLEAR ALL STATES\n");
-            clear_keyboard();
-            waiting_buffer_clear();
-            tapping_key = (keyrecord_t){};
+        while (!waiting_buffer_enq(record)) {
+            // make room by settling the pending tapping key, rather than dropping events
+            if (!waiting_buffer_settle()) {
+                // clear all in case of overflow.
+                ac_dprintf("OVERFLOW: CLEAR ALL STATES\n");
+                clear_keyboard();
+                waiting_buffer_clear();
+                tapping_key = (keyrecord_t){};
+                break;
+            }
         }
     }
 
@@ -104,20 +125,25 @@ void action_tapping_process(keyrecord_t record) {
     if (IS_EVENT(record.event) && waiting_buffer_head != waiting_buffer_tail) {
         ac_dprintf("---- action_exec: process waiting_buffer -----\n");
     }
-    for (; waiting_buffer_tail != waiting_buffer_head; waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE) {
-        if (process_tapping(&waiting_buffer[waiting_buffer_tail])) {
-            ac_dprintf("processed: waiting_buffer[%u] =", waiting_buffer_tail);
-            debug_record(waiting_buffer[waiting_buffer_tail]);
-            ac_dprintf("\n\n");
-        } else {
-            break;
-        }
-    }
+    waiting_buffer_process();
     if (IS_EVENT(record.event)) {
         ac_dprintf("\n");
     }
 }
 
+/** \brief Milliseconds until the tapping state machine next needs a tick event
+ *
+ * A pending tapping key resolves once its tapping term runs out, and anything
+ * left in the waiting buffer needs processing straight away. Event times are
+ * always odd, so the elapsed time is measured the same way as a tick event.
+ */
+uint32_t action_tapping_next_deadline(void) {
+    if (IS_TAPPING()) {
+        return deadline_remaining(TIMER_DIFF_16(timer_read() | 1, tapping_key.event.time), GET_TAPPING_TERM(get_record_keycode(&tapping_key, false), &tapping_key));
+    }
+    return waiting_buffer_head != waiting_buffer_tail ? 0 : DEADLINE_NONE;
+}
+
 /* Some conditionally defined helper macros to keep process_tapping more
  * readable. The conditional definition of tapping_keycode and all the
  * conditional uses of it are hidden inside macros named TAP_...
@@ -433,6 +459,33 @@ bool process_tapping(keyrecord_t *keyp) {
     }
 }
 
+/** \brief Waiting buffer per key event counts
+ *
+ * Returns NULL for keys outside the matrix.
+ */
+static inline uint8_t *waiting_buffer_key_counts(keypos_t key) {
+    if (key.row < MATRIX_ROWS && key.col < MATRIX_COLS) {
+        return &waiting_buffer_key_events[key.row][key.col];
+    }
+    return NULL;
+}
+
+/** \brief Waiting buffer bookkeeping
+ *
+ * Tracks an event being added to or removed from the waiting buffer.
+ */
+static void waiting_buffer_count(keyevent_t event, bool add) {
+    uint8_t *counts = waiting_buffer_key_counts(event.key);
+    uint8_t  step   = event.pressed ? 0x10 : 0x01;
+    if (add) {
+        waiting_buffer_pressed += event.pressed;
+        if (counts) *counts += step;
+    } else {
+        waiting_buffer_pressed -= event.pressed;
+        if (counts) *counts -= step;
+    }
+}
+
 /** \brief Waiting buffer enq
  *
  * FIXME: Needs docs
@@ -449,26 +502,83 @@ bool waiting_buffer_enq(keyrecord_t record) {
 
     waiting_buffer[waiting_buffer_head] = record;
     waiting_buffer_head                 = (waiting_buffer_head + 1) % WAITING_BUFFER_SIZE;
+    waiting_buffer_count(record.event, true);
 
     ac_dprintf("waiting_buffer_enq: ");
     debug_waiting_buffer();
     return true;
 }
 
+/** \brief Waiting buffer deq
+ *
+ * Drops the oldest event from the waiting buffer.
+ */
+void waiting_buffer_deq(void) {
+    waiting_buffer_count(waiting_buffer[waiting_buffer_tail].event, false);
+    waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE;
+}
+
+/** \brief Waiting buffer process
+ *
+ * Feeds buffered events through the tapping state machine, oldest first,
+ * until one has to keep waiting.
+ */
+void waiting_buffer_process(void) {
+    while (waiting_buffer_tail != waiting_buffer_head) {
+        if (process_tapping(&waiting_buffer[waiting_buffer_tail])) {
+            ac_dprintf("processed: waiting_buffer[%u] =", waiting_buffer_tail);
+            debug_record(waiting_buffer[waiting_buffer_tail]);
+            ac_dprintf("\n\n");
+            waiting_buffer_deq();
+        } else {
+            break;
+        }
+    }
+}
+
+/** \brief Waiting buffer settle
+ *
+ * Makes room in a full waiting buffer by settling the pending tapping key as
+ * a hold, just as the tapping term running out would, then replaying the
+ * events buffered behind it.
+ *
+ * \return true if the tapping key was settled
+ */
+bool waiting_buffer_settle(void) {
+    if (!IS_TAPPING_PRESSED() || tapping_key.tap.count != 0) {
+        return false;
+    }
+
+    ac_dprintf("Tapping: End. Waiting buffer full. Not tap(0): ");
+    debug_tapping_key();
+    process_record(&tapping_key);
+    tapping_key = (keyrecord_t){};
+    waiting_buffer_process();
+    return true;
+}
+
 /** \brief Waiting buffer clear
  *
  * FIXME: Needs docs
  */
 void waiting_buffer_clear(void) {
-    waiting_buffer_head = 0;
-    waiting_buffer_tail = 0;
+    waiting_buffer_head    = 0;
+    waiting_buffer_tail    = 0;
+    waiting_buffer_pressed = 0;
+    memset(waiting_buffer_key_events, 0, sizeof(waiting_buffer_key_events));
 }
 
 /** \brief Waiting buffer typed
  *
- * FIXME: Needs docs
+ * Whether the opposite of the given event is waiting for the same key.
  */
 bool waiting_buffer_typed(keyevent_t event) {
+    const uint8_t *counts = waiting_buffer_key_counts(event.key);
+    if (counts) {
+        return event.pressed ? (*counts & 0x0F) : (*counts >> 4);
+    }
+
+    // Keys outside the matrix, such as combos and encoders, aren't indexed
     for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
         if (KEYEQ(event.key, waiting_buffer[i].event.key) && event.pressed != waiting_buffer[i].event.pressed) {
             return true;
@@ -482,10 +592,7 @@ bool waiting_buffer_typed(keyevent_t event) {
  * FIXME: Needs docs
  */
 __attribute__((unused)) bool waiting_buffer_has_anykey_pressed(void) {
-    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
-        if (waiting_buffer[i].event.pressed) return true;
-    }
-    return false;
+    return waiting_buffer_pressed > 0;
 }
 
 /** \brief Scan buffer for tapping
@@ -497,6 +604,9 @@ void waiting_buffer_scan_tap(void) {
     if (tapping_key.tap.count > 0) return;
     // invalid state: tapping_key released && tap.count == 0
     if (!tapping_key.event.pressed) return;
+    // the tapping key hasn't been released yet
+    const uint8_t *counts = waiting_buffer_key_counts(tapping_key.event.key);
+    if (counts && (*counts & 0x0F) == 0) return;
 
     for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
         if (IS_TAPPING_KEY(waiting_buffer[i].event.key) && !waiting_buffer[i].event.pressed && WITHIN_TAPPING_TERM(waiting_buffer[i].event)) {
@@ -32,12 +32,20 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #    define TAPPING_TOGGLE 5
 #endif
 
-#define WAITING_BUFFER_SIZE 8
+/* number of events which can be held back while a tap or hold is undecided */
+#ifndef WAITING_BUFFER_SIZE
+#    if defined(__AVR__)
+#        define WAITING_BUFFER_SIZE 8
+#    else
+#        define WAITING_BUFFER_SIZE 16
+#    endif
+#endif
 
 #ifndef NO_ACTION_TAPPING
 uint16_t get_record_keycode(keyrecord_t *record, bool update_layer_cache);
 uint16_t get_event_keycode(keyevent_t event, bool update_layer_cache);
 void     action_tapping_process(keyrecord_t record);
+uint32_t action_tapping_next_deadline(void);
 #endif
 
 uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record);
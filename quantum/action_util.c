@@ -20,6 +20,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_util.h"
 #include "action_layer.h"
 #include "timer.h"
+#include "deadline.h"
 #include "keycode_config.h"
 #include <string.h>
 
@@ -439,6 +440,27 @@ void clear_oneshot_mods(void) {
 }
 #endif
 
+/** \brief Milliseconds until a one shot timeout next needs checking
+ */
+uint32_t oneshot_next_deadline(void) {
+    uint32_t deadline = DEADLINE_NONE;
+#if !defined(NO_ACTION_ONESHOT) && (defined(ONESHOT_TIMEOUT) && (ONESHOT_TIMEOUT > 0))
+    const uint16_t now = timer_read();
+    if (oneshot_mods) {
+        deadline = deadline_min(deadline, deadline_remaining(TIMER_DIFF_16(now, oneshot_time), ONESHOT_TIMEOUT));
+    }
+    if (is_oneshot_layer_active() && !(get_oneshot_layer_state() & ONESHOT_TOGGLED)) {
+        deadline = deadline_min(deadline, deadline_remaining(TIMER_DIFF_16(now, oneshot_layer_time), ONESHOT_TIMEOUT));
+    }
+#    ifdef SWAP_HANDS_ENABLE
+    if (swap_hands_oneshot == SHO_ACTIVE) {
+        deadline = deadline_min(deadline, deadline_remaining(TIMER_DIFF_16(now, oneshot_swaphands_time), ONESHOT_TIMEOUT));
+    }
+#    endif
+#endif
+    return deadline;
+}
+
 /** \brief Called when the one shot modifiers have been changed.
  *
  * \param mods Contains the active modifiers active after the change.
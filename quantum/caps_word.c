@@ -17,6 +17,7 @@
 #include "timer.h"
 #include "action.h"
 #include "action_util.h"
+#include "deadline.h"
 
 /** @brief True when Caps Word is active. */
 static bool caps_word_active = false;
@@ -37,11 +38,23 @@ void caps_word_task(void) {
     }
 }
 
+uint32_t caps_word_next_deadline(void) {
+    if (!caps_word_active) {
+        return DEADLINE_NONE;
+    }
+    const uint16_t now = timer_read();
+    return timer_expired(now, idle_timer) ? 0 : (uint16_t)(idle_timer - now);
+}
+
 void caps_word_reset_idle_timer(void) {
     idle_timer = timer_read() + CAPS_WORD_IDLE_TIMEOUT;
 }
 #else
 void caps_word_task(void) {}
+
+uint32_t caps_word_next_deadline(void) {
+    return DEADLINE_NONE;
+}
 #endif // CAPS_WORD_IDLE_TIMEOUT > 0
 
 void caps_word_on(void) {
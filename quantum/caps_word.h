@@ -23,6 +23,9 @@
 /** @brief Matrix scan task for Caps Word feature */
 void caps_word_task(void);
 
+/** @brief Milliseconds until Caps Word next needs its task to run. */
+uint32_t caps_word_next_deadline(void);
+
 #if CAPS_WORD_IDLE_TIMEOUT > 0
 /** @brief Resets timer for Caps Word idle timeout. */
 void caps_word_reset_idle_timer(void);
@@ -108,6 +108,52 @@ RGB hsv_to_rgb_nocie(HSV hsv) {
     return hsv_to_rgb_impl(hsv, false);
 }
 
+// The hue region and remainder from hsv_to_rgb_impl(), as (region << 8) | remainder
+#define HUE_REGION(h) ((h)*6 / 255)
+#define HUE_ENTRY(h) (uint16_t)((HUE_REGION(h) << 8) | (uint8_t)(((h)*2 - HUE_REGION(h) * 85) * 3))
+#define HUE_ENTRY_4(h) HUE_ENTRY(h), HUE_ENTRY(h + 1), HUE_ENTRY(h + 2), HUE_ENTRY(h + 3)
+#define HUE_ENTRY_16(h) HUE_ENTRY_4(h), HUE_ENTRY_4(h + 4), HUE_ENTRY_4(h + 8), HUE_ENTRY_4(h + 12)
+#define HUE_ENTRY_64(h) HUE_ENTRY_16(h), HUE_ENTRY_16(h + 16), HUE_ENTRY_16(h + 32), HUE_ENTRY_16(h + 48)
+
+static const uint16_t hue_table[256] PROGMEM = {HUE_ENTRY_64(0), HUE_ENTRY_64(64), HUE_ENTRY_64(128), HUE_ENTRY_64(192)};
+
+// The red, green and blue channels of each hue region, as indexes into {v, p, q, t}
+static const uint8_t hue_region_channels[7][3] PROGMEM = {
+    {0, 3, 1}, {2, 0, 1}, {1, 0, 3}, {1, 2, 0}, {3, 1, 0}, {0, 1, 2}, {0, 3, 1},
+};
+
+void hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) {
+        uint8_t s = hsv[i].s;
+#ifdef USE_CIE1931_CURVE
+        uint8_t v = pgm_read_byte(&CIE1931_CURVE[hsv[i].v]);
+#else
+        uint8_t v = hsv[i].v;
+#endif
+
+        if (s == 0) {
+            rgb[i].r = v;
+            rgb[i].g = v;
+            rgb[i].b = v;
+            continue;
+        }
+
+        uint16_t hue       = pgm_read_word(&hue_table[hsv[i].h]);
+        uint8_t  region    = hue >> 8;
+        uint8_t  remainder = hue & 0xFF;
+
+        // Two 8x8 bit products per 32 bit multiply, one in each half word
+        uint32_t sr = (uint32_t)s * (remainder | ((uint32_t)(255 - remainder) << 16));
+        uint32_t qt = (uint32_t)v * ((255 - ((sr >> 8) & 0xFF)) | ((uint32_t)(255 - (sr >> 24)) << 16));
+
+        uint8_t channels[4] = {v, (v * (255 - s)) >> 8, (qt >> 8) & 0xFF, qt >> 24};
+
+        rgb[i].r = channels[pgm_read_byte(&hue_region_channels[region][0])];
+        rgb[i].g = channels[pgm_read_byte(&hue_region_channels[region][1])];
+        rgb[i].b = channels[pgm_read_byte(&hue_region_channels[region][2])];
+    }
+}
+
 #ifdef RGBW
 #    ifndef MIN
 #        define MIN(a, b) ((a) < (b) ? (a) : (b))
@@ -34,6 +34,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "command.h"
 #include "quantum.h"
 #include "version.h"
+#include "latency_trace.h"
 
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
@@ -542,6 +543,10 @@ static void command_console_help(void) {
           "ESC/q:	quit\n"
 #ifdef MOUSEKEY_ENABLE
           "m:	mousekey\n"
+#endif
+#ifdef LATENCY_TRACE_ENABLE
+          "l:	latency histograms\n"
+          "r:	reset latency histograms\n"
 #endif
     );
 }
@@ -562,6 +567,16 @@ static bool command_console(uint8_t code) {
             command_state = MOUSEKEY;
             mousekey_console(KC_SLASH /* ? */);
             return true;
+#endif
+#if defined(LATENCY_TRACE_ENABLE)
+        case KC_L:
+            latency_trace_dump();
+            print("C> ");
+            return true;
+        case KC_R:
+            latency_trace_clear();
+            print("C> ");
+            return true;
 #endif
         default:
             print("?");
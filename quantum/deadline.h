@@ -0,0 +1,39 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+
+/* Deadlines are reported as the number of milliseconds until a subsystem next
+ * needs its task to run. Zero means it needs servicing now, and DEADLINE_NONE
+ * means it has nothing pending.
+ */
+#define DEADLINE_NONE UINT32_MAX
+
+/** \brief The earlier of two deadlines
+ */
+static inline uint32_t deadline_min(uint32_t a, uint32_t b) {
+    return a < b ? a : b;
+}
+
+/** \brief Deadline for a timeout which has been running for the given time
+ */
+static inline uint32_t deadline_remaining(uint32_t elapsed, uint32_t timeout) {
+    return elapsed >= timeout ? 0 : timeout - elapsed;
+}
+
+/** \brief Milliseconds until the action layer next needs a tick event
+ */
+uint32_t action_next_deadline(void);
+
+/** \brief Milliseconds until quantum_task next has timed work to do
+ */
+uint32_t quantum_next_deadline(void);
+
+/** \brief Milliseconds until the main loop next has work to do, assuming no input changes
+ */
+uint32_t keyboard_next_deadline(void);
+
+uint32_t next_deadline_kb(void);
+uint32_t next_deadline_user(void);
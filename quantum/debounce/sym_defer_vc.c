@@ -0,0 +1,162 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+/*
+Symmetric per-key algorithm using vertical counters. Behaves like sym_defer_pk,
+but the counters are bit-sliced across a matrix_row_t: bit N of plane B holds
+bit B of the counter for column N. A whole row is then counted down with a
+handful of bitwise operations per counter bit, independent of MATRIX_COLS.
+When no state changes have occured for DEBOUNCE milliseconds, we push the state.
+*/
+
+#include "matrix.h"
+#include "timer.h"
+#include "quantum.h"
+#include <stdlib.h>
+
+#ifdef PROTOCOL_CHIBIOS
+#    if CH_CFG_USE_MEMCORE == FALSE
+#        error ChibiOS is configured without a memory allocator. Your keyboard may have set `#define CH_CFG_USE_MEMCORE FALSE`, which is incompatible with this debounce algorithm.
+#    endif
+#endif
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+// Maximum debounce: 255ms
+#if DEBOUNCE > UINT8_MAX
+#    undef DEBOUNCE
+#    define DEBOUNCE UINT8_MAX
+#endif
+
+// Number of bit planes needed to hold DEBOUNCE
+#if DEBOUNCE < 2
+#    define DEBOUNCE_COUNTER_BITS 1
+#elif DEBOUNCE < 4
+#    define DEBOUNCE_COUNTER_BITS 2
+#elif DEBOUNCE < 8
+#    define DEBOUNCE_COUNTER_BITS 3
+#elif DEBOUNCE < 16
+#    define DEBOUNCE_COUNTER_BITS 4
+#elif DEBOUNCE < 32
+#    define DEBOUNCE_COUNTER_BITS 5
+#elif DEBOUNCE < 64
+#    define DEBOUNCE_COUNTER_BITS 6
+#elif DEBOUNCE < 128
+#    define DEBOUNCE_COUNTER_BITS 7
+#else
+#    define DEBOUNCE_COUNTER_BITS 8
+#endif
+
+#define ALL_COLUMNS ((matrix_row_t)~(matrix_row_t)0)
+
+typedef struct {
+    matrix_row_t counting;                      // columns with a running counter
+    matrix_row_t planes[DEBOUNCE_COUNTER_BITS]; // remaining time, bit-sliced
+} debounce_row_t;
+
+#if DEBOUNCE > 0
+static debounce_row_t *debounce_rows;
+static fast_timer_t    last_time;
+static bool            counters_need_update;
+static bool            cooked_changed;
+
+static void update_debounce_counters_and_transfer_if_expired(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t elapsed_time);
+static void start_debounce_counters(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows);
+
+// we use num_rows rather than MATRIX_ROWS to support split keyboards
+void debounce_init(uint8_t num_rows) {
+    debounce_rows = (debounce_row_t *)calloc(num_rows, sizeof(debounce_row_t));
+}
+
+void debounce_free(void) {
+    free(debounce_rows);
+    debounce_rows = NULL;
+}
+
+bool debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    bool updated_last = false;
+    cooked_changed    = false;
+
+    if (counters_need_update) {
+        fast_timer_t now          = timer_read_fast();
+        fast_timer_t elapsed_time = TIMER_DIFF_FAST(now, last_time);
+
+        last_time    = now;
+        updated_last = true;
+        if (elapsed_time > DEBOUNCE) {
+            elapsed_time = DEBOUNCE;
+        }
+
+        if (elapsed_time > 0) {
+            update_debounce_counters_and_transfer_if_expired(raw, cooked, num_rows, elapsed_time);
+        }
+    }
+
+    if (changed) {
+        if (!updated_last) {
+            last_time = timer_read_fast();
+        }
+
+        start_debounce_counters(raw, cooked, num_rows);
+    }
+
+    return cooked_changed;
+}
+
+static void update_debounce_counters_and_transfer_if_expired(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t elapsed_time) {
+    counters_need_update = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        debounce_row_t *debounce_row = &debounce_rows[row];
+        matrix_row_t    counting     = debounce_row->counting;
+        if (!counting) {
+            continue;
+        }
+
+        // Subtract elapsed_time from every counter in the row, rippling the borrow through the planes
+        matrix_row_t borrow  = 0;
+        matrix_row_t nonzero = 0;
+        for (uint8_t bit = 0; bit < DEBOUNCE_COUNTER_BITS; bit++) {
+            matrix_row_t plane      = debounce_row->planes[bit];
+            matrix_row_t subtrahend = (elapsed_time & (1 << bit)) ? ALL_COLUMNS : 0;
+            matrix_row_t difference = plane ^ subtrahend ^ borrow;
+
+            borrow                    = (~plane & subtrahend) | (~(plane ^ subtrahend) & borrow);
+            nonzero                   = nonzero | difference;
+            debounce_row->planes[bit] = difference;
+        }
+
+        // Counters which were at or below elapsed_time have expired
+        matrix_row_t expired     = counting & (borrow | ~nonzero);
+        matrix_row_t cooked_next = (cooked[row] & ~expired) | (raw[row] & expired);
+        cooked_changed |= cooked[row] ^ cooked_next;
+        cooked[row] = cooked_next;
+
+        debounce_row->counting = counting & ~expired;
+        counters_need_update |= debounce_row->counting != 0;
+    }
+}
+
+static void start_debounce_counters(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows) {
+    for (uint8_t row = 0; row < num_rows; row++) {
+        debounce_row_t *debounce_row = &debounce_rows[row];
+        matrix_row_t    delta        = raw[row] ^ cooked[row];
+        matrix_row_t    starting     = delta & ~debounce_row->counting;
+
+        if (starting) {
+            for (uint8_t bit = 0; bit < DEBOUNCE_COUNTER_BITS; bit++) {
+                matrix_row_t preset       = (DEBOUNCE & (1 << bit)) ? starting : 0;
+                debounce_row->planes[bit] = (debounce_row->planes[bit] & ~starting) | preset;
+            }
+        }
+
+        // Keys which went back to their debounced state stop counting
+        debounce_row->counting = delta;
+        counters_need_update |= delta != 0;
+    }
+}
+
+#else
+#    include "none.c"
+#endif
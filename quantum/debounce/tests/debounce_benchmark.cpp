@@ -0,0 +1,326 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Compares the cost and behaviour of every debounce algorithm on the same
+// synthetic switch traces, and prints a table per trace:
+//  - time (and on x86, TSC cycles) spent in debounce() per scan, over a no-op baseline
+//  - latency from the physical key change to the debounced one
+//  - glitches, debounced changes which don't follow a physical change
+//  - missed, physical changes which never made it through
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#    define BENCHMARK_CYCLES() __rdtsc()
+#endif
+
+extern "C" {
+#include "quantum.h"
+#include "timer.h"
+#include "debounce.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+/* Each algorithm is built into its own namespace, so they can be compared
+ * within a single binary. Their file local macros are dropped after each. */
+namespace sym_defer_g {
+#include "../sym_defer_g.c"
+}
+namespace sym_defer_pr {
+#include "../sym_defer_pr.c"
+}
+namespace sym_defer_pk {
+#include "../sym_defer_pk.c"
+#undef ROW_SHIFTER
+#undef DEBOUNCE_ELAPSED
+}
+namespace sym_defer_vc {
+#include "../sym_defer_vc.c"
+#undef DEBOUNCE_COUNTER_BITS
+#undef ALL_COLUMNS
+}
+namespace sym_eager_pr {
+#include "../sym_eager_pr.c"
+#undef DEBOUNCE_ELAPSED
+}
+namespace sym_eager_pk {
+#include "../sym_eager_pk.c"
+#undef ROW_SHIFTER
+#undef DEBOUNCE_ELAPSED
+}
+namespace asym_eager_defer_pk {
+#include "../asym_eager_defer_pk.c"
+#undef ROW_SHIFTER
+#undef DEBOUNCE_ELAPSED
+}
+
+namespace {
+
+#define BENCHMARK_SCANS_PER_MS 4
+#define BENCHMARK_REPEATS 20
+
+struct algorithm_t {
+    const char *name;
+    void (*init)(uint8_t num_rows);
+    bool (*debounce)(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed);
+    void (*free)(void);
+};
+
+#define ALGORITHM(name) \
+    { #name, name::debounce_init, name::debounce, name::debounce_free }
+
+const algorithm_t algorithms[] = {
+    ALGORITHM(sym_defer_g), ALGORITHM(sym_defer_pr), ALGORITHM(sym_defer_pk), ALGORITHM(sym_defer_vc), ALGORITHM(sym_eager_pr), ALGORITHM(sym_eager_pk), ALGORITHM(asym_eager_defer_pk),
+};
+
+/* One matrix scan: what the switches are actually doing, and what was read */
+struct scan_t {
+    matrix_row_t physical[MATRIX_ROWS];
+    matrix_row_t raw[MATRIX_ROWS];
+};
+
+class Trace {
+   public:
+    explicit Trace(uint32_t duration_ms) : scans_(duration_ms * BENCHMARK_SCANS_PER_MS) {}
+
+    /* Change the physical state of a key at the given scan, with contact chatter for a few scans after */
+    void change(uint32_t scan, uint8_t row, uint8_t col, bool pressed, uint8_t bounces) {
+        matrix_row_t mask = (matrix_row_t)1 << col;
+        for (uint32_t i = scan; i < scans_.size(); i++) {
+            if (pressed) {
+                scans_[i].physical[row] |= mask;
+            } else {
+                scans_[i].physical[row] &= ~mask;
+            }
+        }
+        for (uint8_t i = 0; i < bounces; i++) {
+            bounces_.push_back({scan + 1 + next_random() % (2 * BENCHMARK_SCANS_PER_MS), row, mask});
+        }
+    }
+
+    /* Resolve chatter into the raw matrix; a bounce inverts the key for a single scan */
+    const std::vector<scan_t> &scans(void) {
+        for (auto &scan : scans_) {
+            std::copy(std::begin(scan.physical), std::end(scan.physical), std::begin(scan.raw));
+        }
+        for (auto &bounce : bounces_) {
+            if (bounce.scan < scans_.size()) {
+                scans_[bounce.scan].raw[bounce.row] ^= bounce.mask;
+            }
+        }
+        return scans_;
+    }
+
+    uint32_t next_random(void) {
+        seed_ = seed_ * 1103515245 + 12345;
+        return seed_ >> 16;
+    }
+
+   private:
+    struct bounce_t {
+        uint32_t     scan;
+        uint8_t      row;
+        matrix_row_t mask;
+    };
+
+    std::vector<scan_t>   scans_;
+    std::vector<bounce_t> bounces_;
+    uint32_t              seed_ = 1;
+};
+
+/* Nothing happens, the cost of scanning an idle keyboard */
+Trace idle_trace(void) {
+    return Trace(2000);
+}
+
+/* Random single keys typed at 10 keys per second, with bouncy contacts */
+Trace bouncy_trace(void) {
+    Trace trace(10000);
+    for (uint32_t ms = 0; ms + 100 < 10000; ms += 100) {
+        uint8_t row = trace.next_random() % MATRIX_ROWS;
+        uint8_t col = trace.next_random() % MATRIX_COLS;
+        trace.change(ms * BENCHMARK_SCANS_PER_MS, row, col, true, 1 + trace.next_random() % 6);
+        trace.change((ms + 30 + trace.next_random() % 40) * BENCHMARK_SCANS_PER_MS, row, col, false, 1 + trace.next_random() % 6);
+    }
+    return trace;
+}
+
+/* Rolling across every key, each held for 30ms and overlapping the next */
+Trace roll_trace(void) {
+    Trace    trace(MATRIX_ROWS * MATRIX_COLS * 15 + 100);
+    uint32_t ms = 0;
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            trace.change(ms * BENCHMARK_SCANS_PER_MS, row, col, true, trace.next_random() % 3);
+            trace.change((ms + 30) * BENCHMARK_SCANS_PER_MS, row, col, false, trace.next_random() % 3);
+            ms += 15;
+        }
+    }
+    return trace;
+}
+
+/* Every key pressed at once, held for 50ms and released, repeatedly */
+Trace full_matrix_trace(void) {
+    Trace trace(2000);
+    for (uint32_t ms = 0; ms + 100 < 2000; ms += 100) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                trace.change(ms * BENCHMARK_SCANS_PER_MS, row, col, true, trace.next_random() % 3);
+                trace.change((ms + 50) * BENCHMARK_SCANS_PER_MS, row, col, false, trace.next_random() % 3);
+            }
+        }
+    }
+    return trace;
+}
+
+struct result_t {
+    double   ns_per_scan;
+    double   cycles_per_scan;
+    double   average_latency;
+    uint32_t max_latency;
+    uint32_t glitches;
+    uint32_t missed;
+};
+
+void run_scan(const algorithm_t &algorithm, const scan_t &scan, matrix_row_t raw[], matrix_row_t cooked[], uint32_t index) {
+    if (index % BENCHMARK_SCANS_PER_MS == 0) {
+        advance_time(1);
+    }
+    bool changed = !std::equal(std::begin(scan.raw), std::end(scan.raw), raw);
+    std::copy(std::begin(scan.raw), std::end(scan.raw), raw);
+    algorithm.debounce(raw, cooked, MATRIX_ROWS, changed);
+}
+
+struct cost_t {
+    double ns_per_scan;
+    double cycles_per_scan;
+};
+
+void baseline_init(uint8_t num_rows) {}
+bool baseline_debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    return changed;
+}
+void baseline_free(void) {}
+
+const algorithm_t baseline_algorithm = {"baseline", baseline_init, baseline_debounce, baseline_free};
+
+cost_t run_cost(const algorithm_t &algorithm, const std::vector<scan_t> &scans) {
+    using clock = std::chrono::steady_clock;
+
+    matrix_row_t raw[MATRIX_ROWS];
+    matrix_row_t cooked[MATRIX_ROWS];
+    auto         start = clock::now();
+#ifdef BENCHMARK_CYCLES
+    uint64_t start_cycles = BENCHMARK_CYCLES();
+#endif
+    for (int repeat = 0; repeat < BENCHMARK_REPEATS; repeat++) {
+        std::fill(std::begin(raw), std::end(raw), 0);
+        std::fill(std::begin(cooked), std::end(cooked), 0);
+        set_time(7777);
+        algorithm.init(MATRIX_ROWS);
+        for (uint32_t i = 0; i < scans.size(); i++) {
+            run_scan(algorithm, scans[i], raw, cooked, i);
+        }
+        algorithm.free();
+    }
+    uint64_t cycles = 0;
+#ifdef BENCHMARK_CYCLES
+    cycles = BENCHMARK_CYCLES() - start_cycles;
+#endif
+    auto elapsed = clock::now() - start;
+
+    uint64_t total_scans = (uint64_t)scans.size() * BENCHMARK_REPEATS;
+    return {(double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / total_scans, (double)cycles / total_scans};
+}
+
+result_t run_trace(const algorithm_t &algorithm, const std::vector<scan_t> &scans) {
+    result_t result = {};
+
+    /* Behaviour: track when each key last changed physically, and whether the change is still pending */
+    matrix_row_t raw[MATRIX_ROWS]    = {};
+    matrix_row_t cooked[MATRIX_ROWS] = {};
+    uint32_t     changed_at[MATRIX_ROWS][MATRIX_COLS];
+    matrix_row_t pending[MATRIX_ROWS] = {};
+    uint64_t     latency_total        = 0;
+    uint32_t     latency_count        = 0;
+
+    set_time(7777);
+    algorithm.init(MATRIX_ROWS);
+    for (uint32_t i = 0; i < scans.size(); i++) {
+        matrix_row_t previous[MATRIX_ROWS];
+        std::copy(std::begin(cooked), std::end(cooked), previous);
+        run_scan(algorithm, scans[i], raw, cooked, i);
+
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            matrix_row_t physical_changes = i > 0 ? scans[i].physical[row] ^ scans[i - 1].physical[row] : scans[i].physical[row];
+            matrix_row_t cooked_changes   = cooked[row] ^ previous[row];
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                matrix_row_t mask = (matrix_row_t)1 << col;
+                if (physical_changes & mask) {
+                    // A change that was never reported before the key changed back is missed
+                    result.missed += (pending[row] & mask) ? 1 : 0;
+                    changed_at[row][col] = i;
+                    pending[row] ^= mask;
+                }
+                if (cooked_changes & mask) {
+                    if ((pending[row] & mask) && !((cooked[row] ^ scans[i].physical[row]) & mask)) {
+                        uint32_t latency = (i - changed_at[row][col]) / BENCHMARK_SCANS_PER_MS;
+                        latency_total += latency;
+                        latency_count++;
+                        result.max_latency = std::max(result.max_latency, latency);
+                        pending[row] &= ~mask;
+                    } else {
+                        result.glitches++;
+                        pending[row] ^= mask;
+                    }
+                }
+            }
+        }
+    }
+    algorithm.free();
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        result.missed += __builtin_popcountll(pending[row]);
+    }
+    result.average_latency = latency_count ? (double)latency_total / latency_count : 0;
+
+    /* Cost: replay the trace, less the cost of replaying it through a debounce that does nothing */
+    cost_t cost            = run_cost(algorithm, scans);
+    cost_t baseline        = run_cost(baseline_algorithm, scans);
+    result.ns_per_scan     = std::max(0.0, cost.ns_per_scan - baseline.ns_per_scan);
+    result.cycles_per_scan = std::max(0.0, cost.cycles_per_scan - baseline.cycles_per_scan);
+    return result;
+}
+
+void print_table(const char *trace_name, std::function<Trace(void)> make_trace) {
+    Trace                      trace = make_trace();
+    const std::vector<scan_t> &scans = trace.scans();
+
+    std::cout << "[ BENCHMARK] " << trace_name << ": " << scans.size() << " scans of " << MATRIX_ROWS << "x" << MATRIX_COLS << ", DEBOUNCE " << DEBOUNCE << std::endl;
+    std::cout << std::left << std::setw(22) << "algorithm" << std::right << std::setw(10) << "ns/scan" << std::setw(14) << "cycles/scan" << std::setw(14) << "avg latency" << std::setw(14) << "max latency" << std::setw(10) << "glitches" << std::setw(8) << "missed" << std::endl;
+    for (const auto &algorithm : algorithms) {
+        result_t result = run_trace(algorithm, scans);
+        std::cout << std::left << std::setw(22) << algorithm.name << std::right << std::fixed << std::setprecision(1) << std::setw(10) << result.ns_per_scan << std::setw(14) << result.cycles_per_scan << std::setw(12) << result.average_latency << "ms" << std::setw(12) << result.max_latency << "ms" << std::setw(10) << result.glitches << std::setw(8) << result.missed << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+} // namespace
+
+TEST(DebounceBenchmark, CompareAlgorithms) {
+    print_table("idle", idle_trace);
+    print_table("bouncy typing", bouncy_trace);
+    print_table("roll", roll_trace);
+    print_table("full matrix", full_matrix_trace);
+}
@@ -33,6 +33,12 @@ debounce_sym_defer_pr_SRC := $(DEBOUNCE_COMMON_SRC) \
 	$(QUANTUM_PATH)/debounce/sym_defer_pr.c \
 	$(QUANTUM_PATH)/debounce/tests/sym_defer_pr_tests.cpp
 
+debounce_sym_defer_vc_DEFS := $(DEBOUNCE_COMMON_DEFS)
+debounce_sym_defer_vc_SRC := $(DEBOUNCE_COMMON_SRC) \
+	$(QUANTUM_PATH)/debounce/sym_defer_vc.c \
+	$(QUANTUM_PATH)/debounce/tests/sym_defer_pk_tests.cpp \
+	$(QUANTUM_PATH)/debounce/tests/sym_defer_vc_tests.cpp
+
 debounce_sym_eager_pk_DEFS := $(DEBOUNCE_COMMON_DEFS)
 debounce_sym_eager_pk_SRC := $(DEBOUNCE_COMMON_SRC) \
 	$(QUANTUM_PATH)/debounce/sym_eager_pk.c \
@@ -47,3 +53,7 @@ debounce_asym_eager_defer_pk_DEFS := $(DEBOUNCE_COMMON_DEFS)
 debounce_asym_eager_defer_pk_SRC := $(DEBOUNCE_COMMON_SRC) \
 	$(QUANTUM_PATH)/debounce/asym_eager_defer_pk.c \
 	$(QUANTUM_PATH)/debounce/tests/asym_eager_defer_pk_tests.cpp
+
+debounce_benchmark_DEFS := -DMATRIX_ROWS=6 -DMATRIX_COLS=20 -DDEBOUNCE=5
+debounce_benchmark_SRC := $(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c \
+	$(QUANTUM_PATH)/debounce/tests/debounce_benchmark.cpp
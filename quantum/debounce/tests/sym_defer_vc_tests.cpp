@@ -0,0 +1,80 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Behaviour is shared with sym_defer_pk, whose tests are also run against
+// sym_defer_vc. These cover many counters sharing a row.
+
+#include "gtest/gtest.h"
+
+#include "debounce_test_common.h"
+
+TEST_F(DebounceTest, FullRowSimultaneous) {
+    addEvents({
+        /* Time, Inputs, Outputs */
+        {0, {{0, 0, DOWN}, {0, 1, DOWN}, {0, 2, DOWN}, {0, 3, DOWN}, {0, 4, DOWN}, {0, 5, DOWN}, {0, 6, DOWN}, {0, 7, DOWN}, {0, 8, DOWN}, {0, 9, DOWN}}, {}},
+
+        {5, {}, {{0, 0, DOWN}, {0, 1, DOWN}, {0, 2, DOWN}, {0, 3, DOWN}, {0, 4, DOWN}, {0, 5, DOWN}, {0, 6, DOWN}, {0, 7, DOWN}, {0, 8, DOWN}, {0, 9, DOWN}}},
+
+        {8, {{0, 0, UP}, {0, 1, UP}, {0, 2, UP}, {0, 3, UP}, {0, 4, UP}, {0, 5, UP}, {0, 6, UP}, {0, 7, UP}, {0, 8, UP}, {0, 9, UP}}, {}},
+
+        {13, {}, {{0, 0, UP}, {0, 1, UP}, {0, 2, UP}, {0, 3, UP}, {0, 4, UP}, {0, 5, UP}, {0, 6, UP}, {0, 7, UP}, {0, 8, UP}, {0, 9, UP}}},
+    });
+    runEvents();
+}
+
+TEST_F(DebounceTest, RowStaggered) {
+    addEvents({
+        /* Time, Inputs, Outputs */
+        {0, {{0, 0, DOWN}}, {}},
+        {1, {{0, 3, DOWN}}, {}},
+        {2, {{0, 6, DOWN}}, {}},
+        {3, {{0, 9, DOWN}}, {}},
+
+        {5, {}, {{0, 0, DOWN}}},
+        {6, {}, {{0, 3, DOWN}}},
+        {7, {}, {{0, 6, DOWN}}},
+        {8, {}, {{0, 9, DOWN}}},
+    });
+    runEvents();
+}
+
+TEST_F(DebounceTest, RowOneKeyBouncingOthersSettle) {
+    addEvents({
+        /* Time, Inputs, Outputs */
+        {0, {{0, 1, DOWN}, {0, 2, DOWN}}, {}},
+        {1, {{0, 2, UP}}, {}},
+        {2, {{0, 2, DOWN}}, {}},
+        {3, {{0, 2, UP}}, {}},
+        {4, {{0, 2, DOWN}}, {}},
+
+        {5, {}, {{0, 1, DOWN}}},
+        {9, {}, {{0, 2, DOWN}}}, /* 5ms after DOWN at time 4 */
+    });
+    runEvents();
+}
+
+TEST_F(DebounceTest, RowsIndependent) {
+    addEvents({
+        /* Time, Inputs, Outputs */
+        {0, {{0, 1, DOWN}, {3, 1, DOWN}}, {}},
+        {2, {{1, 1, DOWN}}, {}},
+        {3, {{3, 1, UP}}, {}},
+
+        {5, {}, {{0, 1, DOWN}}},
+        {7, {}, {{1, 1, DOWN}}},
+    });
+    runEvents();
+}
+
+TEST_F(DebounceTest, RowDelayedScan) {
+    addEvents({
+        /* Time, Inputs, Outputs */
+        {0, {{0, 1, DOWN}}, {}},
+        {3, {{0, 8, DOWN}}, {}},
+
+        /* Processing is very late, both keys expire together */
+        {300, {}, {{0, 1, DOWN}, {0, 8, DOWN}}},
+    });
+    time_jumps_ = true;
+    runEvents();
+}
@@ -4,39 +4,175 @@
 #include <stddef.h>
 #include <timer.h>
 #include <deferred_exec.h>
+#include <deadline.h>
 
 #ifndef MAX_DEFERRED_EXECUTORS
 #    define MAX_DEFERRED_EXECUTORS 8
 #endif
 
+// Heap positions are stored in 16 bits, and tokens need room for the slot number plus a full 8-bit generation
+#define DEFERRED_EXEC_MAX_TABLE_COUNT 65535
+#define DEFERRED_EXEC_SLOT_BITS_MAX 16
+#define DEFERRED_EXEC_GENERATION_BITS 8
+
+_Static_assert(MAX_DEFERRED_EXECUTORS <= DEFERRED_EXEC_MAX_TABLE_COUNT, "MAX_DEFERRED_EXECUTORS must be at most 65535");
+_Static_assert(sizeof(deferred_token) * 8 >= DEFERRED_EXEC_SLOT_BITS_MAX + DEFERRED_EXEC_GENERATION_BITS, "deferred_token must hold a slot number and a full generation");
+
 //------------------------------------
 // Helpers
 //
+// Each table is kept as a binary min-heap ordered by trigger time. Entries never move -- instead, the heap is a
+// permutation of slot indices threaded through the table itself, so that a token can map directly onto its slot:
+//   - `table[p].heap_slot` holds the slot at heap position `p`
+//   - `table[s].heap_pos` holds the heap position of slot `s`
+// Both are stored XOR'ed with their own index, so a zero-initialised table is the identity permutation.
+//
+// Heap positions are partitioned as [0, heap) scheduled, [heap, used) detached, and [used, table_count) free. Detached
+// executors are ones that were requeued during a task invocation yet are still overdue; they are held out of the heap
+// until the end of that invocation so that each executor runs at most once per pass.
+//
 
-static deferred_token current_token = 0;
+static inline size_t slot_at(deferred_executor_t *table, size_t pos) {
+    return table[pos].heap_slot ^ pos;
+}
 
-static inline bool token_can_be_used(deferred_executor_t *table, size_t table_count, deferred_token token) {
-    if (token == INVALID_DEFERRED_TOKEN) {
-        return false;
+static inline size_t pos_of(deferred_executor_t *table, size_t slot) {
+    return table[slot].heap_pos ^ slot;
+}
+
+static inline void place(deferred_executor_t *table, size_t pos, size_t slot) {
+    table[pos].heap_slot = (uint16_t)(slot ^ pos);
+    table[slot].heap_pos = (uint16_t)(pos ^ slot);
+}
+
+static inline void swap_positions(deferred_executor_t *table, size_t a, size_t b) {
+    size_t slot_a = slot_at(table, a);
+    size_t slot_b = slot_at(table, b);
+    place(table, a, slot_b);
+    place(table, b, slot_a);
+}
+
+static inline bool is_earlier(deferred_executor_t *table, size_t a, size_t b) {
+    return ((int32_t)TIMER_DIFF_32(table[slot_at(table, a)].trigger_time, table[slot_at(table, b)].trigger_time)) < 0;
+}
+
+static size_t used_count(deferred_executor_t *table, size_t table_count) {
+    // Allocated executors always occupy a prefix of the heap positions, so binary search for its end
+    size_t lo = 0, hi = table_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (table[slot_at(table, mid)].token != INVALID_DEFERRED_TOKEN) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
     }
-    for (int i = 0; i < table_count; ++i) {
-        if (table[i].token == token) {
-            return false;
+    return lo;
+}
+
+static size_t heap_count(deferred_executor_t *table, size_t used) {
+    // Scheduled executors are a prefix of the allocated ones, with any detached executors following
+    size_t lo = 0, hi = used;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (!table[slot_at(table, mid)].detached) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
     }
-    return true;
+    return lo;
 }
 
-static inline deferred_token allocate_token(deferred_executor_t *table, size_t table_count) {
-    deferred_token first = ++current_token;
-    while (!token_can_be_used(table, table_count, current_token)) {
-        ++current_token;
-        if (current_token == first) {
-            // If we've looped back around to the first, everything is already allocated (yikes!). Need to exit with a failure.
-            return INVALID_DEFERRED_TOKEN;
+static size_t sift_up(deferred_executor_t *table, size_t pos) {
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (!is_earlier(table, pos, parent)) {
+            break;
         }
+        swap_positions(table, pos, parent);
+        pos = parent;
+    }
+    return pos;
+}
+
+static void sift_down(deferred_executor_t *table, size_t heap, size_t pos) {
+    while (true) {
+        size_t child = 2 * pos + 1;
+        if (child >= heap) {
+            break;
+        }
+        if (child + 1 < heap && is_earlier(table, child + 1, child)) {
+            ++child;
+        }
+        if (!is_earlier(table, child, pos)) {
+            break;
+        }
+        swap_positions(table, pos, child);
+        pos = child;
+    }
+}
+
+static inline void restore_heap(deferred_executor_t *table, size_t heap, size_t pos) {
+    if (sift_up(table, pos) == pos) {
+        sift_down(table, heap, pos);
+    }
+}
+
+static inline uint8_t slot_bits(size_t table_count) {
+    uint8_t bits = 0;
+    while ((table_count >> bits) != 0) {
+        ++bits;
+    }
+    return bits;
+}
+
+static inline deferred_token allocate_token(deferred_executor_t *table, size_t table_count, size_t slot) {
+    // Tokens carry their slot in the low bits, with the slot's monotonically increasing generation above so that stale
+    // tokens don't match a later executor reusing the same slot
+    ++table[slot].generation;
+    return ((deferred_token)table[slot].generation << slot_bits(table_count)) | (deferred_token)(slot + 1);
+}
+
+static deferred_executor_t *find_executor(deferred_executor_t *table, size_t table_count, deferred_token token) {
+    size_t slot = (size_t)(token & ((1UL << slot_bits(table_count)) - 1)) - 1;
+    if (slot >= table_count || table[slot].token != token) {
+        return NULL;
+    }
+    return &table[slot];
+}
+
+static void release_executor(deferred_executor_t *table, size_t table_count, size_t pos) {
+    size_t used = used_count(table, table_count);
+    size_t heap = heap_count(table, used);
+    size_t slot = slot_at(table, pos);
+
+    if (pos < heap) {
+        // Move the executor to the end of the heap, then swap it past any detached executors into the free region
+        swap_positions(table, pos, heap - 1);
+        swap_positions(table, heap - 1, used - 1);
+        if (pos < heap - 1) {
+            restore_heap(table, heap - 1, pos);
+        }
+    } else {
+        swap_positions(table, pos, used - 1);
+    }
+
+    deferred_executor_t *entry = &table[slot];
+    entry->token               = INVALID_DEFERRED_TOKEN;
+    entry->detached            = false;
+    entry->trigger_time        = 0;
+    entry->callback            = NULL;
+    entry->cb_arg              = NULL;
+}
+
+static void detach_executor(deferred_executor_t *table, size_t heap, size_t pos) {
+    size_t slot = slot_at(table, pos);
+    swap_positions(table, pos, heap - 1);
+    table[slot].detached = true;
+    if (pos < heap - 1) {
+        restore_heap(table, heap - 1, pos);
     }
-    return current_token;
 }
 
 //------------------------------------
@@ -45,31 +181,33 @@ static inline deferred_token allocate_token(deferred_executor_t *table, size_t t
 
 deferred_token defer_exec_advanced(deferred_executor_t *table, size_t table_count, uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg) {
     // Ignore queueing if the table isn't valid, it's a zero-time delay, or the token is not valid
-    if (!table || table_count == 0 || delay_ms == 0 || !callback) {
+    if (!table || table_count == 0 || table_count > DEFERRED_EXEC_MAX_TABLE_COUNT || delay_ms == 0 || !callback) {
         return INVALID_DEFERRED_TOKEN;
     }
 
-    // Find an unused slot and claim it
-    for (int i = 0; i < table_count; ++i) {
-        deferred_executor_t *entry = &table[i];
-        if (entry->token == INVALID_DEFERRED_TOKEN) {
-            // Work out the new token value, dropping out if none were available
-            deferred_token token = allocate_token(table, table_count);
-            if (token == INVALID_DEFERRED_TOKEN) {
-                return false;
-            }
+    // The first free heap position always refers to an unused slot
+    size_t used = used_count(table, table_count);
+    if (used == table_count) {
+        // None available
+        return INVALID_DEFERRED_TOKEN;
+    }
 
-            // Set up the executor table entry
-            entry->token        = current_token;
-            entry->trigger_time = timer_read32() + delay_ms;
-            entry->callback     = callback;
-            entry->cb_arg       = cb_arg;
-            return current_token;
-        }
+    // Keep the detached executors contiguous by moving the first of them to the end
+    size_t heap = heap_count(table, used);
+    if (heap < used) {
+        swap_positions(table, heap, used);
     }
 
-    // None available
-    return INVALID_DEFERRED_TOKEN;
+    // Set up the executor table entry
+    size_t               slot  = slot_at(table, heap);
+    deferred_executor_t *entry = &table[slot];
+    entry->token               = allocate_token(table, table_count, slot);
+    entry->detached            = false;
+    entry->trigger_time        = timer_read32() + delay_ms;
+    entry->callback            = callback;
+    entry->cb_arg              = cb_arg;
+    sift_up(table, heap);
+    return entry->token;
 }
 
 bool extend_deferred_exec_advanced(deferred_executor_t *table, size_t table_count, deferred_token token, uint32_t delay_ms) {
@@ -79,17 +217,18 @@ bool extend_deferred_exec_advanced(deferred_executor_t *table, size_t table_coun
     }
 
     // Find the entry corresponding to the token
-    for (int i = 0; i < table_count; ++i) {
-        deferred_executor_t *entry = &table[i];
-        if (entry->token == token) {
-            // Found it, extend the delay
-            entry->trigger_time = timer_read32() + delay_ms;
-            return true;
-        }
+    deferred_executor_t *entry = find_executor(table, table_count, token);
+    if (!entry) {
+        // Not found
+        return false;
     }
 
-    // Not found
-    return false;
+    // Found it, extend the delay -- detached executors are requeued at the end of the current task invocation
+    entry->trigger_time = timer_read32() + delay_ms;
+    if (!entry->detached) {
+        restore_heap(table, heap_count(table, used_count(table, table_count)), pos_of(table, entry - table));
+    }
+    return true;
 }
 
 bool cancel_deferred_exec_advanced(deferred_executor_t *table, size_t table_count, deferred_token token) {
@@ -99,20 +238,15 @@ bool cancel_deferred_exec_advanced(deferred_executor_t *table, size_t table_coun
     }
 
     // Find the entry corresponding to the token
-    for (int i = 0; i < table_count; ++i) {
-        deferred_executor_t *entry = &table[i];
-        if (entry->token == token) {
-            // Found it, cancel and clear the table entry
-            entry->token        = INVALID_DEFERRED_TOKEN;
-            entry->trigger_time = 0;
-            entry->callback     = NULL;
-            entry->cb_arg       = NULL;
-            return true;
-        }
+    deferred_executor_t *entry = find_executor(table, table_count, token);
+    if (!entry) {
+        // Not found
+        return false;
     }
 
-    // Not found
-    return false;
+    // Found it, cancel and clear the table entry
+    release_executor(table, table_count, pos_of(table, entry - table));
+    return true;
 }
 
 void deferred_exec_advanced_task(deferred_executor_t *table, size_t table_count, uint32_t *last_execution_time) {
@@ -122,32 +256,66 @@ void deferred_exec_advanced_task(deferred_executor_t *table, size_t table_count,
     if (((int32_t)TIMER_DIFF_32(now, (*last_execution_time))) > 0) {
         *last_execution_time = now;
 
-        // Run through each of the executors
-        for (int i = 0; i < table_count; ++i) {
-            deferred_executor_t *entry = &table[i];
-
-            // Check if we're supposed to execute this entry
-            if (entry->token != INVALID_DEFERRED_TOKEN && ((int32_t)TIMER_DIFF_32(entry->trigger_time, now)) <= 0) {
-                // Invoke the callback and work work out if we should be requeued
-                uint32_t delay_ms = entry->callback(entry->trigger_time, entry->cb_arg);
-
-                // Update the trigger time if we have to repeat, otherwise clear it out
-                if (delay_ms > 0) {
-                    // Intentionally add just the delay to the existing trigger time -- this ensures the next
-                    // invocation is with respect to the previous trigger, rather than when it got to execution. Under
-                    // normal circumstances this won't cause issue, but if another executor is invoked that takes a
-                    // considerable length of time, then this ensures best-effort timing between invocations.
-                    entry->trigger_time += delay_ms;
+        // Run through each of the due executors in trigger order -- the root of the heap is the earliest, so if it's
+        // unused, detached, or not yet due then there's nothing left to do
+        while (true) {
+            deferred_executor_t *entry = &table[slot_at(table, 0)];
+            if (entry->token == INVALID_DEFERRED_TOKEN || entry->detached || ((int32_t)TIMER_DIFF_32(entry->trigger_time, now)) > 0) {
+                break;
+            }
+
+            // Invoke the callback and work work out if we should be requeued
+            deferred_token token    = entry->token;
+            uint32_t       delay_ms = entry->callback(entry->trigger_time, entry->cb_arg);
+
+            // The callback may have cancelled its own execution, in which case the slot is no longer ours
+            if (entry->token != token) {
+                continue;
+            }
+
+            size_t pos = pos_of(table, entry - table);
+
+            // Update the trigger time if we have to repeat, otherwise clear it out
+            if (delay_ms > 0) {
+                // Intentionally add just the delay to the existing trigger time -- this ensures the next
+                // invocation is with respect to the previous trigger, rather than when it got to execution. Under
+                // normal circumstances this won't cause issue, but if another executor is invoked that takes a
+                // considerable length of time, then this ensures best-effort timing between invocations.
+                entry->trigger_time += delay_ms;
+                size_t heap = heap_count(table, used_count(table, table_count));
+                if (((int32_t)TIMER_DIFF_32(entry->trigger_time, now)) <= 0) {
+                    // Still overdue, hold it back until the next invocation so other due executors get their turn
+                    detach_executor(table, heap, pos);
                 } else {
-                    // If it was zero, then the callback is cancelling repeated execution. Free up the slot.
-                    entry->token        = INVALID_DEFERRED_TOKEN;
-                    entry->trigger_time = 0;
-                    entry->callback     = NULL;
-                    entry->cb_arg       = NULL;
+                    restore_heap(table, heap, pos);
                 }
+            } else {
+                // If it was zero, then the callback is cancelling repeated execution. Free up the slot.
+                release_executor(table, table_count, pos);
             }
         }
+
+        // Return any overdue executors to the heap
+        size_t used = used_count(table, table_count);
+        for (size_t pos = heap_count(table, used); pos < used; ++pos) {
+            table[slot_at(table, pos)].detached = false;
+            sift_up(table, pos);
+        }
+    }
+}
+
+uint32_t deferred_exec_advanced_next_deadline(deferred_executor_t *table, size_t table_count) {
+    if (!table || table_count == 0) {
+        return DEADLINE_NONE;
+    }
+
+    // Only the root of the heap matters
+    deferred_executor_t *entry = &table[slot_at(table, 0)];
+    if (entry->token == INVALID_DEFERRED_TOKEN) {
+        return DEADLINE_NONE;
     }
+    int32_t remaining = (int32_t)TIMER_DIFF_32(entry->trigger_time, timer_read32());
+    return remaining > 0 ? (uint32_t)remaining : 0;
 }
 
 //------------------------------------
@@ -169,3 +337,6 @@ bool cancel_deferred_exec(deferred_token token) {
 void deferred_exec_task(void) {
     deferred_exec_advanced_task(basic_executors, MAX_DEFERRED_EXECUTORS, &last_deferred_exec_check);
 }
+uint32_t deferred_exec_next_deadline(void) {
+    return deferred_exec_advanced_next_deadline(basic_executors, MAX_DEFERRED_EXECUTORS);
+}
@@ -13,8 +13,9 @@
 
 /**
  * @typedef A token that can be used to cancel or extend an existing deferred execution.
+ * @brief Holds the table slot in the low bits and an 8-bit generation above it, so a 65535 entry table needs 24 bits.
  */
-typedef uint8_t deferred_token;
+typedef uint32_t deferred_token;
 
 /**
  * @def The constant used to denote an invalid deferred execution token.
@@ -65,6 +66,11 @@ bool cancel_deferred_exec(deferred_token token);
  */
 void deferred_exec_task(void);
 
+/**
+ * Returns the number of milliseconds until the next deferred execution is due, or DEADLINE_NONE if nothing is scheduled.
+ */
+uint32_t deferred_exec_next_deadline(void);
+
 //------------------------------------
 // Advanced API: used when a custom-allocated table is used, primarily for core code.
 //------------------------------------
@@ -73,12 +79,17 @@ void deferred_exec_task(void);
  * @struct Structure for containing self-hosted deferred executor tables.
  * @brief Core-side code can use this to create their own tables without impacting on the use of users' ability to add deferred execution.
  *        Code outside deferred_exec.c should not worry about internals of this struct, and should just allocate the required number in an array.
+ *        A zero-initialised array is a valid empty table. Tables are limited to 65535 entries.
  */
 typedef struct deferred_executor_t {
     deferred_token         token;
     uint32_t               trigger_time;
     deferred_exec_callback callback;
     void *                 cb_arg;
+    uint16_t               heap_slot;
+    uint16_t               heap_pos;
+    uint8_t                generation;
+    bool                   detached;
 } deferred_executor_t;
 
 /**
@@ -119,3 +130,12 @@ bool cancel_deferred_exec_advanced(deferred_executor_t *table, size_t table_coun
  * @param last_execution_time[in,out] the last execution time -- this will be checked first to determine if execution is needed, and updated if execution occurred
  */
 void deferred_exec_advanced_task(deferred_executor_t *table, size_t table_count, uint32_t *last_execution_time);
+
+/**
+ * Returns the number of milliseconds until the next deferred execution in a custom-allocated table is due.
+ *
+ * @param table[in] the custom table used for storage
+ * @param table_count[in] the number of available items in the table
+ * @return the delay until the earliest executor triggers, or DEADLINE_NONE if nothing is scheduled
+ */
+uint32_t deferred_exec_advanced_next_deadline(deferred_executor_t *table, size_t table_count);
@@ -33,6 +33,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "sendchar.h"
 #include "eeconfig.h"
 #include "action_layer.h"
+#include "latency_trace.h"
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
 #endif
@@ -108,6 +109,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef LEADER_ENABLE
 #    include "leader.h"
 #endif
+#ifdef MATRIX_INTERRUPT_ENABLE
+#    include "matrix_interrupt.h"
+#endif
 
 static uint32_t last_input_modification_time = 0;
 uint32_t        last_input_activity_time(void) {
@@ -144,24 +148,50 @@ void last_encoder_activity_trigger(void) {
 static uint32_t matrix_timer           = 0;
 static uint32_t matrix_scan_count      = 0;
 static uint32_t last_matrix_scan_count = 0;
+#    if defined(MATRIX_INTERRUPT_ENABLE)
+static uint32_t matrix_idle_time      = 0;
+static uint32_t last_matrix_idle_time = 0;
+#    endif
 
-void matrix_scan_perf_task(void) {
-    matrix_scan_count++;
-
+static void matrix_perf_rollover(void) {
     uint32_t timer_now = timer_read32();
     if (TIMER_DIFF_32(timer_now, matrix_timer) >= 1000) {
 #    if defined(CONSOLE_ENABLE)
+#        if defined(MATRIX_INTERRUPT_ENABLE)
+        dprintf("matrix scan frequency: %lu, idle: %lu ms\n", matrix_scan_count, matrix_idle_time);
+#        else
         dprintf("matrix scan frequency: %lu\n", matrix_scan_count);
+#        endif
 #    endif
         last_matrix_scan_count = matrix_scan_count;
         matrix_timer           = timer_now;
         matrix_scan_count      = 0;
+#    if defined(MATRIX_INTERRUPT_ENABLE)
+        last_matrix_idle_time = matrix_idle_time;
+        matrix_idle_time      = 0;
+#    endif
     }
 }
 
+void matrix_scan_perf_task(void) {
+    matrix_scan_count++;
+    matrix_perf_rollover();
+}
+
 uint32_t get_matrix_scan_rate(void) {
     return last_matrix_scan_count;
 }
+
+#    if defined(MATRIX_INTERRUPT_ENABLE)
+void matrix_idle_perf_task(uint32_t idle_ms) {
+    matrix_idle_time += idle_ms;
+    matrix_perf_rollover();
+}
+
+uint32_t get_matrix_idle_time(void) {
+    return last_matrix_idle_time;
+}
+#    endif
 #else
 #    define matrix_scan_perf_task()
 #endif
@@ -260,6 +290,96 @@ __attribute__((weak)) bool matrix_can_read(void) {
     return true;
 }
 
+#ifdef MATRIX_INTERRUPT_ENABLE
+#    ifndef MATRIX_INTERRUPT_IDLE_TIMEOUT
+#        define MATRIX_INTERRUPT_IDLE_TIMEOUT 50
+#    endif
+#    if defined(TICKLESS_IDLE_ENABLE) && !defined(TICKLESS_IDLE_MAX_SLEEP)
+#        define TICKLESS_IDLE_MAX_SLEEP 10
+#    endif
+
+/** \brief matrix_interrupt_arm
+ *
+ * Fallback for custom matrix implementations that cannot be parked, which keeps the matrix polled.
+ */
+__attribute__((weak)) bool matrix_interrupt_arm(void) {
+    return false;
+}
+
+/** \brief matrix_interrupt_disarm
+ *
+ * Fallback for custom matrix implementations that cannot be parked.
+ */
+__attribute__((weak)) void matrix_interrupt_disarm(void) {}
+
+static bool     matrix_armed      = false;
+static uint16_t matrix_idle_timer = 0;
+
+/**
+ * @brief Sleeps while the matrix is parked and wakes it up again once an edge
+ * has been seen on one of its inputs.
+ *
+ * @return true The matrix should be scanned
+ * @return false The matrix is parked and nothing has changed
+ */
+static bool matrix_interrupt_task(void) {
+    if (!matrix_armed) {
+        return true;
+    }
+
+    if (!matrix_interrupt_pending()) {
+#    ifdef TICKLESS_IDLE_ENABLE
+        // Sleep until the earliest pending timer needs attention
+        const uint32_t timeout = deadline_min(keyboard_next_deadline(), TICKLESS_IDLE_MAX_SLEEP);
+#    else
+        const uint32_t timeout = 1;
+#    endif
+#    if defined(DEBUG_MATRIX_SCAN_RATE)
+        const uint32_t idle_start = timer_read32();
+        matrix_interrupt_wait(timeout);
+        matrix_idle_perf_task(timer_elapsed32(idle_start));
+#    else
+        matrix_interrupt_wait(timeout);
+#    endif
+
+        if (!matrix_interrupt_pending()) {
+            return false;
+        }
+    }
+
+    // Scan in a burst until the debounced state settles again
+    matrix_interrupt_disarm();
+    matrix_armed      = false;
+    matrix_idle_timer = timer_read();
+    return true;
+}
+
+/**
+ * @brief Parks the matrix once all keys have been released and nothing has
+ * changed for MATRIX_INTERRUPT_IDLE_TIMEOUT milliseconds.
+ */
+static void matrix_interrupt_idle_check(bool matrix_changed) {
+    bool keys_down = false;
+    for (uint8_t row = 0; row < MATRIX_ROWS && !keys_down; row++) {
+        keys_down |= matrix_get_row(row) != 0;
+    }
+
+    if (matrix_changed || keys_down) {
+        matrix_idle_timer = timer_read();
+        return;
+    }
+
+    if (timer_elapsed(matrix_idle_timer) >= MATRIX_INTERRUPT_IDLE_TIMEOUT) {
+        matrix_interrupt_clear();
+        matrix_armed = matrix_interrupt_arm();
+        if (!matrix_armed) {
+            // Something is still held on the raw matrix, try again later
+            matrix_idle_timer = timer_read();
+        }
+    }
+}
+#endif
+
 /** \brief keyboard_setup
  *
  * FIXME: needs doc
@@ -444,8 +564,14 @@ static inline void generate_tick_event(void) {
     static uint16_t last_tick = 0;
     const uint16_t  now       = timer_read();
     if (TIMER_DIFF_16(now, last_tick) != 0) {
-        action_exec(TICK_EVENT);
         last_tick = now;
+#ifdef TICKLESS_IDLE_ENABLE
+        // Tick events only drive timeouts, so skip them while none are due
+        if (action_next_deadline() != 0) {
+            return;
+        }
+#endif
+        action_exec(TICK_EVENT);
     }
 }
 
@@ -462,9 +588,18 @@ static bool matrix_task(void) {
         return false;
     }
 
+#ifdef MATRIX_INTERRUPT_ENABLE
+    if (!matrix_interrupt_task()) {
+        generate_tick_event();
+        return false;
+    }
+#endif
+
     static matrix_row_t matrix_previous[MATRIX_ROWS];
 
+    LATENCY_TRACE_BEGIN(LATENCY_STAGE_SCAN);
     matrix_scan();
+    LATENCY_TRACE_END(LATENCY_STAGE_SCAN);
     bool matrix_changed = false;
     for (uint8_t row = 0; row < MATRIX_ROWS && !matrix_changed; row++) {
         matrix_changed |= matrix_previous[row] ^ matrix_get_row(row);
@@ -472,12 +607,18 @@ static bool matrix_task(void) {
 
     matrix_scan_perf_task();
 
+#ifdef MATRIX_INTERRUPT_ENABLE
+    matrix_interrupt_idle_check(matrix_changed);
+#endif
+
     // Short-circuit the complete matrix processing if it is not necessary
     if (!matrix_changed) {
         generate_tick_event();
         return matrix_changed;
     }
 
+    LATENCY_TRACE_INPUT_CHANGED();
+
     if (debug_config.matrix) {
         matrix_print();
     }
@@ -498,7 +639,9 @@ static bool matrix_task(void) {
                 const bool key_pressed = current_row & col_mask;
 
                 if (process_keypress) {
+                    LATENCY_TRACE_BEGIN(LATENCY_STAGE_ACTION_EXEC);
                     action_exec(MAKE_KEYEVENT(row, col, key_pressed));
+                    LATENCY_TRACE_END(LATENCY_STAGE_ACTION_EXEC);
                 }
 
                 switch_events(row, col, key_pressed);
@@ -590,6 +733,82 @@ void quantum_task(void) {
 #endif
 }
 
+/** \brief Milliseconds until quantum_task next has timed work to do
+ *
+ * Features which cannot report a deadline are assumed to need servicing on
+ * every pass.
+ */
+uint32_t quantum_next_deadline(void) {
+#if defined(AUDIO_ENABLE) || defined(SEQUENCER_ENABLE) || defined(HAPTIC_ENABLE) || defined(DIP_SWITCH_ENABLE) || defined(SECURE_ENABLE)
+    return 0;
+#else
+    uint32_t deadline = DEADLINE_NONE;
+
+#    ifdef KEY_OVERRIDE_ENABLE
+    deadline = deadline_min(deadline, key_override_next_deadline());
+#    endif
+
+#    ifdef TAP_DANCE_ENABLE
+    deadline = deadline_min(deadline, tap_dance_next_deadline());
+#    endif
+
+#    ifdef COMBO_ENABLE
+    deadline = deadline_min(deadline, combo_next_deadline());
+#    endif
+
+#    ifdef LEADER_ENABLE
+    deadline = deadline_min(deadline, leader_next_deadline());
+#    endif
+
+#    ifdef WPM_ENABLE
+    deadline = deadline_min(deadline, wpm_next_deadline());
+#    endif
+
+#    ifdef AUTO_SHIFT_ENABLE
+    deadline = deadline_min(deadline, autoshift_next_deadline());
+#    endif
+
+#    ifdef CAPS_WORD_ENABLE
+    deadline = deadline_min(deadline, caps_word_next_deadline());
+#    endif
+
+    return deadline;
+#endif
+}
+
+/** \brief next_deadline_user
+ *
+ * Allows keymaps with their own timers to take part in tickless idle.
+ */
+__attribute__((weak)) uint32_t next_deadline_user(void) {
+    return DEADLINE_NONE;
+}
+
+/** \brief next_deadline_kb
+ *
+ * Allows keyboards with their own timers to take part in tickless idle.
+ */
+__attribute__((weak)) uint32_t next_deadline_kb(void) {
+    return next_deadline_user();
+}
+
+/** \brief Milliseconds until the main loop next has work to do
+ *
+ * Assumes no input changes in the meantime; anything polled from the main
+ * loop rather than driven by a timer keeps this at zero.
+ */
+uint32_t keyboard_next_deadline(void) {
+#if defined(SPLIT_KEYBOARD) || defined(RGBLIGHT_ENABLE) || defined(LED_MATRIX_ENABLE) || defined(RGB_MATRIX_ENABLE) || (defined(BACKLIGHT_ENABLE) && (defined(BACKLIGHT_PIN) || defined(BACKLIGHT_PINS))) || defined(ENCODER_ENABLE) || defined(OLED_ENABLE) || defined(ST7565_ENABLE) || defined(MOUSEKEY_ENABLE) || defined(PS2_MOUSE_ENABLE) || defined(POINTING_DEVICE_ENABLE) || defined(MIDI_ENABLE) || defined(VELOCIKEY_ENABLE) || defined(JOYSTICK_ENABLE) || defined(BLUETOOTH_ENABLE) || defined(QUANTUM_PAINTER_ENABLE)
+    return 0;
+#else
+    uint32_t deadline = deadline_min(action_next_deadline(), quantum_next_deadline());
+#    ifdef DEFERRED_EXEC_ENABLE
+    deadline = deadline_min(deadline, deferred_exec_next_deadline());
+#    endif
+    return deadline_min(deadline, next_deadline_kb());
+#endif
+}
+
 /** \brief Main task that is repeatedly called as fast as possible. */
 void keyboard_task(void) {
     const bool matrix_changed = matrix_task();
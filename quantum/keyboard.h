@@ -121,6 +121,7 @@ uint32_t last_encoder_activity_time(void);    // Timestamp of the last encoder a
 uint32_t last_encoder_activity_elapsed(void); // Number of milliseconds since the last encoder activity
 
 uint32_t get_matrix_scan_rate(void);
+uint32_t get_matrix_idle_time(void); // Number of milliseconds spent asleep waiting for a matrix interrupt in the last second
 
 #ifdef __cplusplus
 }
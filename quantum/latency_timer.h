@@ -0,0 +1,100 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+// Microsecond timestamps for measuring short stretches of code.
+//
+// Resolution:
+//  - ChibiOS with a realtime counter: one CPU cycle (DWT CYCCNT on Cortex-M3 and up),
+//    or 1us on RP2040
+//  - other ChibiOS ports: one system tick, see CH_CFG_ST_FREQUENCY
+//  - AVR: one timer0 tick, 4us at 16MHz
+//  - anything else: 1ms
+//
+// Timestamps wrap, so only measure intervals well below the wrap period
+// (about 25s at 168MHz on ChibiOS, 71 minutes elsewhere).
+
+#include <stdint.h>
+
+#if defined(PROTOCOL_CHIBIOS)
+#    include <ch.h>
+#    include "chibios_config.h"
+#elif defined(__AVR__)
+#    include <avr/io.h>
+#    include <util/atomic.h>
+#    include "timer.h"
+#    include "timer_avr.h"
+#else
+#    include "timer.h"
+#endif
+
+#if defined(PROTOCOL_CHIBIOS) && (PORT_SUPPORTS_RT == TRUE)
+typedef rtcnt_t latency_timer_t;
+
+static inline latency_timer_t latency_timer_read(void) {
+    return chSysGetRealtimeCounterX();
+}
+
+static inline uint32_t latency_timer_elapsed_us(latency_timer_t start) {
+    return (rtcnt_t)(chSysGetRealtimeCounterX() - start) / (REALTIME_COUNTER_CLOCK / 1000000);
+}
+
+#elif defined(PROTOCOL_CHIBIOS)
+typedef systime_t latency_timer_t;
+
+static inline latency_timer_t latency_timer_read(void) {
+    return chVTGetSystemTimeX();
+}
+
+static inline uint32_t latency_timer_elapsed_us(latency_timer_t start) {
+    return (uint32_t)TIME_I2US(chTimeDiffX(start, chVTGetSystemTimeX()));
+}
+
+#elif defined(__AVR__)
+#    if defined(__AVR_ATmega32A__)
+#        define LATENCY_TIMER_TIFR TIFR
+#        define LATENCY_TIMER_OCF OCF0
+#    elif defined(__AVR_ATtiny85__)
+#        define LATENCY_TIMER_TIFR TIFR
+#        define LATENCY_TIMER_OCF OCF0A
+#    else
+#        define LATENCY_TIMER_TIFR TIFR0
+#        define LATENCY_TIMER_OCF OCF0A
+#    endif
+
+typedef uint32_t latency_timer_t;
+
+// Combines the millisecond count with the position of timer0 within the current millisecond
+static inline latency_timer_t latency_timer_read(void) {
+    uint32_t ms;
+    uint8_t  raw;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms  = timer_count;
+        raw = TIMER_RAW;
+        if (LATENCY_TIMER_TIFR & _BV(LATENCY_TIMER_OCF)) {
+            // Wrapped since interrupts were disabled, the millisecond has not been counted yet
+            ms++;
+            raw = TIMER_RAW;
+        }
+    }
+
+    return ms * 1000 + (uint32_t)raw * 1000000UL / TIMER_RAW_FREQ;
+}
+
+static inline uint32_t latency_timer_elapsed_us(latency_timer_t start) {
+    return latency_timer_read() - start;
+}
+
+#else
+typedef uint32_t latency_timer_t;
+
+static inline latency_timer_t latency_timer_read(void) {
+    return timer_read32();
+}
+
+static inline uint32_t latency_timer_elapsed_us(latency_timer_t start) {
+    return timer_elapsed32(start) * 1000;
+}
+#endif
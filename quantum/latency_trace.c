@@ -0,0 +1,96 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string.h>
+#include "latency_trace.h"
+#include "latency_timer.h"
+#include "print.h"
+
+#ifdef CONSOLE_ENABLE
+static const char *const stage_names[LATENCY_STAGE_COUNT] = {
+    [LATENCY_STAGE_SCAN]           = "scan",
+    [LATENCY_STAGE_DEBOUNCE]       = "debounce",
+    [LATENCY_STAGE_ACTION_EXEC]    = "action",
+    [LATENCY_STAGE_PROCESS_RECORD] = "process",
+    [LATENCY_STAGE_REPORT]         = "report",
+    [LATENCY_STAGE_END_TO_END]     = "total",
+};
+#endif
+
+static latency_histogram_t histograms[LATENCY_STAGE_COUNT];
+static latency_timer_t     stage_start[LATENCY_STAGE_COUNT];
+static uint8_t             stage_active = 0;
+
+_Static_assert(LATENCY_STAGE_COUNT <= 8, "stage_active can only track 8 stages");
+
+static uint8_t latency_bucket(uint32_t us) {
+    uint8_t bucket = 0;
+    while (us && bucket < LATENCY_TRACE_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static void latency_record(latency_stage_t stage) {
+    if (!(stage_active & (1 << stage))) {
+        return;
+    }
+    stage_active &= ~(1 << stage);
+
+    const uint32_t       us        = latency_timer_elapsed_us(stage_start[stage]);
+    latency_histogram_t *histogram = &histograms[stage];
+    uint8_t              bucket    = latency_bucket(us);
+
+    histogram->count++;
+    histogram->total_us += us;
+    if (us > histogram->max_us) {
+        histogram->max_us = us;
+    }
+    if (histogram->buckets[bucket] < UINT16_MAX) {
+        histogram->buckets[bucket]++;
+    }
+}
+
+void latency_trace_begin(latency_stage_t stage) {
+    stage_start[stage] = latency_timer_read();
+    stage_active |= 1 << stage;
+}
+
+void latency_trace_end(latency_stage_t stage) {
+    latency_record(stage);
+}
+
+void latency_trace_input_changed(void) {
+    // The change happened at some point during the scan that detected it
+    stage_start[LATENCY_STAGE_END_TO_END] = stage_start[LATENCY_STAGE_SCAN];
+    stage_active |= 1 << LATENCY_STAGE_END_TO_END;
+}
+
+void latency_trace_report_sent(void) {
+    latency_record(LATENCY_STAGE_END_TO_END);
+}
+
+const latency_histogram_t *latency_trace_get(latency_stage_t stage) {
+    if (stage >= LATENCY_STAGE_COUNT) {
+        return NULL;
+    }
+    return &histograms[stage];
+}
+
+void latency_trace_dump(void) {
+#ifdef CONSOLE_ENABLE
+    xprintf("latency (us): count avg max | buckets <1 1 2 4 8 ...\n");
+    for (uint8_t stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+        xprintf("%s: %lu %lu %lu |", stage_names[stage], histograms[stage].count, histograms[stage].count ? histograms[stage].total_us / histograms[stage].count : 0, histograms[stage].max_us);
+        for (uint8_t bucket = 0; bucket < LATENCY_TRACE_BUCKETS; bucket++) {
+            xprintf(" %u", histograms[stage].buckets[bucket]);
+        }
+        xprintf("\n");
+    }
+#endif
+}
+
+void latency_trace_clear(void) {
+    memset(histograms, 0, sizeof(histograms));
+}
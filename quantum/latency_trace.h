@@ -0,0 +1,64 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+// Per stage latency histograms, from a matrix change to the report leaving the keyboard.
+
+#include <stdint.h>
+
+#ifndef LATENCY_TRACE_BUCKETS
+#    define LATENCY_TRACE_BUCKETS 16
+#endif
+
+typedef enum latency_stage_t {
+    LATENCY_STAGE_SCAN,           // matrix_scan(), including debounce
+    LATENCY_STAGE_DEBOUNCE,       // debounce()
+    LATENCY_STAGE_ACTION_EXEC,    // action_exec() for a single matrix event
+    LATENCY_STAGE_PROCESS_RECORD, // the process_record_quantum() chain
+    LATENCY_STAGE_REPORT,         // handing the keyboard report to the host driver
+    LATENCY_STAGE_END_TO_END,     // last matrix change until the next keyboard report
+    LATENCY_STAGE_COUNT,
+} latency_stage_t;
+
+/**
+ * Bucket 0 counts samples below 1us, bucket n counts samples in [2^(n-1), 2^n) us,
+ * and the last bucket counts everything above.
+ */
+typedef struct latency_histogram_t {
+    uint32_t count;
+    uint32_t total_us;
+    uint32_t max_us;
+    uint16_t buckets[LATENCY_TRACE_BUCKETS];
+} latency_histogram_t;
+
+#ifdef LATENCY_TRACE_ENABLE
+
+#    define LATENCY_TRACE_BEGIN(stage) latency_trace_begin(stage)
+#    define LATENCY_TRACE_END(stage) latency_trace_end(stage)
+#    define LATENCY_TRACE_INPUT_CHANGED() latency_trace_input_changed()
+#    define LATENCY_TRACE_REPORT_SENT() latency_trace_report_sent()
+
+#else
+
+#    define LATENCY_TRACE_BEGIN(stage)
+#    define LATENCY_TRACE_END(stage)
+#    define LATENCY_TRACE_INPUT_CHANGED()
+#    define LATENCY_TRACE_REPORT_SENT()
+
+#endif
+
+// Don't call the tracing functions directly, use the macros instead
+void latency_trace_begin(latency_stage_t stage);
+void latency_trace_end(latency_stage_t stage);
+void latency_trace_input_changed(void);
+void latency_trace_report_sent(void);
+
+/** \brief Access the accumulated histogram of a stage, e.g. to send it over raw HID */
+const latency_histogram_t *latency_trace_get(latency_stage_t stage);
+
+/** \brief Print all histograms to the console */
+void latency_trace_dump(void);
+
+/** \brief Reset all histograms */
+void latency_trace_clear(void);
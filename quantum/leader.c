@@ -4,6 +4,7 @@
 #include "leader.h"
 #include "timer.h"
 #include "util.h"
+#include "deadline.h"
 
 #include <string.h>
 
@@ -43,6 +44,19 @@ void leader_task(void) {
     }
 }
 
+uint32_t leader_next_deadline(void) {
+    if (!leader_sequence_active()) {
+        return DEADLINE_NONE;
+    }
+#if defined(LEADER_NO_TIMEOUT)
+    if (leader_sequence_size == 0) {
+        return DEADLINE_NONE;
+    }
+#endif
+    // The sequence times out once strictly more than the timeout has elapsed
+    return deadline_remaining(timer_elapsed(leader_time), LEADER_TIMEOUT + 1);
+}
+
 bool leader_sequence_active(void) {
     return leading;
 }
@@ -33,6 +33,11 @@ void leader_end(void);
 
 void leader_task(void);
 
+/**
+ * The number of milliseconds until the leader sequence times out, or `DEADLINE_NONE` if it cannot.
+ */
+uint32_t leader_next_deadline(void);
+
 /**
  * Whether the leader sequence is active.
  */
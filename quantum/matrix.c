@@ -21,6 +21,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "matrix.h"
 #include "debounce.h"
 #include "quantum.h"
+#include "latency_trace.h"
+#ifdef MATRIX_INTERRUPT_ENABLE
+#    include "matrix_interrupt.h"
+#endif
 #ifdef SPLIT_KEYBOARD
 #    include "split_common/split_util.h"
 #    include "split_common/transactions.h"
@@ -269,6 +273,86 @@ __attribute__((weak)) void matrix_read_rows_on_col(matrix_row_t current_matrix[]
 #    error DIODE_DIRECTION is not defined!
 #endif
 
+#ifdef MATRIX_INTERRUPT_ENABLE
+#    if defined(DIRECT_PINS)
+#        define MATRIX_INTERRUPT_PIN_COUNT (ROWS_PER_HAND * MATRIX_COLS)
+#        define MATRIX_INTERRUPT_PIN(i) (direct_pins[(i) / MATRIX_COLS][(i) % MATRIX_COLS])
+
+static void select_all_lines(void) {}
+static void unselect_all_lines(void) {}
+
+#    elif defined(MATRIX_ROW_PINS) && defined(MATRIX_COL_PINS)
+#        if (DIODE_DIRECTION == COL2ROW)
+#            define MATRIX_INTERRUPT_PIN_COUNT (MATRIX_COLS)
+#            define MATRIX_INTERRUPT_PIN(i) (col_pins[(i)])
+
+static void select_all_lines(void) {
+    for (uint8_t x = 0; x < ROWS_PER_HAND; x++) {
+        select_row(x);
+    }
+}
+
+static void unselect_all_lines(void) {
+    unselect_rows();
+}
+
+#        elif (DIODE_DIRECTION == ROW2COL)
+#            define MATRIX_INTERRUPT_PIN_COUNT (ROWS_PER_HAND)
+#            define MATRIX_INTERRUPT_PIN(i) (row_pins[(i)])
+
+static void select_all_lines(void) {
+    for (uint8_t x = 0; x < MATRIX_COLS; x++) {
+        select_col(x);
+    }
+}
+
+static void unselect_all_lines(void) {
+    unselect_cols();
+}
+
+#        endif
+#    endif
+
+#    ifdef MATRIX_INTERRUPT_PIN_COUNT
+/** \brief Park the matrix with every line selected and arm the input pins
+ *
+ * Any key press will then pull one of the inputs and raise an interrupt.
+ * Returns false, leaving the matrix unarmed, if a key is already held or an
+ * input pin cannot generate interrupts.
+ */
+bool matrix_interrupt_arm(void) {
+    select_all_lines();
+    matrix_output_select_delay();
+
+    for (uint8_t i = 0; i < MATRIX_INTERRUPT_PIN_COUNT; i++) {
+        pin_t pin = MATRIX_INTERRUPT_PIN(i);
+        if (pin == NO_PIN) {
+            continue;
+        }
+        if (!matrix_interrupt_enable_pin(pin) || readMatrixPin(pin) == 0) {
+            matrix_interrupt_disarm();
+            return false;
+        }
+    }
+    return true;
+}
+
+/** \brief Disarm the input pins and restore the matrix for normal scanning
+ */
+void matrix_interrupt_disarm(void) {
+    for (uint8_t i = 0; i < MATRIX_INTERRUPT_PIN_COUNT; i++) {
+        pin_t pin = MATRIX_INTERRUPT_PIN(i);
+        if (pin != NO_PIN) {
+            matrix_interrupt_disable_pin(pin);
+        }
+    }
+
+    unselect_all_lines();
+    matrix_output_unselect_delay(0, true); // wait for all inputs to go HIGH
+}
+#    endif
+#endif
+
 void matrix_init(void) {
 #ifdef SPLIT_KEYBOARD
     // Set pinout for right half if pinout for that half is defined
@@ -338,10 +422,14 @@ uint8_t matrix_scan(void) {
     bool changed = memcmp(raw_matrix, curr_matrix, sizeof(curr_matrix)) != 0;
     if (changed) memcpy(raw_matrix, curr_matrix, sizeof(curr_matrix));
 
+    LATENCY_TRACE_BEGIN(LATENCY_STAGE_DEBOUNCE);
 #ifdef SPLIT_KEYBOARD
-    changed = debounce(raw_matrix, matrix + thisHand, ROWS_PER_HAND, changed) | matrix_post_scan();
+    changed = debounce(raw_matrix, matrix + thisHand, ROWS_PER_HAND, changed);
+    LATENCY_TRACE_END(LATENCY_STAGE_DEBOUNCE);
+    changed |= matrix_post_scan();
 #else
     changed = debounce(raw_matrix, matrix, ROWS_PER_HAND, changed);
+    LATENCY_TRACE_END(LATENCY_STAGE_DEBOUNCE);
     matrix_scan_kb();
 #endif
     return (uint8_t)changed;
@@ -65,6 +65,10 @@ void matrix_output_unselect_delay(uint8_t line, bool key_pressed);
 /* only for backwards compatibility. delay between changing matrix pin state and reading values */
 void matrix_io_delay(void);
 
+/* interrupt driven scanning, arm returns false if the matrix could not be parked */
+bool matrix_interrupt_arm(void);
+void matrix_interrupt_disarm(void);
+
 /* power control */
 void matrix_power_up(void);
 void matrix_power_down(void);
@@ -48,6 +48,23 @@
 #    define QUANTUM_PAINTER_CONCURRENT_ANIMATIONS 4
 #endif // QUANTUM_PAINTER_CONCURRENT_ANIMATIONS
 
+#ifndef QUANTUM_PAINTER_DRAW_QUEUE_SIZE
+/**
+ * @def This controls the maximum number of images that can be waiting to be drawn by \ref qp_drawimage_queued and
+ *      \ref qp_drawimage_recolor_queued. Queued images are drawn from the main loop, a band of rows at a time. Defaults
+ *      to 0, which draws them immediately instead.
+ */
+#    define QUANTUM_PAINTER_DRAW_QUEUE_SIZE 0
+#endif // QUANTUM_PAINTER_DRAW_QUEUE_SIZE
+
+#ifndef QUANTUM_PAINTER_DRAW_QUEUE_ROWS
+/**
+ * @def This controls how many rows of a queued image are drawn on each pass through the main loop. Must be a multiple
+ *      of 8, so that every band starts on a whole byte of pixel data.
+ */
+#    define QUANTUM_PAINTER_DRAW_QUEUE_ROWS 8
+#endif // QUANTUM_PAINTER_DRAW_QUEUE_ROWS
+
 #ifndef QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE
 /**
  * @def This controls the maximum size of the pixel data buffer used for single blocks of transmission. Larger buffers
@@ -72,6 +89,45 @@
 #    define QUANTUM_PAINTER_SUPPORTS_NATIVE_COLORS FALSE
 #endif
 
+#ifndef QUANTUM_PAINTER_SUPPORTS_LZ
+/**
+ * @def This controls whether images and fonts using QMK LZ compression can be drawn. QMK LZ usually compresses better
+ *      than QMK RLE, but decoding requires an extra 256 bytes of RAM for the history window.
+ */
+#    define QUANTUM_PAINTER_SUPPORTS_LZ FALSE
+#endif
+
+#ifndef QUANTUM_PAINTER_DECODE_BLOCK_SIZE
+/**
+ * @def This controls how many bytes of image and font data are read from storage, and decoded, at a time. Larger blocks
+ *      mean fewer stream reads while drawing, at the cost of stack usage (twice this value). Maximum of 255.
+ */
+#    define QUANTUM_PAINTER_DECODE_BLOCK_SIZE 32
+#endif
+
+#ifndef QUANTUM_PAINTER_GLYPH_CACHE_SIZE
+/**
+ * @def This controls the amount of RAM, in bytes, set aside for caching decoded font glyphs. When enabled, text is drawn
+ *      from the cache, with runs of up to \ref QUANTUM_PAINTER_GLYPH_CACHE_BATCH glyphs sent to the display in a single
+ *      transfer. Defaults to 0, which disables the cache.
+ */
+#    define QUANTUM_PAINTER_GLYPH_CACHE_SIZE 0
+#endif
+
+#ifndef QUANTUM_PAINTER_GLYPH_CACHE_ENTRIES
+/**
+ * @def This controls the maximum number of glyphs held in the glyph cache, regardless of their size.
+ */
+#    define QUANTUM_PAINTER_GLYPH_CACHE_ENTRIES 48
+#endif
+
+#ifndef QUANTUM_PAINTER_GLYPH_CACHE_BATCH
+/**
+ * @def This controls the maximum number of cached glyphs drawn in a single transfer to the display.
+ */
+#    define QUANTUM_PAINTER_GLYPH_CACHE_BATCH 16
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Quantum Painter types
 
@@ -341,6 +397,41 @@ bool qp_drawimage(painter_device_t device, uint16_t x, uint16_t y, painter_image
  */
 bool qp_drawimage_recolor(painter_device_t device, uint16_t x, uint16_t y, painter_image_handle_t image, uint8_t hue_fg, uint8_t sat_fg, uint8_t val_fg, uint8_t hue_bg, uint8_t sat_bg, uint8_t val_bg);
 
+/**
+ * Queues an image to be drawn to the display. The image is drawn from the main loop, \ref QUANTUM_PAINTER_DRAW_QUEUE_ROWS
+ * rows at a time, so that large images don't hold up the keyboard. Queued images are drawn in order, and are finished
+ * before anything else is drawn to the same display.
+ *
+ * @note The image must not be modified until it has been drawn. Closing it with \ref qp_close_image finishes drawing it.
+ *
+ * @param device[in] the handle of the device to control
+ * @param x[in] the x-position where the image should be drawn onto the device
+ * @param y[in] the y-position where the image should be drawn onto the device
+ * @param image[in] the handle of the image to draw
+ * @return true if the image was queued
+ * @return false if the queue is full, or the image could not be drawn
+ */
+bool qp_drawimage_queued(painter_device_t device, uint16_t x, uint16_t y, painter_image_handle_t image);
+
+/**
+ * Queues an image to be drawn to the display, recoloring monochrome images to the desired foreground/background. See
+ * \ref qp_drawimage_queued.
+ *
+ * @param device[in] the handle of the device to control
+ * @param x[in] the x-position where the image should be drawn onto the device
+ * @param y[in] the y-position where the image should be drawn onto the device
+ * @param image[in] the handle of the image to draw
+ * @param hue_fg[in] the foreground hue to use, with 0-360 mapped to 0-255
+ * @param sat_fg[in] the foreground saturation to use, with 0-100% mapped to 0-255
+ * @param val_fg[in] the foreground value to use, with 0-100% mapped to 0-255
+ * @param hue_bg[in] the background hue to use, with 0-360 mapped to 0-255
+ * @param sat_bg[in] the background saturation to use, with 0-100% mapped to 0-255
+ * @param val_bg[in] the background value to use, with 0-100% mapped to 0-255
+ * @return true if the image was queued
+ * @return false if the queue is full, or the image could not be drawn
+ */
+bool qp_drawimage_recolor_queued(painter_device_t device, uint16_t x, uint16_t y, painter_image_handle_t image, uint8_t hue_fg, uint8_t sat_fg, uint8_t val_fg, uint8_t hue_bg, uint8_t sat_bg, uint8_t val_bg);
+
 /**
  * Draws an animation to the display.
  *
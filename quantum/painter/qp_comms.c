@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "qp_comms.h"
+#include "qp_draw.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Base comms APIs
@@ -23,6 +24,11 @@ bool qp_comms_start(painter_device_t device) {
         return false;
     }
 
+#if QUANTUM_PAINTER_DRAW_QUEUE_SIZE > 0
+    // Anything drawn to the device has to land on top of the images queued before it
+    qp_internal_draw_queue_drain(device, NULL);
+#endif // QUANTUM_PAINTER_DRAW_QUEUE_SIZE > 0
+
     return driver->comms_vtable->comms_start(device);
 }
 
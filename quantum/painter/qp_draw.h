@@ -27,8 +27,15 @@ bool qp_internal_setpixel_impl(painter_device_t device, uint16_t x, uint16_t y);
 // qp_rect internal implementation, but uses the global pixdata buffer with pre-converted native pixels.
 bool qp_internal_fillrect_helper_impl(painter_device_t device, uint16_t l, uint16_t t, uint16_t r, uint16_t b);
 
+#if QUANTUM_PAINTER_DRAW_QUEUE_SIZE > 0
+// Finishes queued image draws until none are left for the device or the image, either of which may be NULL
+void qp_internal_draw_queue_drain(painter_device_t device, painter_image_handle_t image);
+#endif // QUANTUM_PAINTER_DRAW_QUEUE_SIZE > 0
+
 // Convert from input pixel data + palette to equivalent pixels
-typedef int16_t (*qp_internal_byte_input_callback)(void* cb_arg);
+// Input callbacks hand over a block of bytes at a time, returning its length (0 once no more data is available). Any
+// bytes of the block which the caller doesn't use are discarded.
+typedef uint8_t (*qp_internal_byte_input_callback)(void* cb_arg, const uint8_t** block);
 typedef bool (*qp_internal_pixel_output_callback)(qp_pixel_t* palette, uint8_t index, void* cb_arg);
 typedef bool (*qp_internal_byte_output_callback)(uint8_t byte, void* cb_arg);
 bool qp_internal_decode_palette(painter_device_t device, uint32_t pixel_count, uint8_t bits_per_pixel, qp_internal_byte_input_callback input_callback, void* input_arg, qp_pixel_t* palette, qp_internal_pixel_output_callback output_callback, void* output_arg);
@@ -63,16 +70,31 @@ enum qp_internal_rle_mode_t {
     NON_REPEATING_RUN,
 };
 
+struct qp_internal_byte_input_state;
+typedef uint8_t (*qp_internal_block_decoder)(struct qp_internal_byte_input_state* state);
+
 struct qp_internal_byte_input_state {
-    painter_device_t device;
-    qp_stream_t*     src_stream;
-    int16_t          curr;
+    painter_device_t          device;
+    qp_stream_t*              src_stream;
+    int16_t                   curr;
+    qp_internal_block_decoder decode_block;
+    // Raw bytes read from the stream, and the bytes decoded from them
+    uint8_t in_pos;
+    uint8_t in_len;
+    uint8_t in_buf[QUANTUM_PAINTER_DECODE_BLOCK_SIZE];
+    uint8_t out_buf[QUANTUM_PAINTER_DECODE_BLOCK_SIZE];
     union {
         // RLE-specific
         struct {
             enum qp_internal_rle_mode_t mode;
             uint8_t                     remain; // number of bytes remaining in the current mode
         } rle;
+        // LZ-specific, shares the RLE modes: a repeating run copies bytes from the history window
+        struct {
+            enum qp_internal_rle_mode_t mode;
+            uint8_t                     remain;   // number of bytes remaining in the current mode
+            uint16_t                    distance; // how far back in the history window a repeating run starts
+        } lz;
     };
 };
 
@@ -93,3 +115,4 @@ struct qp_internal_byte_output_state {
 bool qp_internal_byte_appender(uint8_t byteval, void* cb_arg);
 
 qp_internal_byte_input_callback qp_internal_prepare_input_state(struct qp_internal_byte_input_state* input_state, painter_compression_t compression);
+void                            qp_internal_reset_input_state(struct qp_internal_byte_input_state* input_state);
@@ -138,13 +138,13 @@ bool qp_circle(painter_device_t device, uint16_t x, uint16_t y, uint16_t radius,
     int16_t ycalc = (int16_t)radius;
     int16_t err   = ((5 - (radius >> 2)) >> 2);
 
-    qp_internal_fill_pixdata(device, (radius * 2) + 1, hue, sat, val);
-
     if (!qp_comms_start(device)) {
         qp_dprintf("qp_circle: fail (could not start comms)\n");
         return false;
     }
 
+    qp_internal_fill_pixdata(device, (radius * 2) + 1, hue, sat, val);
+
     bool ret = true;
     if (!qp_circle_helper_impl(device, x, y, xcalc, ycalc, filled)) {
         ret = false;
@@ -29,14 +29,20 @@ bool qp_internal_bpp_capable(uint8_t bits_per_pixel) {
 }
 
 bool qp_internal_decode_palette(painter_device_t device, uint32_t pixel_count, uint8_t bits_per_pixel, qp_internal_byte_input_callback input_callback, void* input_arg, qp_pixel_t* palette, qp_internal_pixel_output_callback output_callback, void* output_arg) {
-    const uint8_t pixel_bitmask    = (1 << bits_per_pixel) - 1;
-    const uint8_t pixels_per_byte  = 8 / bits_per_pixel;
-    uint32_t      remaining_pixels = pixel_count; // don't try to derive from byte_count, we may not use an entire byte
+    const uint8_t  pixel_bitmask    = (1 << bits_per_pixel) - 1;
+    const uint8_t  pixels_per_byte  = 8 / bits_per_pixel;
+    uint32_t       remaining_pixels = pixel_count; // don't try to derive from byte_count, we may not use an entire byte
+    const uint8_t* block            = NULL;
+    uint8_t        block_remain     = 0;
     while (remaining_pixels > 0) {
-        int16_t byteval = input_callback(input_arg);
-        if (byteval < 0) {
-            return false;
+        if (block_remain == 0) {
+            block_remain = input_callback(input_arg, &block);
+            if (block_remain == 0) {
+                return false;
+            }
         }
+        uint8_t byteval = *block++;
+        block_remain--;
         uint8_t loop_pixels = remaining_pixels < pixels_per_byte ? remaining_pixels : pixels_per_byte;
         for (uint8_t q = 0; q < loop_pixels; ++q) {
             if (!output_callback(palette, byteval & pixel_bitmask, output_arg)) {
@@ -68,61 +74,180 @@ bool qp_internal_decode_recolor(painter_device_t device, uint32_t pixel_count, u
 bool qp_internal_send_bytes(painter_device_t device, uint32_t byte_count, qp_internal_byte_input_callback input_callback, void* input_arg, qp_internal_byte_output_callback output_callback, void* output_arg) {
     uint32_t remaining_bytes = byte_count;
     while (remaining_bytes > 0) {
-        int16_t byteval = input_callback(input_arg);
-        if (byteval < 0) {
+        const uint8_t* block;
+        uint8_t        block_len = input_callback(input_arg, &block);
+        if (block_len == 0) {
             return false;
         }
-        if (!output_callback(byteval, output_arg)) {
-            return false;
+        block_len = QP_MIN(block_len, remaining_bytes);
+        for (uint8_t i = 0; i < block_len; ++i) {
+            if (!output_callback(block[i], output_arg)) {
+                return false;
+            }
         }
-        remaining_bytes -= 1;
+        remaining_bytes -= block_len;
     }
     return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Progressive pull of bytes, push of pixels
+// Block decoders
+//
+// Stream data is read QUANTUM_PAINTER_DECODE_BLOCK_SIZE bytes at a time into the input buffer, and each codec decodes
+// whole runs from it into the output buffer, which is then handed to the pixel decoders in one go. The stream and the
+// codec are only invoked once per block, rather than per byte.
 
-static inline int16_t qp_drawimage_byte_uncompressed_decoder(void* cb_arg) {
-    struct qp_internal_byte_input_state* state = (struct qp_internal_byte_input_state*)cb_arg;
-    state->curr                                = qp_stream_get(state->src_stream);
-    return state->curr;
+_Static_assert((QUANTUM_PAINTER_DECODE_BLOCK_SIZE > 0) && (QUANTUM_PAINTER_DECODE_BLOCK_SIZE <= 255), "QUANTUM_PAINTER_DECODE_BLOCK_SIZE needs to be between 1 and 255");
+
+#if QUANTUM_PAINTER_SUPPORTS_LZ
+// History of the most recently decoded bytes, indexed by the low 8 bits of the output position
+static uint8_t qp_internal_lz_window[256];
+static uint8_t qp_internal_lz_window_pos;
+#endif
+
+// Makes sure there's at least one unconsumed byte in the input buffer, returns how many are available
+static inline uint8_t qp_decode_input_available(struct qp_internal_byte_input_state* state) {
+    if (state->in_pos >= state->in_len) {
+        state->in_pos = 0;
+        state->in_len = qp_stream_read(state->in_buf, 1, sizeof(state->in_buf), state->src_stream);
+    }
+    return state->in_len - state->in_pos;
 }
 
-static inline int16_t qp_drawimage_byte_rle_decoder(void* cb_arg) {
-    struct qp_internal_byte_input_state* state = (struct qp_internal_byte_input_state*)cb_arg;
+static inline int16_t qp_decode_input_byte(struct qp_internal_byte_input_state* state) {
+    if (qp_decode_input_available(state) == 0) {
+        return STREAM_EOF;
+    }
+    return state->in_buf[state->in_pos++];
+}
+
+static uint8_t qp_decode_block_uncompressed(struct qp_internal_byte_input_state* state) {
+    return qp_stream_read(state->out_buf, 1, sizeof(state->out_buf), state->src_stream);
+}
 
-    // Work out if we're parsing the initial marker byte
-    if (state->rle.mode == MARKER_BYTE) {
-        uint8_t c = qp_stream_get(state->src_stream);
-        if (c >= 128) {
-            state->rle.mode   = NON_REPEATING_RUN; // non-repeated run
-            state->rle.remain = c - 127;
+static uint8_t qp_decode_block_rle(struct qp_internal_byte_input_state* state) {
+    uint8_t* out    = state->out_buf;
+    uint8_t  len    = 0;
+    uint8_t  remain = state->rle.remain;
+    while (len < sizeof(state->out_buf)) {
+        // Work out if we're parsing the initial marker byte
+        if (remain == 0) {
+            int16_t marker = qp_decode_input_byte(state);
+            if (marker < 0) {
+                break;
+            }
+            if (marker >= 128) {
+                state->rle.mode = NON_REPEATING_RUN; // non-repeated run
+                remain          = marker - 127;
+            } else {
+                int16_t c = qp_decode_input_byte(state);
+                if (c < 0) {
+                    break;
+                }
+                state->rle.mode = REPEATING_RUN; // repeated run
+                state->curr     = c;
+                remain          = marker;
+            }
+        }
+
+        // Emit as much of the current run as fits -- runs are short, so plain loops beat memset/memcpy calls
+        uint8_t count = QP_MIN(remain, sizeof(state->out_buf) - len);
+        if (state->rle.mode == REPEATING_RUN) {
+            uint8_t c = state->curr;
+            for (uint8_t i = 0; i < count; ++i) {
+                out[len + i] = c;
+            }
         } else {
-            state->rle.mode   = REPEATING_RUN; // repeated run
-            state->rle.remain = c;
+            count = QP_MIN(count, qp_decode_input_available(state));
+            if (count == 0) {
+                break;
+            }
+            const uint8_t* in = &state->in_buf[state->in_pos];
+            for (uint8_t i = 0; i < count; ++i) {
+                out[len + i] = in[i];
+            }
+            state->in_pos += count;
         }
+        len += count;
+        remain -= count;
+    }
 
-        state->curr = qp_stream_get(state->src_stream);
+    // Swap back to querying the marker byte mode once the run is complete
+    state->rle.remain = remain;
+    if (remain == 0) {
+        state->rle.mode = MARKER_BYTE;
     }
+    return len;
+}
 
-    // Work out which byte we're returning
-    uint8_t c = state->curr;
+#if QUANTUM_PAINTER_SUPPORTS_LZ
+static uint8_t qp_decode_block_lz(struct qp_internal_byte_input_state* state) {
+    uint8_t  len = 0;
+    uint8_t  pos = qp_internal_lz_window_pos;
+    uint8_t* out = state->out_buf;
+    while (len < sizeof(state->out_buf)) {
+        // Work out if we're parsing the initial marker byte
+        if (state->lz.mode == MARKER_BYTE) {
+            int16_t marker = qp_decode_input_byte(state);
+            if (marker < 0) {
+                break;
+            }
+            if (marker >= 128) {
+                state->lz.mode   = NON_REPEATING_RUN; // literal bytes
+                state->lz.remain = marker - 127;
+            } else {
+                int16_t distance = qp_decode_input_byte(state);
+                if (distance < 0) {
+                    break;
+                }
+                state->lz.mode     = REPEATING_RUN; // copy of earlier output
+                state->lz.remain   = marker + 3;
+                state->lz.distance = distance + 1;
+            }
+        }
 
-    // Decrement the counter of the bytes remaining
-    state->rle.remain--;
+        // Emit as much of the current run as fits, recording it in the history window
+        uint8_t count = QP_MIN(state->lz.remain, sizeof(state->out_buf) - len);
+        if (state->lz.mode == REPEATING_RUN) {
+            // Runs may overlap their own output, so copy byte by byte
+            uint8_t src = pos - state->lz.distance;
+            for (uint8_t i = 0; i < count; ++i) {
+                uint8_t c                    = qp_internal_lz_window[src++];
+                qp_internal_lz_window[pos++] = c;
+                out[len + i]                 = c;
+            }
+        } else {
+            count = QP_MIN(count, qp_decode_input_available(state));
+            if (count == 0) {
+                break;
+            }
+            const uint8_t* in = &state->in_buf[state->in_pos];
+            for (uint8_t i = 0; i < count; ++i) {
+                qp_internal_lz_window[pos++] = in[i];
+                out[len + i]                 = in[i];
+            }
+            state->in_pos += count;
+        }
+        len += count;
 
-    if (state->rle.remain > 0) {
-        // If we're in a non-repeating run, queue up the next byte
-        if (state->rle.mode == NON_REPEATING_RUN) {
-            state->curr = qp_stream_get(state->src_stream);
+        // Swap back to querying the marker byte mode once the run is complete
+        state->lz.remain -= count;
+        if (state->lz.remain == 0) {
+            state->lz.mode = MARKER_BYTE;
         }
-    } else {
-        // Swap back to querying the marker byte mode
-        state->rle.mode = MARKER_BYTE;
     }
+    qp_internal_lz_window_pos = pos;
+    return len;
+}
+#endif // QUANTUM_PAINTER_SUPPORTS_LZ
 
-    return c;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Progressive pull of bytes, push of pixels
+
+static uint8_t qp_drawimage_byte_block_decoder(void* cb_arg, const uint8_t** block) {
+    struct qp_internal_byte_input_state* state = (struct qp_internal_byte_input_state*)cb_arg;
+    *block                                     = state->out_buf;
+    return state->decode_block(state);
 }
 
 bool qp_internal_pixel_appender(qp_pixel_t* palette, uint8_t index, void* cb_arg) {
@@ -164,15 +289,30 @@ bool qp_internal_byte_appender(uint8_t byteval, void* cb_arg) {
     return true;
 }
 
+void qp_internal_reset_input_state(struct qp_internal_byte_input_state* input_state) {
+    // Drop anything buffered, the stream may have been repositioned
+    input_state->in_pos     = 0;
+    input_state->in_len     = 0;
+    input_state->rle.mode   = MARKER_BYTE; // ignored if not using RLE or LZ
+    input_state->rle.remain = 0;
+}
+
 qp_internal_byte_input_callback qp_internal_prepare_input_state(struct qp_internal_byte_input_state* input_state, painter_compression_t compression) {
     switch (compression) {
         case IMAGE_UNCOMPRESSED:
-            return qp_drawimage_byte_uncompressed_decoder;
+            input_state->decode_block = qp_decode_block_uncompressed;
+            break;
         case IMAGE_COMPRESSED_RLE:
-            input_state->rle.mode   = MARKER_BYTE;
-            input_state->rle.remain = 0;
-            return qp_drawimage_byte_rle_decoder;
+            input_state->decode_block = qp_decode_block_rle;
+            break;
+#if QUANTUM_PAINTER_SUPPORTS_LZ
+        case IMAGE_COMPRESSED_LZ:
+            input_state->decode_block = qp_decode_block_lz;
+            break;
+#endif
         default:
             return NULL;
     }
+    qp_internal_reset_input_state(input_state);
+    return qp_drawimage_byte_block_decoder;
 }
@@ -75,13 +75,13 @@ bool qp_ellipse(painter_device_t device, uint16_t x, uint16_t y, uint16_t sizex,
     int16_t dx = 0;
     int16_t dy = ((int16_t)sizey);
 
-    qp_internal_fill_pixdata(device, QP_MAX(sizex, sizey), hue, sat, val);
-
     if (!qp_comms_start(device)) {
         qp_dprintf("qp_ellipse: fail (could not start comms)\n");
         return false;
     }
 
+    qp_internal_fill_pixdata(device, QP_MAX(sizex, sizey), hue, sat, val);
+
     bool ret = true;
     for (int16_t delta = (2 * bb) + (aa * (1 - (2 * sizey))); bb * dx <= aa * dy; dx++) {
         if (!qp_ellipse_helper_impl(device, x, y, dx, dy, filled)) {
@@ -95,6 +95,11 @@ bool qp_close_image(painter_image_handle_t image) {
         return false;
     }
 
+#if QUANTUM_PAINTER_DRAW_QUEUE_SIZE > 0
+    // Finish any queued draws of this image while it's still around
+    qp_internal_draw_queue_drain(NULL, image);
+#endif // QUANTUM_PAINTER_DRAW_QUEUE_SIZE > 0
+
     // Free up this image for use elsewhere.
     qgf_image->validate_ok = false;
     qp_stream_close(&qgf_image->stream);
@@ -207,6 +212,52 @@ static bool qp_drawimage_prepare_frame_for_stream_read(painter_device_t device,
     return true;
 }
 
+// Works out the area of the display covered by the frame
+static void qp_drawimage_frame_bounds(painter_image_handle_t image, uint16_t x, uint16_t y, const qgf_frame_info_t *frame_info, uint16_t *l, uint16_t *t, uint16_t *r, uint16_t *b) {
+    if (frame_info->is_delta) {
+        *l = x + frame_info->left;
+        *t = y + frame_info->top;
+        *r = x + frame_info->right - 1;
+        *b = y + frame_info->bottom - 1;
+    } else {
+        *l = x;
+        *t = y;
+        *r = x + image->width - 1;
+        *b = y + image->height - 1;
+    }
+}
+
+// Decodes the next pixel_count pixels of the frame and streams them to the display
+static bool qp_drawimage_send_pixdata(painter_device_t device, const qgf_frame_info_t *frame_info, uint32_t pixel_count, qp_internal_byte_input_callback input_callback, void *input_arg) {
+    struct painter_driver_t *driver = (struct painter_driver_t *)device;
+
+    bool ret = false;
+    if (frame_info->bpp <= 8) {
+        // Set up the output state
+        struct qp_internal_pixel_output_state output_state = {.device = device, .pixel_write_pos = 0, .max_pixels = qp_internal_num_pixels_in_buffer(device)};
+
+        // Decode the pixel data and stream to the display
+        ret = qp_internal_decode_palette(device, pixel_count, frame_info->bpp, input_callback, input_arg, qp_internal_global_pixel_lookup_table, qp_internal_pixel_appender, &output_state);
+        // Any leftovers need transmission as well.
+        if (ret && output_state.pixel_write_pos > 0) {
+            ret &= driver->driver_vtable->pixdata(device, qp_internal_global_pixdata_buffer, output_state.pixel_write_pos);
+        }
+    } else {
+        // Set up the output state
+        struct qp_internal_byte_output_state output_state = {.device = device, .byte_write_pos = 0, .max_bytes = qp_internal_num_pixels_in_buffer(device) * driver->native_bits_per_pixel / 8};
+
+        // Stream the raw pixel data to the display
+        uint32_t byte_count = pixel_count * frame_info->bpp / 8;
+        ret                 = qp_internal_send_bytes(device, byte_count, input_callback, input_arg, qp_internal_byte_appender, &output_state);
+        // Any leftovers need transmission as well.
+        if (ret && output_state.byte_write_pos > 0) {
+            ret &= driver->driver_vtable->pixdata(device, qp_internal_global_pixdata_buffer, output_state.byte_write_pos * 8 / driver->native_bits_per_pixel);
+        }
+    }
+
+    return ret;
+}
+
 static bool qp_drawimage_recolor_impl(painter_device_t device, uint16_t x, uint16_t y, painter_image_handle_t image, int frame_number, qgf_frame_info_t *frame_info, qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888) {
     qp_dprintf("qp_drawimage_recolor: entry\n");
     struct painter_driver_t *driver = (struct painter_driver_t *)device;
@@ -221,6 +272,11 @@ static bool qp_drawimage_recolor_impl(painter_device_t device, uint16_t x, uint1
         return false;
     }
 
+#if QUANTUM_PAINTER_DRAW_QUEUE_SIZE > 0
+    // Queued images go first, before the palette is set up for this one
+    qp_internal_draw_queue_drain(device, NULL);
+#endif // QUANTUM_PAINTER_DRAW_QUEUE_SIZE > 0
+
     // Read the frame info
     if (!qp_drawimage_prepare_frame_for_stream_read(device, qgf_image, frame_number, fg_hsv888, bg_hsv888, frame_info)) {
         qp_dprintf("qp_drawimage_recolor: fail (could not read frame %d)\n", frame_number);
@@ -233,17 +289,7 @@ static bool qp_drawimage_recolor_impl(painter_device_t device, uint16_t x, uint1
     }
 
     uint16_t l, t, r, b;
-    if (frame_info->is_delta) {
-        l = x + frame_info->left;
-        t = y + frame_info->top;
-        r = x + frame_info->right - 1;
-        b = y + frame_info->bottom - 1;
-    } else {
-        l = x;
-        t = y;
-        r = x + image->width - 1;
-        b = y + image->height - 1;
-    }
+    qp_drawimage_frame_bounds(image, x, y, frame_info, &l, &t, &r, &b);
     uint32_t pixel_count = ((uint32_t)(r - l + 1)) * (b - t + 1);
 
     // Configure where we're going to be rendering to
@@ -262,29 +308,7 @@ static bool qp_drawimage_recolor_impl(painter_device_t device, uint16_t x, uint1
         return false;
     }
 
-    bool ret = false;
-    if (frame_info->bpp <= 8) {
-        // Set up the output state
-        struct qp_internal_pixel_output_state output_state = {.device = device, .pixel_write_pos = 0, .max_pixels = qp_internal_num_pixels_in_buffer(device)};
-
-        // Decode the pixel data and stream to the display
-        ret = qp_internal_decode_palette(device, pixel_count, frame_info->bpp, input_callback, &input_state, qp_internal_global_pixel_lookup_table, qp_internal_pixel_appender, &output_state);
-        // Any leftovers need transmission as well.
-        if (ret && output_state.pixel_write_pos > 0) {
-            ret &= driver->driver_vtable->pixdata(device, qp_internal_global_pixdata_buffer, output_state.pixel_write_pos);
-        }
-    } else {
-        // Set up the output state
-        struct qp_internal_byte_output_state output_state = {.device = device, .byte_write_pos = 0, .max_bytes = qp_internal_num_pixels_in_buffer(device) * driver->native_bits_per_pixel / 8};
-
-        // Stream the raw pixel data to the display
-        uint32_t byte_count = pixel_count * frame_info->bpp / 8;
-        ret                 = qp_internal_send_bytes(device, byte_count, input_callback, &input_state, qp_internal_byte_appender, &output_state);
-        // Any leftovers need transmission as well.
-        if (ret && output_state.byte_write_pos > 0) {
-            ret &= driver->driver_vtable->pixdata(device, qp_internal_global_pixdata_buffer, output_state.byte_write_pos * 8 / driver->native_bits_per_pixel);
-        }
-    }
+    bool ret = qp_drawimage_send_pixdata(device, frame_info, pixel_count, input_callback, &input_state);
 
     qp_dprintf("qp_drawimage_recolor: %s\n", ret ? "ok" : "fail");
     qp_comms_stop(device);
@@ -298,6 +322,186 @@ bool qp_drawimage_recolor(painter_device_t device, uint16_t x, uint16_t y, paint
     return qp_drawimage_recolor_impl(device, x, y, image, 0, &frame_info, fg_hsv888, bg_hsv888);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantum Painter External API: qp_drawimage_queued
+
+bool qp_drawimage_queued(painter_device_t device, uint16_t x, uint16_t y, painter_image_handle_t image) {
+    return qp_drawimage_recolor_queued(device, x, y, image, 0, 0, 255, 0, 0, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Quantum Painter External API: qp_drawimage_recolor_queued
+
+#if QUANTUM_PAINTER_DRAW_QUEUE_SIZE > 0
+
+_Static_assert(QUANTUM_PAINTER_DRAW_QUEUE_SIZE <= 255, "QUANTUM_PAINTER_DRAW_QUEUE_SIZE needs to be 255 or less");
+_Static_assert((QUANTUM_PAINTER_DRAW_QUEUE_ROWS > 0) && (QUANTUM_PAINTER_DRAW_QUEUE_ROWS % 8 == 0), "QUANTUM_PAINTER_DRAW_QUEUE_ROWS needs to be a multiple of 8");
+
+typedef struct draw_queue_entry_t {
+    painter_device_t       device;
+    uint16_t               x;
+    uint16_t               y;
+    painter_image_handle_t image;
+    qp_pixel_t             fg_hsv888;
+    qp_pixel_t             bg_hsv888;
+} draw_queue_entry_t;
+
+static draw_queue_entry_t draw_queue[QUANTUM_PAINTER_DRAW_QUEUE_SIZE];
+static uint8_t            draw_queue_head    = 0;
+static uint8_t            draw_queue_count   = 0;
+static bool               draw_queue_running = false;
+
+// Decoder state of the image at the head of the queue, carried over from one band to the next
+static struct {
+    uint16_t                            rows_done;
+    int32_t                             stream_pos;
+    struct qp_internal_byte_input_state input_state;
+    qp_internal_byte_input_callback     input_callback;
+    const uint8_t *                     block;
+    uint8_t                             block_remain;
+    uint32_t                            band_remain;
+} draw_queue_progress;
+
+// Hands out decoded bytes up to the end of the current band, keeping the rest of the block for the next one
+static uint8_t qp_draw_queue_input(void *cb_arg, const uint8_t **block) {
+    if (draw_queue_progress.block_remain == 0 && draw_queue_progress.band_remain > 0) {
+        draw_queue_progress.block_remain = draw_queue_progress.input_callback(&draw_queue_progress.input_state, &draw_queue_progress.block);
+    }
+
+    uint8_t len = QP_MIN(draw_queue_progress.block_remain, draw_queue_progress.band_remain);
+    *block      = draw_queue_progress.block;
+    draw_queue_progress.block += len;
+    draw_queue_progress.block_remain -= len;
+    draw_queue_progress.band_remain -= len;
+    return len;
+}
+
+// Draws the next band of rows of the image at the head of the queue, returns true once it is done with
+static bool qp_draw_queue_step(void) {
+    draw_queue_entry_t *     entry     = &draw_queue[draw_queue_head];
+    struct painter_driver_t *driver    = (struct painter_driver_t *)entry->device;
+    qgf_image_handle_t *     qgf_image = (qgf_image_handle_t *)entry->image;
+    if (!driver->validate_ok || !qgf_image->validate_ok) {
+        qp_dprintf("qp_draw_queue_step: fail (invalid device or image)\n");
+        return true;
+    }
+
+    // Other draws may have used the palette and this image's stream since the last band, so both are set up again
+    qgf_frame_info_t frame_info = {0};
+    if (!qp_drawimage_prepare_frame_for_stream_read(entry->device, qgf_image, 0, entry->fg_hsv888, entry->bg_hsv888, &frame_info)) {
+        qp_dprintf("qp_draw_queue_step: fail (could not read frame)\n");
+        return true;
+    }
+    if (draw_queue_progress.rows_done == 0) {
+        draw_queue_progress.input_state    = (struct qp_internal_byte_input_state){.device = entry->device, .src_stream = &qgf_image->stream};
+        draw_queue_progress.input_callback = qp_internal_prepare_input_state(&draw_queue_progress.input_state, frame_info.compression_scheme);
+        draw_queue_progress.block_remain   = 0;
+        if (draw_queue_progress.input_callback == NULL) {
+            qp_dprintf("qp_draw_queue_step: fail (invalid image compression scheme)\n");
+            return true;
+        }
+    } else {
+        qp_stream_setpos(&qgf_image->stream, draw_queue_progress.stream_pos);
+    }
+
+    uint16_t l, t, r, b;
+    qp_drawimage_frame_bounds(entry->image, entry->x, entry->y, &frame_info, &l, &t, &r, &b);
+    uint16_t rows = (b - t + 1) - draw_queue_progress.rows_done;
+#    if QUANTUM_PAINTER_SUPPORTS_LZ
+    // The LZ history window is shared with every other draw, so it can't be picked up again later
+    if (frame_info.compression_scheme != IMAGE_COMPRESSED_LZ)
+#    endif // QUANTUM_PAINTER_SUPPORTS_LZ
+    {
+        rows = QP_MIN(rows, QUANTUM_PAINTER_DRAW_QUEUE_ROWS);
+    }
+    uint16_t top         = t + draw_queue_progress.rows_done;
+    uint32_t pixel_count = ((uint32_t)(r - l + 1)) * rows;
+
+    // Bands are a multiple of 8 rows, so only the last one can end partway through a byte
+    draw_queue_progress.band_remain = (pixel_count * frame_info.bpp + 7) / 8;
+
+    // Each band is a transaction of its own, leaving the bus free for other devices in between
+    bool ret = qp_comms_start(entry->device);
+    if (ret) {
+        ret = driver->driver_vtable->viewport(entry->device, l, top, r, top + rows - 1) && qp_drawimage_send_pixdata(entry->device, &frame_info, pixel_count, qp_draw_queue_input, NULL);
+        qp_comms_stop(entry->device);
+    }
+
+    draw_queue_progress.stream_pos = qp_stream_getpos(&qgf_image->stream);
+    draw_queue_progress.rows_done += rows;
+    qp_dprintf("qp_draw_queue_step: %s (%d rows done)\n", ret ? "ok" : "fail", (int)draw_queue_progress.rows_done);
+    return !ret || draw_queue_progress.rows_done > b - t;
+}
+
+static void qp_draw_queue_advance(void) {
+    draw_queue_running = true;
+    if (qp_draw_queue_step()) {
+        draw_queue_head = (draw_queue_head + 1) % QUANTUM_PAINTER_DRAW_QUEUE_SIZE;
+        --draw_queue_count;
+        draw_queue_progress.rows_done = 0;
+    }
+    draw_queue_running = false;
+}
+
+static bool qp_draw_queue_pending(painter_device_t device, painter_image_handle_t image) {
+    for (uint8_t i = 0; i < draw_queue_count; ++i) {
+        draw_queue_entry_t *entry = &draw_queue[(draw_queue_head + i) % QUANTUM_PAINTER_DRAW_QUEUE_SIZE];
+        if (entry->device == device || entry->image == image) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void qp_internal_draw_queue_drain(painter_device_t device, painter_image_handle_t image) {
+    // The queue's own bands come through here as well
+    if (draw_queue_running) {
+        return;
+    }
+
+    while (qp_draw_queue_pending(device, image)) {
+        qp_draw_queue_advance();
+    }
+}
+
+#endif // QUANTUM_PAINTER_DRAW_QUEUE_SIZE > 0
+
+bool qp_drawimage_recolor_queued(painter_device_t device, uint16_t x, uint16_t y, painter_image_handle_t image, uint8_t hue_fg, uint8_t sat_fg, uint8_t val_fg, uint8_t hue_bg, uint8_t sat_bg, uint8_t val_bg) {
+#if QUANTUM_PAINTER_DRAW_QUEUE_SIZE > 0
+    qp_dprintf("qp_drawimage_recolor_queued: entry\n");
+    struct painter_driver_t *driver = (struct painter_driver_t *)device;
+    if (!driver->validate_ok) {
+        qp_dprintf("qp_drawimage_recolor_queued: fail (validation_ok == false)\n");
+        return false;
+    }
+
+    qgf_image_handle_t *qgf_image = (qgf_image_handle_t *)image;
+    if (!qgf_image->validate_ok) {
+        qp_dprintf("qp_drawimage_recolor_queued: fail (invalid image)\n");
+        return false;
+    }
+
+    if (draw_queue_count == QUANTUM_PAINTER_DRAW_QUEUE_SIZE) {
+        qp_dprintf("qp_drawimage_recolor_queued: fail (queue full)\n");
+        return false;
+    }
+
+    draw_queue[(draw_queue_head + draw_queue_count) % QUANTUM_PAINTER_DRAW_QUEUE_SIZE] = (draw_queue_entry_t){
+        .device    = device,
+        .x         = x,
+        .y         = y,
+        .image     = image,
+        .fg_hsv888 = {.hsv888 = {.h = hue_fg, .s = sat_fg, .v = val_fg}},
+        .bg_hsv888 = {.hsv888 = {.h = hue_bg, .s = sat_bg, .v = val_bg}},
+    };
+    ++draw_queue_count;
+    qp_dprintf("qp_drawimage_recolor_queued: ok (%d queued)\n", (int)draw_queue_count);
+    return true;
+#else
+    return qp_drawimage_recolor(device, x, y, image, hue_fg, sat_fg, val_fg, hue_bg, sat_bg, val_bg);
+#endif // QUANTUM_PAINTER_DRAW_QUEUE_SIZE > 0
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Quantum Painter External API: qp_animate
 
@@ -420,6 +624,12 @@ void qp_internal_animation_tick(void) {
 
 void qp_internal_task(void) {
     qp_internal_animation_tick();
+#if QUANTUM_PAINTER_DRAW_QUEUE_SIZE > 0
+    // Draw the next band of the oldest queued image
+    if (draw_queue_count > 0) {
+        qp_draw_queue_advance();
+    }
+#endif // QUANTUM_PAINTER_DRAW_QUEUE_SIZE > 0
 #ifdef QUANTUM_PAINTER_LVGL_INTEGRATION_ENABLE
     // Run LVGL ticks
     void qp_lvgl_internal_tick(void);
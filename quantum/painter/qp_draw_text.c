@@ -8,6 +8,7 @@
 #include "qp_draw.h"
 #include "qp_comms.h"
 #include "qff.h"
+#include "qp_glyph_cache.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // QFF font handles
@@ -150,6 +151,11 @@ bool qp_close_font(painter_font_handle_t font) {
     }
 #endif // QUANTUM_PAINTER_LOAD_FONTS_TO_RAM
 
+#if QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
+    // Drop any of this font's glyphs, as the slot may be reused by another font
+    qp_glyph_cache_remove_font(qff_font);
+#endif // QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
+
     // Free up this font for use elsewhere.
     qp_stream_close(&qff_font->stream);
     qff_font->validate_ok = false;
@@ -351,8 +357,8 @@ static inline bool qp_font_code_point_handler_drawglyph(qff_font_handle_t *qff_f
     struct code_point_iter_drawglyph_state *state  = (struct code_point_iter_drawglyph_state *)cb_arg;
     struct painter_driver_t *               driver = (struct painter_driver_t *)state->device;
 
-    // Reset the input state's RLE mode -- the stream should already be correctly positioned by qp_iterate_code_points()
-    state->input_state->rle.mode = MARKER_BYTE; // ignored if not using RLE
+    // Reset the input state's buffers and decoder -- the stream should already be correctly positioned by qp_iterate_code_points()
+    qp_internal_reset_input_state(state->input_state);
 
     // Reset the output state
     state->output_state->pixel_write_pos = 0;
@@ -375,6 +381,167 @@ static inline bool qp_font_code_point_handler_drawglyph(qff_font_handle_t *qff_f
     return ret;
 }
 
+#if QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cached string drawing implementation
+
+// Looks up a glyph in the cache, decoding it into the cache if it's not already present. Returns false on error, or
+// sets *entry to NULL if the glyph can't be cached right now.
+static bool qp_drawtext_cache_glyph(struct code_point_iter_drawglyph_state *state, qff_font_handle_t *qff_font, uint32_t code_point, qp_glyph_cache_entry_t **entry) {
+    *entry = qp_glyph_cache_find(qff_font, code_point);
+    if (!*entry) {
+        uint8_t width;
+        if (!qp_drawtext_prepare_glyph_for_render(qff_font, code_point, &width)) {
+            qp_dprintf("Failed to prepare glyph for caching.\n");
+            return false;
+        }
+
+        uint16_t size = ((uint32_t)width * qff_font->base.line_height * qff_font->bpp + 7) / 8;
+        *entry        = qp_glyph_cache_insert(qff_font, code_point, width, size);
+        if (!*entry) {
+            return true;
+        }
+
+        // Decode the glyph's pixel data into the cache -- the stream is already positioned at the glyph data
+        qp_internal_reset_input_state(state->input_state);
+        uint8_t *data = qp_glyph_cache_data(*entry);
+        while (size > 0) {
+            const uint8_t *block;
+            uint8_t        block_len = state->input_callback(state->input_state, &block);
+            if (block_len == 0) {
+                qp_dprintf("Failed to decode glyph for caching.\n");
+                qp_glyph_cache_remove(*entry);
+                return false;
+            }
+            block_len = QP_MIN(block_len, size);
+            memcpy(data, block, block_len);
+            data += block_len;
+            size -= block_len;
+        }
+    }
+
+    (*entry)->pinned = true;
+    return true;
+}
+
+// Sends the palette indices gathered so far to the pixel data buffer, and the buffer to the display once it's full
+static bool qp_drawtext_flush_indices(struct qp_internal_pixel_output_state *output_state, uint8_t *indices, uint8_t count) {
+    struct painter_driver_t *driver = (struct painter_driver_t *)output_state->device;
+    if (!driver->driver_vtable->append_pixels(output_state->device, qp_internal_global_pixdata_buffer, qp_internal_global_pixel_lookup_table, output_state->pixel_write_pos, count, indices)) {
+        return false;
+    }
+    output_state->pixel_write_pos += count;
+
+    if (output_state->pixel_write_pos == output_state->max_pixels) {
+        if (!driver->driver_vtable->pixdata(output_state->device, qp_internal_global_pixdata_buffer, output_state->pixel_write_pos)) {
+            return false;
+        }
+        output_state->pixel_write_pos = 0;
+    }
+    return true;
+}
+
+// Draws a run of cached glyphs as a single image, row by row across all of the glyphs
+static bool qp_drawtext_render_cached(struct code_point_iter_drawglyph_state *state, qff_font_handle_t *qff_font, qp_glyph_cache_entry_t **entries, uint8_t count, uint16_t width) {
+    struct painter_driver_t *driver = (struct painter_driver_t *)state->device;
+    const uint8_t            height = qff_font->base.line_height;
+    const uint8_t            bpp    = qff_font->bpp;
+    const uint8_t            mask   = (1 << bpp) - 1;
+
+    if (!driver->driver_vtable->viewport(state->device, state->xpos, state->ypos, state->xpos + width - 1, state->ypos + height - 1)) {
+        return false;
+    }
+    state->xpos += width;
+
+    // Resolve the pixel data locations up front, nothing is inserted into the cache while rendering
+    const uint8_t *data[QUANTUM_PAINTER_GLYPH_CACHE_BATCH];
+    for (uint8_t i = 0; i < count; ++i) {
+        data[i] = qp_glyph_cache_data(entries[i]);
+    }
+
+    struct qp_internal_pixel_output_state *output_state = state->output_state;
+    uint8_t                                indices[32];
+    uint8_t                                num_indices = 0;
+    output_state->pixel_write_pos                      = 0;
+    for (uint8_t y = 0; y < height; ++y) {
+        for (uint8_t i = 0; i < count; ++i) {
+            uint8_t  glyph_width = entries[i]->width;
+            uint32_t bit         = (uint32_t)y * glyph_width * bpp;
+            for (uint8_t x = 0; x < glyph_width; ++x, bit += bpp) {
+                indices[num_indices++] = (data[i][bit / 8] >> (bit % 8)) & mask;
+                if (num_indices == sizeof(indices) || output_state->pixel_write_pos + num_indices == output_state->max_pixels) {
+                    if (!qp_drawtext_flush_indices(output_state, indices, num_indices)) {
+                        return false;
+                    }
+                    num_indices = 0;
+                }
+            }
+        }
+    }
+
+    // Any leftovers need transmission as well.
+    if (num_indices > 0 && !qp_drawtext_flush_indices(output_state, indices, num_indices)) {
+        return false;
+    }
+    if (output_state->pixel_write_pos > 0) {
+        return driver->driver_vtable->pixdata(state->device, qp_internal_global_pixdata_buffer, output_state->pixel_write_pos);
+    }
+    return true;
+}
+
+// Draws a string, caching each glyph and sending runs of them to the display at once. Glyphs which can't be cached are
+// streamed as usual.
+static bool qp_drawtext_cached(struct code_point_iter_drawglyph_state *state, qff_font_handle_t *qff_font, const char *str) {
+    qp_glyph_cache_entry_t *entries[QUANTUM_PAINTER_GLYPH_CACHE_BATCH];
+    bool                    ret = true;
+    while (ret && *str) {
+        // Gather as many glyphs as possible into the batch
+        uint8_t  count = 0;
+        uint16_t width = 0;
+        while (*str && count < QUANTUM_PAINTER_GLYPH_CACHE_BATCH) {
+            int32_t     code_point = 0;
+            const char *next       = decode_utf8(str, &code_point);
+            if (code_point < 0) {
+                qp_dprintf("Invalid unicode code point decoded. Cannot render.\n");
+                ret = false;
+                break;
+            }
+
+            qp_glyph_cache_entry_t *entry;
+            if (!qp_drawtext_cache_glyph(state, qff_font, code_point, &entry)) {
+                ret = false;
+                break;
+            }
+            if (!entry) {
+                // Draw what's been batched so far, the glyph is handled on its own below
+                break;
+            }
+
+            entries[count++] = entry;
+            width += entry->width;
+            str = next;
+        }
+
+        if (ret && count > 0) {
+            ret = qp_drawtext_render_cached(state, qff_font, entries, count, width);
+        }
+        qp_glyph_cache_unpin_all();
+
+        // Stream any glyph which couldn't be cached, even with everything else evicted
+        if (ret && *str && count < QUANTUM_PAINTER_GLYPH_CACHE_BATCH) {
+            int32_t code_point = 0;
+            str                = decode_utf8(str, &code_point);
+
+            uint8_t width;
+            ret = qp_drawtext_prepare_glyph_for_render(qff_font, code_point, &width) && qp_font_code_point_handler_drawglyph(qff_font, code_point, width, qff_font->base.line_height, state);
+        }
+    }
+    return ret;
+}
+
+#endif // QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Quantum Painter External API: qp_textwidth
 
@@ -454,8 +621,13 @@ int16_t qp_drawtext_recolor(painter_device_t device, uint16_t x, uint16_t y, pai
         return false;
     }
 
+#if QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
+    // Draw from the glyph cache, falling back to streaming glyphs which won't fit
+    bool ret = qp_drawtext_cached(&state, qff_font, str);
+#else
     // Iterate the codepoints with the drawglyph callback
     bool ret = qp_iterate_code_points(qff_font, str, qp_font_code_point_handler_drawglyph, &state);
+#endif // QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
 
     qp_dprintf("qp_drawtext_recolor: %s\n", ret ? "ok" : "fail");
     qp_comms_stop(device);
@@ -0,0 +1,120 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string.h>
+
+#include "qp_glyph_cache.h"
+
+#if QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
+
+_Static_assert(QUANTUM_PAINTER_GLYPH_CACHE_SIZE <= UINT16_MAX, "QUANTUM_PAINTER_GLYPH_CACHE_SIZE needs to be less than 64kB");
+
+static uint8_t                qp_glyph_cache_arena[QUANTUM_PAINTER_GLYPH_CACHE_SIZE];
+static qp_glyph_cache_entry_t qp_glyph_cache_entries[QUANTUM_PAINTER_GLYPH_CACHE_ENTRIES];
+static uint16_t               qp_glyph_cache_end;   // end of the most recent allocation in the arena
+static uint16_t               qp_glyph_cache_clock; // incremented on each lookup, wraparound is accounted for
+
+qp_glyph_cache_entry_t *qp_glyph_cache_find(const void *font, uint32_t code_point) {
+    for (uint8_t i = 0; i < QUANTUM_PAINTER_GLYPH_CACHE_ENTRIES; ++i) {
+        qp_glyph_cache_entry_t *entry = &qp_glyph_cache_entries[i];
+        if (entry->font == font && entry->code_point == code_point) {
+            entry->last_used = ++qp_glyph_cache_clock;
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// Moves all pixel data down to the start of the arena, so that the free space is contiguous at the end
+static void qp_glyph_cache_compact(void) {
+    uint16_t cursor = 0;
+    while (true) {
+        // Find the lowest allocation which hasn't yet been moved
+        qp_glyph_cache_entry_t *next = NULL;
+        for (uint8_t i = 0; i < QUANTUM_PAINTER_GLYPH_CACHE_ENTRIES; ++i) {
+            qp_glyph_cache_entry_t *entry = &qp_glyph_cache_entries[i];
+            if (entry->font && entry->offset >= cursor && (!next || entry->offset < next->offset)) {
+                next = entry;
+            }
+        }
+        if (!next) {
+            break;
+        }
+
+        memmove(&qp_glyph_cache_arena[cursor], &qp_glyph_cache_arena[next->offset], next->size);
+        next->offset = cursor;
+        cursor += next->size;
+    }
+    qp_glyph_cache_end = cursor;
+}
+
+qp_glyph_cache_entry_t *qp_glyph_cache_insert(const void *font, uint32_t code_point, uint8_t width, uint16_t size) {
+    if (size == 0 || size > QUANTUM_PAINTER_GLYPH_CACHE_SIZE) {
+        return NULL;
+    }
+
+    while (true) {
+        // Work out how much space is in use, and which entries are candidates for reuse or eviction
+        qp_glyph_cache_entry_t *slot   = NULL;
+        qp_glyph_cache_entry_t *oldest = NULL;
+        uint16_t                used   = 0;
+        for (uint8_t i = 0; i < QUANTUM_PAINTER_GLYPH_CACHE_ENTRIES; ++i) {
+            qp_glyph_cache_entry_t *entry = &qp_glyph_cache_entries[i];
+            if (!entry->font) {
+                slot = entry;
+                continue;
+            }
+            used += entry->size;
+            if (!entry->pinned && (!oldest || (uint16_t)(qp_glyph_cache_clock - entry->last_used) > (uint16_t)(qp_glyph_cache_clock - oldest->last_used))) {
+                oldest = entry;
+            }
+        }
+
+        if (slot && QUANTUM_PAINTER_GLYPH_CACHE_SIZE - used >= size) {
+            // There's enough space, but it may be fragmented
+            if (QUANTUM_PAINTER_GLYPH_CACHE_SIZE - qp_glyph_cache_end < size) {
+                qp_glyph_cache_compact();
+            }
+
+            slot->font       = font;
+            slot->code_point = code_point;
+            slot->offset     = qp_glyph_cache_end;
+            slot->size       = size;
+            slot->last_used  = ++qp_glyph_cache_clock;
+            slot->width      = width;
+            slot->pinned     = false;
+            qp_glyph_cache_end += size;
+            return slot;
+        }
+
+        // Everything left is in use by the current batch
+        if (!oldest) {
+            return NULL;
+        }
+        oldest->font = NULL;
+    }
+}
+
+uint8_t *qp_glyph_cache_data(qp_glyph_cache_entry_t *entry) {
+    return &qp_glyph_cache_arena[entry->offset];
+}
+
+void qp_glyph_cache_remove(qp_glyph_cache_entry_t *entry) {
+    entry->font = NULL;
+}
+
+void qp_glyph_cache_remove_font(const void *font) {
+    for (uint8_t i = 0; i < QUANTUM_PAINTER_GLYPH_CACHE_ENTRIES; ++i) {
+        if (qp_glyph_cache_entries[i].font == font) {
+            qp_glyph_cache_entries[i].font = NULL;
+        }
+    }
+}
+
+void qp_glyph_cache_unpin_all(void) {
+    for (uint8_t i = 0; i < QUANTUM_PAINTER_GLYPH_CACHE_ENTRIES; ++i) {
+        qp_glyph_cache_entries[i].pinned = false;
+    }
+}
+
+#endif // QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
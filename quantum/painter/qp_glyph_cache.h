@@ -0,0 +1,49 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "qp_internal.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Glyph cache
+//
+// Holds decoded glyph pixel data -- the palette indices of each pixel, packed at the font's bits-per-pixel exactly as
+// they appear in an uncompressed QFF -- so that redrawing text skips the glyph table lookups, stream seeks and
+// decompression. Entries live in a fixed QUANTUM_PAINTER_GLYPH_CACHE_SIZE byte arena, and the least recently used
+// entries are evicted to make room for new ones. Entries can be pinned while a batch of glyphs is being rendered, so
+// that caching later glyphs in the batch doesn't evict earlier ones.
+
+#if QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
+
+typedef struct qp_glyph_cache_entry_t {
+    const void *font;       // owning font, NULL if the entry is unused
+    uint32_t    code_point; // glyph code point
+    uint16_t    offset;     // location of the glyph's pixel data in the arena
+    uint16_t    size;       // size of the glyph's pixel data in bytes
+    uint16_t    last_used;  // cache clock value at the last lookup
+    uint8_t     width;      // glyph width in pixels
+    bool        pinned;     // not to be evicted
+} qp_glyph_cache_entry_t;
+
+// Finds a cached glyph, marking it as recently used. Returns NULL if not present.
+qp_glyph_cache_entry_t *qp_glyph_cache_find(const void *font, uint32_t code_point);
+
+// Makes room for a new glyph's pixel data, evicting unpinned entries as required. Returns NULL if it won't fit, or if
+// there's no pixel data to store.
+qp_glyph_cache_entry_t *qp_glyph_cache_insert(const void *font, uint32_t code_point, uint8_t width, uint16_t size);
+
+// Pixel data of a cached glyph. Only valid until the next insert, which may move it.
+uint8_t *qp_glyph_cache_data(qp_glyph_cache_entry_t *entry);
+
+// Removes a single entry, or every entry belonging to a font.
+void qp_glyph_cache_remove(qp_glyph_cache_entry_t *entry);
+void qp_glyph_cache_remove_font(const void *font);
+
+// Allows all entries to be evicted again.
+void qp_glyph_cache_unpin_all(void);
+
+#endif // QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
@@ -2,11 +2,17 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "qp_stream.h"
+#include <string.h>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Stream API
 
 uint32_t qp_stream_read_impl(void *output_buf, uint32_t member_size, uint32_t num_members, qp_stream_t *stream) {
+    // Streams that can copy out a whole block at once skip the per-byte callbacks
+    if (stream->read) {
+        return stream->read(stream, output_buf, num_members * member_size) / member_size;
+    }
+
     uint8_t *output_ptr = (uint8_t *)output_buf;
 
     uint32_t i;
@@ -47,6 +53,22 @@ static inline int16_t mem_get(qp_stream_t *stream) {
     return s->buffer[s->position++];
 }
 
+static inline uint32_t mem_read(qp_stream_t *stream, void *output_buf, uint32_t length) {
+    qp_memory_stream_t *s         = (qp_memory_stream_t *)stream;
+    int32_t             available = s->length - s->position;
+    if (available <= 0) {
+        s->is_eof = true;
+        return 0;
+    }
+    if (length > (uint32_t)available) {
+        length    = available;
+        s->is_eof = true;
+    }
+    memcpy(output_buf, &s->buffer[s->position], length);
+    s->position += length;
+    return length;
+}
+
 static inline bool mem_put(qp_stream_t *stream, uint8_t c) {
     qp_memory_stream_t *s = (qp_memory_stream_t *)stream;
     if (s->position >= s->length) {
@@ -111,7 +133,7 @@ static inline void mem_close(qp_stream_t *stream) {
 
 qp_memory_stream_t qp_make_memory_stream(void *buffer, int32_t length) {
     qp_memory_stream_t stream = {
-        .base     = {.get = mem_get, .put = mem_put, .seek = mem_seek, .tell = mem_tell, .is_eof = mem_is_eof, .close = mem_close},
+        .base     = {.get = mem_get, .read = mem_read, .put = mem_put, .seek = mem_seek, .tell = mem_tell, .is_eof = mem_is_eof, .close = mem_close},
         .buffer   = (uint8_t *)buffer,
         .length   = length,
         .position = 0,
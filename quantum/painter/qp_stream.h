@@ -50,6 +50,7 @@ uint32_t qp_stream_write_impl(const void *input_buf, uint32_t member_size, uint3
 
 struct qp_stream_t {
     int16_t (*get)(qp_stream_t *stream);
+    uint32_t (*read)(qp_stream_t *stream, void *output_buf, uint32_t length); // optional, bulk alternative to get()
     bool (*put)(qp_stream_t *stream, uint8_t c);
     int (*seek)(qp_stream_t *stream, int32_t offset, int origin);
     int32_t (*tell)(qp_stream_t *stream);
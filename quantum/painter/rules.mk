@@ -32,7 +32,8 @@ SRC += \
     $(QUANTUM_DIR)/painter/qp_draw_circle.c \
     $(QUANTUM_DIR)/painter/qp_draw_ellipse.c \
     $(QUANTUM_DIR)/painter/qp_draw_image.c \
-    $(QUANTUM_DIR)/painter/qp_draw_text.c
+    $(QUANTUM_DIR)/painter/qp_draw_text.c \
+    $(QUANTUM_DIR)/painter/qp_glyph_cache.c
 
 # Check if people want animations... enable the defered exec if so.
 ifeq ($(strip $(QUANTUM_PAINTER_ANIMATIONS_ENABLE)), yes)
@@ -0,0 +1,362 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#    define BENCHMARK_CYCLES() __rdtsc()
+#endif
+
+// The painter headers use C11's spelling
+#define _Static_assert static_assert
+
+extern "C" {
+#include "qp_internal.h"
+#include "qp_draw.h"
+
+// Only needed by the pixel-level decoders, which aren't exercised here
+qp_pixel_t qp_internal_global_pixel_lookup_table[256];
+uint8_t    qp_internal_global_pixdata_buffer[QUANTUM_PAINTER_PIXDATA_BUFFER_SIZE];
+bool       qp_internal_interpolate_palette(qp_pixel_t fg_hsv888, qp_pixel_t bg_hsv888, int16_t steps) {
+    return false;
+}
+}
+
+namespace {
+
+#define BENCHMARK_IMAGE_WIDTH 240
+#define BENCHMARK_IMAGE_HEIGHT 240
+#define BENCHMARK_ITERATIONS 50
+
+/* The per-byte RLE decoder the block decoders replaced, kept as the reference. */
+struct reference_rle_state {
+    qp_stream_t *stream;
+    int16_t      curr;
+    bool         marker;
+    bool         repeating;
+    uint8_t      remain;
+};
+
+int16_t reference_rle_decoder(void *cb_arg) {
+    reference_rle_state *state = (reference_rle_state *)cb_arg;
+    if (state->marker) {
+        uint8_t c = qp_stream_get(state->stream);
+        if (c >= 128) {
+            state->repeating = false;
+            state->remain    = c - 127;
+        } else {
+            state->repeating = true;
+            state->remain    = c;
+        }
+        state->marker = false;
+        state->curr   = qp_stream_get(state->stream);
+    }
+    uint8_t c = state->curr;
+    state->remain--;
+    if (state->remain > 0) {
+        if (!state->repeating) {
+            state->curr = qp_stream_get(state->stream);
+        }
+    } else {
+        state->marker = true;
+    }
+    return c;
+}
+
+std::vector<uint8_t> encode_rle(const std::vector<uint8_t> &data) {
+    std::vector<uint8_t> out;
+    size_t               n = 0;
+    while (n < data.size()) {
+        size_t run = 1;
+        while (n + run < data.size() && run < 127 && data[n + run] == data[n]) {
+            run++;
+        }
+        if (run >= 2) {
+            out.push_back(run);
+            out.push_back(data[n]);
+            n += run;
+            continue;
+        }
+        size_t start = n;
+        while (n < data.size() && n - start < 128 && !(n + 1 < data.size() && data[n + 1] == data[n])) {
+            n++;
+        }
+        if (n == start) {
+            n++;
+        }
+        out.push_back(127 + (n - start));
+        out.insert(out.end(), data.begin() + start, data.begin() + n);
+    }
+    return out;
+}
+
+std::vector<uint8_t> encode_lz(const std::vector<uint8_t> &data) {
+    std::vector<uint8_t> out;
+    std::vector<uint8_t> literals;
+    auto                 flush = [&]() {
+        for (size_t i = 0; i < literals.size(); i += 128) {
+            size_t count = std::min<size_t>(128, literals.size() - i);
+            out.push_back(127 + count);
+            out.insert(out.end(), literals.begin() + i, literals.begin() + i + count);
+        }
+        literals.clear();
+    };
+
+    size_t n = 0;
+    while (n < data.size()) {
+        size_t best_len = 0, best_dist = 0;
+        for (size_t dist = 1; dist <= 256 && dist <= n; dist++) {
+            size_t len = 0;
+            while (len < 130 && n + len < data.size() && data[n + len - dist] == data[n + len]) {
+                len++;
+            }
+            if (len > best_len) {
+                best_len  = len;
+                best_dist = dist;
+            }
+        }
+        if (best_len >= 3) {
+            flush();
+            out.push_back(best_len - 3);
+            out.push_back(best_dist - 1);
+            n += best_len;
+        } else {
+            literals.push_back(data[n++]);
+        }
+    }
+    flush();
+    return out;
+}
+
+/* A 4bpp palette image: flat areas, gradients and a repeating pattern. */
+std::vector<uint8_t> make_image(void) {
+    std::vector<uint8_t> image;
+    for (int y = 0; y < BENCHMARK_IMAGE_HEIGHT; y++) {
+        for (int x = 0; x < BENCHMARK_IMAGE_WIDTH; x += 2) {
+            uint8_t lo, hi;
+            if (y < BENCHMARK_IMAGE_HEIGHT / 3) {
+                lo = hi = 0;
+            } else if (y < 2 * BENCHMARK_IMAGE_HEIGHT / 3) {
+                lo = (x * 16 / BENCHMARK_IMAGE_WIDTH) & 0xF;
+                hi = ((x + 1) * 16 / BENCHMARK_IMAGE_WIDTH) & 0xF;
+            } else {
+                lo = ((x / 4) + (y / 4)) % 3 + 5;
+                hi = ((x / 4) + (y / 4) + 1) % 3 + 5;
+            }
+            image.push_back(lo | (hi << 4));
+        }
+    }
+    return image;
+}
+
+std::vector<uint8_t> random_bytes(size_t count, uint32_t state) {
+    std::vector<uint8_t> bytes(count);
+    for (auto &b : bytes) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        // Small alphabet so that runs and matches actually occur
+        b = (state >> 8) % 6;
+    }
+    return bytes;
+}
+
+std::vector<uint8_t> decode(std::vector<uint8_t> encoded, painter_compression_t compression, size_t count) {
+    qp_memory_stream_t                  stream   = qp_make_memory_stream(encoded.data(), encoded.size());
+    struct qp_internal_byte_input_state state    = {.device = NULL, .src_stream = &stream.base};
+    qp_internal_byte_input_callback     callback = qp_internal_prepare_input_state(&state, compression);
+    std::vector<uint8_t>                out;
+    while (out.size() < count) {
+        const uint8_t *block;
+        uint8_t        len = callback(&state, &block);
+        if (len == 0) {
+            break;
+        }
+        out.insert(out.end(), block, block + len);
+    }
+    if (out.size() > count) {
+        out.resize(count);
+    }
+    return out;
+}
+
+/* The uncompressed per-byte decoder the block decoders replaced. */
+int16_t reference_uncompressed_decoder(void *cb_arg) {
+    return qp_stream_get(((reference_rle_state *)cb_arg)->stream);
+}
+
+struct benchmark_result {
+    double   ns;
+    uint64_t cycles;
+    uint32_t checksum;
+};
+
+template <typename F>
+benchmark_result time_decoder(qp_memory_stream_t *stream, F decode_all) {
+    using clock              = std::chrono::steady_clock;
+    benchmark_result result = {0, 0, 0};
+
+    auto start = clock::now();
+#ifdef BENCHMARK_CYCLES
+    uint64_t start_cycles = BENCHMARK_CYCLES();
+#endif
+    for (int iter = 0; iter < BENCHMARK_ITERATIONS; iter++) {
+        qp_stream_setpos(stream, 0);
+        result.checksum += decode_all();
+    }
+#ifdef BENCHMARK_CYCLES
+    result.cycles = BENCHMARK_CYCLES() - start_cycles;
+#endif
+    result.ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+    return result;
+}
+
+benchmark_result time_per_byte(std::vector<uint8_t> &encoded, int16_t (*decoder)(void *), size_t count) {
+    qp_memory_stream_t  stream = qp_make_memory_stream(encoded.data(), encoded.size());
+    reference_rle_state state  = {.stream = &stream.base};
+    return time_decoder(&stream, [&]() {
+        uint32_t checksum = 0;
+        state.marker      = true;
+        for (size_t i = 0; i < count; i++) {
+            checksum += decoder(&state);
+        }
+        return checksum;
+    });
+}
+
+benchmark_result time_block(std::vector<uint8_t> &encoded, painter_compression_t compression, size_t count) {
+    qp_memory_stream_t                  stream   = qp_make_memory_stream(encoded.data(), encoded.size());
+    struct qp_internal_byte_input_state state    = {.device = NULL, .src_stream = &stream.base};
+    qp_internal_byte_input_callback     callback = qp_internal_prepare_input_state(&state, compression);
+    return time_decoder(&stream, [&]() {
+        uint32_t checksum = 0;
+        size_t   remain   = count;
+        qp_internal_reset_input_state(&state);
+        while (remain > 0) {
+            const uint8_t *block;
+            uint8_t        len = callback(&state, &block);
+            len                = std::min<size_t>(len, remain);
+            for (uint8_t i = 0; i < len; i++) {
+                checksum += block[i];
+            }
+            remain -= len;
+        }
+        return checksum;
+    });
+}
+
+void print_benchmark(const char *name, size_t encoded_size, const benchmark_result &result, size_t count) {
+    double bytes = (double)BENCHMARK_ITERATIONS * count;
+    std::cout << "[ BENCHMARK] " << std::left << std::setw(20) << name << std::right << std::setw(6) << encoded_size << " bytes, " << std::fixed << std::setprecision(2) << result.ns / bytes << " ns/byte";
+#ifdef BENCHMARK_CYCLES
+    std::cout << " (" << result.cycles / bytes << " cycles)";
+#endif
+    std::cout << std::endl;
+}
+
+} // namespace
+
+TEST(QpCodec, MemoryStreamBlockRead) {
+    uint8_t            data[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    uint8_t            out[8]   = {0};
+    qp_memory_stream_t stream   = qp_make_memory_stream(data, sizeof(data));
+
+    EXPECT_EQ(8u, qp_stream_read(out, 1, 8, &stream));
+    EXPECT_EQ(7, out[7]);
+    EXPECT_FALSE(qp_stream_eof(&stream));
+    EXPECT_EQ(2u, qp_stream_read(out, 1, 8, &stream));
+    EXPECT_EQ(9, out[1]);
+    EXPECT_TRUE(qp_stream_eof(&stream));
+    EXPECT_EQ(0u, qp_stream_read(out, 1, 8, &stream));
+    EXPECT_EQ(STREAM_EOF, qp_stream_get(&stream));
+}
+
+TEST(QpCodec, UncompressedMatchesSource) {
+    auto data = random_bytes(1000, 0x12345678);
+    EXPECT_EQ(data, decode(data, IMAGE_UNCOMPRESSED, data.size()));
+}
+
+TEST(QpCodec, RleMatchesReference) {
+    for (uint32_t seed = 1; seed < 50; seed++) {
+        auto               data    = random_bytes(1 + seed * 37, seed);
+        auto               encoded = encode_rle(data);
+        qp_memory_stream_t stream  = qp_make_memory_stream(encoded.data(), encoded.size());
+        reference_rle_state state   = {.stream = &stream.base, .marker = true};
+        std::vector<uint8_t> expected;
+        for (size_t i = 0; i < data.size(); i++) {
+            expected.push_back(reference_rle_decoder(&state));
+        }
+        EXPECT_EQ(data, expected);
+        EXPECT_EQ(data, decode(encoded, IMAGE_COMPRESSED_RLE, data.size()));
+    }
+}
+
+TEST(QpCodec, RleLongRuns) {
+    // Runs crossing block boundaries in both modes
+    std::vector<uint8_t> encoded = {127, 0xAA, 255};
+    for (int i = 0; i < 128; i++) {
+        encoded.push_back(i);
+    }
+    encoded.insert(encoded.end(), {2, 0x55});
+
+    std::vector<uint8_t> expected(127, 0xAA);
+    for (int i = 0; i < 128; i++) {
+        expected.push_back(i);
+    }
+    expected.insert(expected.end(), {0x55, 0x55});
+    EXPECT_EQ(expected, decode(encoded, IMAGE_COMPRESSED_RLE, expected.size() + 10));
+}
+
+TEST(QpCodec, LzRoundTrip) {
+    for (uint32_t seed = 1; seed < 50; seed++) {
+        auto data = random_bytes(1 + seed * 37, seed);
+        EXPECT_EQ(data, decode(encode_lz(data), IMAGE_COMPRESSED_LZ, data.size()));
+    }
+    auto image = make_image();
+    EXPECT_EQ(image, decode(encode_lz(image), IMAGE_COMPRESSED_LZ, image.size()));
+}
+
+TEST(QpCodec, LzOverlappingCopy) {
+    // One literal, then copies at distance 1 and 2 which overlap their own output
+    std::vector<uint8_t> encoded  = {128, 7, 127, 0, 128, 9, 0, 1};
+    std::vector<uint8_t> expected = {7};
+    expected.insert(expected.end(), 130, 7);
+    expected.insert(expected.end(), {9, 7, 9, 7});
+    EXPECT_EQ(expected, decode(encoded, IMAGE_COMPRESSED_LZ, expected.size() + 10));
+}
+
+TEST(QpCodec, TruncatedInputEndsCleanly) {
+    // Repeated run missing its value, and a copy missing its distance
+    EXPECT_EQ(0u, decode({5}, IMAGE_COMPRESSED_RLE, 10).size());
+    EXPECT_EQ(std::vector<uint8_t>({1, 2}), decode({129, 1, 2, 5}, IMAGE_COMPRESSED_LZ, 10));
+}
+
+TEST(QpCodec, Benchmark) {
+    auto   image = make_image();
+    auto   rle   = encode_rle(image);
+    auto   lz    = encode_lz(image);
+    size_t count = image.size();
+
+    auto raw_per_byte = time_per_byte(image, reference_uncompressed_decoder, count);
+    auto raw_block    = time_block(image, IMAGE_UNCOMPRESSED, count);
+    auto rle_per_byte = time_per_byte(rle, reference_rle_decoder, count);
+    auto rle_block    = time_block(rle, IMAGE_COMPRESSED_RLE, count);
+    auto lz_block     = time_block(lz, IMAGE_COMPRESSED_LZ, count);
+    EXPECT_EQ(raw_per_byte.checksum, raw_block.checksum);
+    EXPECT_EQ(raw_per_byte.checksum, rle_per_byte.checksum);
+    EXPECT_EQ(raw_per_byte.checksum, rle_block.checksum);
+    EXPECT_EQ(raw_per_byte.checksum, lz_block.checksum);
+
+    print_benchmark("raw, per-byte", image.size(), raw_per_byte, count);
+    print_benchmark("raw, block", image.size(), raw_block, count);
+    print_benchmark("RLE, per-byte", rle.size(), rle_per_byte, count);
+    print_benchmark("RLE, block", rle.size(), rle_block, count);
+    print_benchmark("LZ, block", lz.size(), lz_block, count);
+}
@@ -0,0 +1,320 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// The painter headers use C11's spelling
+#define _Static_assert static_assert
+
+extern "C" {
+#include "qp_internal.h"
+#include "qp_draw.h"
+#include "qgf.h"
+
+void     qp_internal_task(void);
+uint32_t timer_read32(void) {
+    return 0;
+}
+}
+
+namespace {
+
+#define DISPLAY_WIDTH 64
+#define DISPLAY_HEIGHT 48
+#define IMAGE_WIDTH 37
+#define IMAGE_HEIGHT 30
+#define IMAGE_BANDS ((IMAGE_HEIGHT + QUANTUM_PAINTER_DRAW_QUEUE_ROWS - 1) / QUANTUM_PAINTER_DRAW_QUEUE_ROWS)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// An 8bpp display which renders into a framebuffer
+
+struct fake_display {
+    struct painter_driver_t base;
+    uint8_t                 framebuffer[DISPLAY_HEIGHT][DISPLAY_WIDTH];
+    uint16_t                left, top, right, bottom;
+    uint32_t                cursor;
+    uint32_t                viewports;
+};
+
+fake_display displays[2];
+
+bool fake_viewport(painter_device_t device, uint16_t left, uint16_t top, uint16_t right, uint16_t bottom) {
+    fake_display *display = (fake_display *)device;
+    display->left         = left;
+    display->top          = top;
+    display->right        = right;
+    display->bottom       = bottom;
+    display->cursor       = 0;
+    display->viewports++;
+    return true;
+}
+
+bool fake_pixdata(painter_device_t device, const void *pixel_data, uint32_t native_pixel_count) {
+    fake_display *display = (fake_display *)device;
+    uint16_t      width   = display->right - display->left + 1;
+    for (uint32_t i = 0; i < native_pixel_count; i++, display->cursor++) {
+        uint16_t x = display->left + display->cursor % width;
+        uint16_t y = display->top + display->cursor / width;
+        if (x < DISPLAY_WIDTH && y < DISPLAY_HEIGHT) {
+            display->framebuffer[y][x] = ((const uint8_t *)pixel_data)[i];
+        }
+    }
+    return true;
+}
+
+bool fake_palette_convert(painter_device_t device, int16_t palette_size, qp_pixel_t *palette) {
+    for (int16_t i = 0; i < palette_size; i++) {
+        uint8_t v         = palette[i].hsv888.v;
+        palette[i].rgb565 = v;
+    }
+    return true;
+}
+
+bool fake_append_pixels(painter_device_t device, uint8_t *target_buffer, qp_pixel_t *palette, uint32_t pixel_offset, uint32_t pixel_count, uint8_t *palette_indices) {
+    for (uint32_t i = 0; i < pixel_count; i++) {
+        target_buffer[pixel_offset + i] = palette[palette_indices[i]].rgb565;
+    }
+    return true;
+}
+
+bool fake_comms(painter_device_t device) {
+    return true;
+}
+
+void fake_comms_stop(painter_device_t device) {}
+
+const struct painter_driver_vtable_t fake_driver_vtable = {
+    .viewport        = fake_viewport,
+    .pixdata         = fake_pixdata,
+    .palette_convert = fake_palette_convert,
+    .append_pixels   = fake_append_pixels,
+};
+
+const struct painter_comms_vtable_t fake_comms_vtable = {
+    .comms_init  = fake_comms,
+    .comms_start = fake_comms,
+    .comms_stop  = fake_comms_stop,
+};
+
+painter_device_t make_display(int index) {
+    fake_display *display = &displays[index];
+    memset(display, 0, sizeof(*display));
+    display->base.driver_vtable         = &fake_driver_vtable;
+    display->base.comms_vtable          = &fake_comms_vtable;
+    display->base.validate_ok           = true;
+    display->base.panel_width           = DISPLAY_WIDTH;
+    display->base.panel_height          = DISPLAY_HEIGHT;
+    display->base.native_bits_per_pixel = 8;
+    return &display->base;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Single frame QGF images, with a pattern that has both repeated and varying runs of bytes
+
+uint8_t image_pixel(int x, int y, uint8_t bpp) {
+    return ((y / 4) % 3 == 0 ? 1 : x * 3 + y * 5 + x * y) & ((1 << bpp) - 1);
+}
+
+void append_block_header(std::vector<uint8_t> &out, uint8_t type_id, uint32_t length) {
+    out.insert(out.end(), {type_id, (uint8_t)~type_id, (uint8_t)length, (uint8_t)(length >> 8), (uint8_t)(length >> 16)});
+}
+
+void append_u16(std::vector<uint8_t> &out, uint16_t value) {
+    out.insert(out.end(), {(uint8_t)value, (uint8_t)(value >> 8)});
+}
+
+void append_u32(std::vector<uint8_t> &out, uint32_t value) {
+    out.insert(out.end(), {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)});
+}
+
+std::vector<uint8_t> encode_rle(const std::vector<uint8_t> &data) {
+    std::vector<uint8_t> out;
+    size_t               i = 0;
+    while (i < data.size()) {
+        size_t repeat = 1;
+        while (i + repeat < data.size() && repeat < 127 && data[i + repeat] == data[i]) {
+            repeat++;
+        }
+        if (repeat >= 3) {
+            out.insert(out.end(), {(uint8_t)repeat, data[i]});
+            i += repeat;
+            continue;
+        }
+        size_t literal = 1;
+        while (i + literal < data.size() && literal < 128 && !(i + literal + 2 < data.size() && data[i + literal] == data[i + literal + 1] && data[i + literal] == data[i + literal + 2])) {
+            literal++;
+        }
+        out.push_back(127 + literal);
+        out.insert(out.end(), data.begin() + i, data.begin() + i + literal);
+        i += literal;
+    }
+    return out;
+}
+
+std::vector<uint8_t> make_image(qp_image_format_t format, uint8_t bpp, bool has_palette, bool rle) {
+    std::vector<uint8_t> packed((IMAGE_WIDTH * IMAGE_HEIGHT * bpp + 7) / 8);
+    for (int i = 0; i < IMAGE_WIDTH * IMAGE_HEIGHT; i++) {
+        packed[i * bpp / 8] |= image_pixel(i % IMAGE_WIDTH, i / IMAGE_WIDTH, bpp) << ((i * bpp) % 8);
+    }
+    std::vector<uint8_t> data = rle ? encode_rle(packed) : packed;
+
+    uint16_t palette_entries = has_palette ? 1 << bpp : 0;
+    uint32_t total           = sizeof(qgf_graphics_descriptor_v1_t) + sizeof(qgf_frame_offsets_v1_t) + sizeof(uint32_t) + sizeof(qgf_frame_v1_t) + (has_palette ? sizeof(qgf_block_header_v1_t) + palette_entries * 3 : 0) + sizeof(qgf_data_v1_t) + data.size();
+
+    std::vector<uint8_t> image;
+    append_block_header(image, QGF_GRAPHICS_DESCRIPTOR_TYPEID, sizeof(qgf_graphics_descriptor_v1_t) - sizeof(qgf_block_header_v1_t));
+    image.insert(image.end(), {0x51, 0x47, 0x46, 0x01}); // magic, version
+    append_u32(image, total);
+    append_u32(image, ~total);
+    append_u16(image, IMAGE_WIDTH);
+    append_u16(image, IMAGE_HEIGHT);
+    append_u16(image, 1);
+    append_block_header(image, QGF_FRAME_OFFSET_DESCRIPTOR_TYPEID, sizeof(uint32_t));
+    append_u32(image, image.size() + sizeof(uint32_t));
+    append_block_header(image, QGF_FRAME_DESCRIPTOR_TYPEID, sizeof(qgf_frame_v1_t) - sizeof(qgf_block_header_v1_t));
+    image.insert(image.end(), {(uint8_t)format, 0, (uint8_t)(rle ? IMAGE_COMPRESSED_RLE : IMAGE_UNCOMPRESSED), 0, 0, 0});
+    if (has_palette) {
+        append_block_header(image, QGF_FRAME_PALETTE_DESCRIPTOR_TYPEID, palette_entries * 3);
+        for (uint16_t i = 0; i < palette_entries; i++) {
+            image.insert(image.end(), {0, 0, (uint8_t)(255 - i * 7)});
+        }
+    }
+    append_block_header(image, QGF_FRAME_DATA_DESCRIPTOR_TYPEID, data.size());
+    image.insert(image.end(), data.begin(), data.end());
+    return image;
+}
+
+struct image_format {
+    const char *      name;
+    qp_image_format_t format;
+    uint8_t           bpp;
+    bool              has_palette;
+    bool              rle;
+};
+
+const image_format image_formats[] = {
+    {"mono2", GRAYSCALE_2BPP, 2, false, false},
+    {"mono2 rle", GRAYSCALE_2BPP, 2, false, true},
+    {"pal4", PALETTE_4BPP, 4, true, false},
+    {"pal4 rle", PALETTE_4BPP, 4, true, true},
+    {"mono1 rle", GRAYSCALE_1BPP, 1, false, true},
+};
+
+class QpDrawImage : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        device = make_display(0);
+        other  = make_display(1);
+    }
+
+    void TearDown() override {
+        for (auto image : images) {
+            qp_close_image(image);
+        }
+    }
+
+    painter_image_handle_t load(const image_format &format) {
+        image_data.push_back(make_image(format.format, format.bpp, format.has_palette, format.rle));
+        painter_image_handle_t image = qp_load_image_mem(image_data.back().data());
+        images.push_back(image);
+        return image;
+    }
+
+    // Runs the main loop until the queue stops drawing, returning the number of passes that drew something
+    int run_queue(void) {
+        int passes = 0;
+        for (;;) {
+            uint32_t viewports = displays[0].viewports + displays[1].viewports;
+            qp_internal_task();
+            if (displays[0].viewports + displays[1].viewports == viewports) {
+                return passes;
+            }
+            passes++;
+        }
+    }
+
+    painter_device_t                    device;
+    painter_device_t                    other;
+    std::vector<std::vector<uint8_t>>   image_data;
+    std::vector<painter_image_handle_t> images;
+};
+
+} // namespace
+
+TEST_F(QpDrawImage, QueuedMatchesImmediate) {
+    for (auto &format : image_formats) {
+        painter_image_handle_t image = load(format);
+        ASSERT_NE(nullptr, image) << format.name;
+
+        memset(displays[0].framebuffer, 0xAA, sizeof(displays[0].framebuffer));
+        EXPECT_TRUE(qp_drawimage(device, 3, 5, image)) << format.name;
+        uint8_t expected[DISPLAY_HEIGHT][DISPLAY_WIDTH];
+        memcpy(expected, displays[0].framebuffer, sizeof(expected));
+
+        memset(displays[0].framebuffer, 0xAA, sizeof(displays[0].framebuffer));
+        displays[0].viewports = 0;
+        EXPECT_TRUE(qp_drawimage_queued(device, 3, 5, image)) << format.name;
+        EXPECT_EQ(0u, displays[0].viewports) << format.name << ": drawn before the main loop ran";
+        EXPECT_EQ(IMAGE_BANDS, run_queue()) << format.name;
+        EXPECT_EQ(0, memcmp(expected, displays[0].framebuffer, sizeof(expected))) << format.name;
+    }
+}
+
+TEST_F(QpDrawImage, OtherDrawsBetweenBands) {
+    painter_image_handle_t queued = load(image_formats[3]);
+    painter_image_handle_t mono   = load(image_formats[1]);
+    ASSERT_NE(nullptr, queued);
+    ASSERT_NE(nullptr, mono);
+
+    memset(displays[0].framebuffer, 0xAA, sizeof(displays[0].framebuffer));
+    EXPECT_TRUE(qp_drawimage(device, 0, 0, queued));
+    uint8_t expected[DISPLAY_HEIGHT][DISPLAY_WIDTH];
+    memcpy(expected, displays[0].framebuffer, sizeof(expected));
+    memset(displays[0].framebuffer, 0xAA, sizeof(displays[0].framebuffer));
+
+    // Draws to another display change the palette and the position of a shared image's stream
+    EXPECT_TRUE(qp_drawimage_queued(device, 0, 0, queued));
+    for (int band = 0; band < IMAGE_BANDS; band++) {
+        qp_internal_task();
+        EXPECT_TRUE(qp_drawimage_recolor(other, 0, 0, mono, 0, 0, 100, 0, 0, 20));
+        EXPECT_TRUE(qp_drawimage(other, 0, 0, queued));
+    }
+    EXPECT_EQ(0, run_queue());
+    EXPECT_EQ(0, memcmp(expected, displays[0].framebuffer, sizeof(expected)));
+}
+
+TEST_F(QpDrawImage, ImmediateDrawsWaitForTheQueue) {
+    painter_image_handle_t image = load(image_formats[2]);
+    ASSERT_NE(nullptr, image);
+
+    // The rect has to end up on top of the queued image
+    EXPECT_TRUE(qp_drawimage_queued(device, 0, 0, image));
+    qp_internal_task();
+    EXPECT_TRUE(qp_rect(device, 0, 0, 9, 9, 0, 0, 42, true));
+    EXPECT_EQ(0, run_queue());
+    for (int y = 0; y < 10; y++) {
+        for (int x = 0; x < 10; x++) {
+            ASSERT_EQ(42, displays[0].framebuffer[y][x]) << x << "," << y;
+        }
+    }
+}
+
+TEST_F(QpDrawImage, QueueFull) {
+    painter_image_handle_t image = load(image_formats[0]);
+    ASSERT_NE(nullptr, image);
+
+    for (int i = 0; i < QUANTUM_PAINTER_DRAW_QUEUE_SIZE; i++) {
+        EXPECT_TRUE(qp_drawimage_queued(device, 0, 0, image));
+    }
+    EXPECT_FALSE(qp_drawimage_queued(device, 0, 0, image));
+
+    // Closing the image finishes drawing it
+    qp_close_image(image);
+    images.clear();
+    EXPECT_EQ((uint32_t)QUANTUM_PAINTER_DRAW_QUEUE_SIZE * IMAGE_BANDS, displays[0].viewports);
+    EXPECT_EQ(0, run_queue());
+}
@@ -0,0 +1,349 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#    define BENCHMARK_CYCLES() __rdtsc()
+#endif
+
+// The painter headers use C11's spelling
+#define _Static_assert static_assert
+
+extern "C" {
+#include "qp_internal.h"
+#include "qp_draw.h"
+#include "qff.h"
+#include "qp_glyph_cache.h"
+}
+
+namespace {
+
+#define DISPLAY_WIDTH 480
+#define DISPLAY_HEIGHT 16
+#define FONT_HEIGHT 12
+#define BENCHMARK_STRING "CPU 42% WPM 117 L3"
+#define BENCHMARK_DRAWS 2000
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// An 8bpp display which renders into a framebuffer, counting transfers
+
+struct fake_display {
+    struct painter_driver_t base;
+    uint8_t                 framebuffer[DISPLAY_HEIGHT][DISPLAY_WIDTH];
+    uint16_t                left, top, right, bottom;
+    uint32_t                cursor;
+    uint32_t                viewports;
+    uint32_t                transfers;
+};
+
+fake_display display;
+
+bool fake_viewport(painter_device_t device, uint16_t left, uint16_t top, uint16_t right, uint16_t bottom) {
+    display.left   = left;
+    display.top    = top;
+    display.right  = right;
+    display.bottom = bottom;
+    display.cursor = 0;
+    display.viewports++;
+    return true;
+}
+
+bool fake_pixdata(painter_device_t device, const void *pixel_data, uint32_t native_pixel_count) {
+    uint16_t width = display.right - display.left + 1;
+    for (uint32_t i = 0; i < native_pixel_count; i++, display.cursor++) {
+        uint16_t x = display.left + display.cursor % width;
+        uint16_t y = display.top + display.cursor / width;
+        if (x < DISPLAY_WIDTH && y < DISPLAY_HEIGHT) {
+            display.framebuffer[y][x] = ((const uint8_t *)pixel_data)[i];
+        }
+    }
+    display.transfers++;
+    return true;
+}
+
+bool fake_palette_convert(painter_device_t device, int16_t palette_size, qp_pixel_t *palette) {
+    for (int16_t i = 0; i < palette_size; i++) {
+        uint8_t v         = palette[i].hsv888.v;
+        palette[i].rgb565 = v;
+    }
+    return true;
+}
+
+bool fake_append_pixels(painter_device_t device, uint8_t *target_buffer, qp_pixel_t *palette, uint32_t pixel_offset, uint32_t pixel_count, uint8_t *palette_indices) {
+    for (uint32_t i = 0; i < pixel_count; i++) {
+        target_buffer[pixel_offset + i] = palette[palette_indices[i]].rgb565;
+    }
+    return true;
+}
+
+bool fake_comms(painter_device_t device) {
+    return true;
+}
+
+void fake_comms_stop(painter_device_t device) {}
+
+const struct painter_driver_vtable_t fake_driver_vtable = {
+    .viewport        = fake_viewport,
+    .pixdata         = fake_pixdata,
+    .palette_convert = fake_palette_convert,
+    .append_pixels   = fake_append_pixels,
+};
+
+const struct painter_comms_vtable_t fake_comms_vtable = {
+    .comms_init  = fake_comms,
+    .comms_start = fake_comms,
+    .comms_stop  = fake_comms_stop,
+};
+
+painter_device_t make_display(void) {
+    memset(&display, 0, sizeof(display));
+    display.base.driver_vtable         = &fake_driver_vtable;
+    display.base.comms_vtable          = &fake_comms_vtable;
+    display.base.validate_ok           = true;
+    display.base.panel_width           = DISPLAY_WIDTH;
+    display.base.panel_height          = DISPLAY_HEIGHT;
+    display.base.native_bits_per_pixel = 8;
+    return &display.base;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// A 2bpp grayscale font covering the ASCII table, with a unique pattern per glyph
+
+uint8_t glyph_width(uint32_t code_point) {
+    return 3 + code_point % 6;
+}
+
+uint8_t glyph_pixel(uint32_t code_point, int x, int y) {
+    return (code_point + x * 3 + y * 5 + x * y) & 3;
+}
+
+void append_block_header(std::vector<uint8_t> &out, uint8_t type_id, uint32_t length) {
+    out.insert(out.end(), {type_id, (uint8_t)~type_id, (uint8_t)length, (uint8_t)(length >> 8), (uint8_t)(length >> 16)});
+}
+
+void append_u32(std::vector<uint8_t> &out, uint32_t value) {
+    out.insert(out.end(), {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)});
+}
+
+std::vector<uint8_t> make_font(bool rle) {
+    std::vector<uint8_t> glyph_data;
+    std::vector<uint32_t> glyph_table;
+    for (uint32_t cp = 0x20; cp < 0x7F; cp++) {
+        uint8_t width = glyph_width(cp);
+        glyph_table.push_back(width | (glyph_data.size() << QFF_GLYPH_WIDTH_BITS));
+
+        std::vector<uint8_t> packed((width * FONT_HEIGHT * 2 + 7) / 8);
+        for (int i = 0; i < width * FONT_HEIGHT; i++) {
+            packed[i / 4] |= glyph_pixel(cp, i % width, i / width) << ((i % 4) * 2);
+        }
+        if (rle) {
+            // Literal runs only, which are valid QMK RLE
+            for (size_t i = 0; i < packed.size(); i += 128) {
+                size_t count = std::min<size_t>(128, packed.size() - i);
+                glyph_data.push_back(127 + count);
+                glyph_data.insert(glyph_data.end(), packed.begin() + i, packed.begin() + i + count);
+            }
+        } else {
+            glyph_data.insert(glyph_data.end(), packed.begin(), packed.end());
+        }
+    }
+
+    std::vector<uint8_t> font;
+    uint32_t             total = sizeof(qff_font_descriptor_v1_t) + sizeof(qff_ascii_glyph_table_v1_t) + sizeof(qgf_block_header_v1_t) + glyph_data.size();
+    append_block_header(font, QFF_FONT_DESCRIPTOR_TYPEID, sizeof(qff_font_descriptor_v1_t) - sizeof(qgf_block_header_v1_t));
+    font.insert(font.end(), {0x51, 0x46, 0x46, 0x01}); // magic, version
+    append_u32(font, total);
+    append_u32(font, ~total);
+    font.insert(font.end(), {FONT_HEIGHT, 1, 0, 0, GRAYSCALE_2BPP, 0, (uint8_t)(rle ? IMAGE_COMPRESSED_RLE : IMAGE_UNCOMPRESSED), 0});
+    append_block_header(font, QFF_ASCII_GLYPH_DESCRIPTOR_TYPEID, sizeof(qff_ascii_glyph_table_v1_t) - sizeof(qgf_block_header_v1_t));
+    for (uint32_t value : glyph_table) {
+        font.insert(font.end(), {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16)});
+    }
+    append_block_header(font, 0x04, glyph_data.size());
+    font.insert(font.end(), glyph_data.begin(), glyph_data.end());
+    return font;
+}
+
+// Checks the framebuffer against the expected glyph patterns, returning the number of mismatched pixels
+int verify_text(const char *str, int x, int y) {
+    int mismatches = 0;
+    for (; *str; str++) {
+        for (int gy = 0; gy < FONT_HEIGHT; gy++) {
+            for (int gx = 0; gx < glyph_width(*str); gx++) {
+                uint8_t expected = glyph_pixel(*str, gx, gy) * 85;
+                if (display.framebuffer[y + gy][x + gx] != expected) {
+                    mismatches++;
+                }
+            }
+        }
+        x += glyph_width(*str);
+    }
+    return mismatches;
+}
+
+class QpDrawText : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        device = make_display();
+    }
+
+    void TearDown() override {
+        if (font) {
+            qp_close_font(font);
+        }
+    }
+
+    painter_font_handle_t load(bool rle) {
+        font_data = make_font(rle);
+        font      = qp_load_font_mem(font_data.data());
+        return font;
+    }
+
+    painter_device_t      device;
+    std::vector<uint8_t>  font_data;
+    painter_font_handle_t font = NULL;
+};
+
+} // namespace
+
+TEST_F(QpDrawText, DrawsGlyphs) {
+    ASSERT_NE(nullptr, load(false));
+    const char *str = "Hello, World! 0123";
+    for (int pass = 0; pass < 2; pass++) {
+        memset(display.framebuffer, 0xAA, sizeof(display.framebuffer));
+        EXPECT_EQ(qp_textwidth(font, str), qp_drawtext(device, 5, 2, font, str));
+        EXPECT_EQ(0, verify_text(str, 5, 2)) << "pass " << pass;
+    }
+}
+
+TEST_F(QpDrawText, DrawsRleGlyphs) {
+    ASSERT_NE(nullptr, load(true));
+    const char *str = "The quick brown fox";
+    for (int pass = 0; pass < 2; pass++) {
+        memset(display.framebuffer, 0xAA, sizeof(display.framebuffer));
+        EXPECT_EQ(qp_textwidth(font, str), qp_drawtext(device, 0, 0, font, str));
+        EXPECT_EQ(0, verify_text(str, 0, 0)) << "pass " << pass;
+    }
+}
+
+TEST_F(QpDrawText, DrawsMoreGlyphsThanTheCacheHolds) {
+    ASSERT_NE(nullptr, load(false));
+    // Every ASCII glyph, drawn in pieces as the display isn't wide enough
+    for (char start = 0x20; start < 0x7F; start += 40) {
+        char str[41] = {0};
+        for (int i = 0; i < 40 && start + i < 0x7F; i++) {
+            str[i] = start + i;
+        }
+        memset(display.framebuffer, 0xAA, sizeof(display.framebuffer));
+        EXPECT_EQ(qp_textwidth(font, str), qp_drawtext(device, 0, 1, font, str));
+        EXPECT_EQ(0, verify_text(str, 0, 1)) << "from " << (int)start;
+    }
+}
+
+#if QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
+TEST_F(QpDrawText, BatchesCachedGlyphs) {
+    ASSERT_NE(nullptr, load(false));
+    const char *str = "0123456789";
+    qp_drawtext(device, 0, 0, font, str);
+    display.viewports = 0;
+    qp_drawtext(device, 0, 0, font, str);
+    EXPECT_EQ(1u, display.viewports);
+}
+
+TEST(QpGlyphCache, EvictsLeastRecentlyUsed) {
+    int  fonts[2];
+    auto a = qp_glyph_cache_insert(&fonts[0], 'a', 4, QUANTUM_PAINTER_GLYPH_CACHE_SIZE / 2);
+    auto b = qp_glyph_cache_insert(&fonts[0], 'b', 4, QUANTUM_PAINTER_GLYPH_CACHE_SIZE / 2);
+    ASSERT_NE(nullptr, a);
+    ASSERT_NE(nullptr, b);
+    memset(qp_glyph_cache_data(b), 'b', QUANTUM_PAINTER_GLYPH_CACHE_SIZE / 2);
+
+    // 'a' was used more recently, so 'b' goes -- and the remaining data is compacted
+    EXPECT_EQ(a, qp_glyph_cache_find(&fonts[0], 'a'));
+    auto c = qp_glyph_cache_insert(&fonts[1], 'c', 4, QUANTUM_PAINTER_GLYPH_CACHE_SIZE / 2);
+    ASSERT_NE(nullptr, c);
+    EXPECT_EQ(nullptr, qp_glyph_cache_find(&fonts[0], 'b'));
+    EXPECT_EQ(a, qp_glyph_cache_find(&fonts[0], 'a'));
+    EXPECT_EQ(c, qp_glyph_cache_find(&fonts[1], 'c'));
+
+    // Pinned entries stay put, even if that means the insert fails
+    a->pinned = true;
+    c->pinned = true;
+    EXPECT_EQ(nullptr, qp_glyph_cache_insert(&fonts[0], 'd', 4, 1));
+    qp_glyph_cache_unpin_all();
+    EXPECT_NE(nullptr, qp_glyph_cache_insert(&fonts[0], 'd', 4, 1));
+
+    // Oversized and empty glyphs are never cached
+    EXPECT_EQ(nullptr, qp_glyph_cache_insert(&fonts[0], 'e', 4, QUANTUM_PAINTER_GLYPH_CACHE_SIZE + 1));
+    EXPECT_EQ(nullptr, qp_glyph_cache_insert(&fonts[0], 'f', 0, 0));
+
+    qp_glyph_cache_remove_font(&fonts[0]);
+    EXPECT_EQ(nullptr, qp_glyph_cache_find(&fonts[0], 'a'));
+    EXPECT_EQ(c, qp_glyph_cache_find(&fonts[1], 'c'));
+    qp_glyph_cache_remove_font(&fonts[1]);
+}
+
+TEST(QpGlyphCache, CompactsFragmentedData) {
+    int                     font;
+    qp_glyph_cache_entry_t *entries[4];
+    for (int i = 0; i < 4; i++) {
+        entries[i] = qp_glyph_cache_insert(&font, i, 4, QUANTUM_PAINTER_GLYPH_CACHE_SIZE / 4);
+        ASSERT_NE(nullptr, entries[i]);
+        memset(qp_glyph_cache_data(entries[i]), i, QUANTUM_PAINTER_GLYPH_CACHE_SIZE / 4);
+    }
+
+    // Free two non-adjacent quarters, then ask for half
+    qp_glyph_cache_remove(entries[0]);
+    qp_glyph_cache_remove(entries[2]);
+    auto half = qp_glyph_cache_insert(&font, 4, 4, QUANTUM_PAINTER_GLYPH_CACHE_SIZE / 2);
+    ASSERT_NE(nullptr, half);
+    for (int i : {1, 3}) {
+        auto entry = qp_glyph_cache_find(&font, i);
+        ASSERT_NE(nullptr, entry);
+        uint8_t *data = qp_glyph_cache_data(entry);
+        for (int j = 0; j < QUANTUM_PAINTER_GLYPH_CACHE_SIZE / 4; j++) {
+            ASSERT_EQ(i, data[j]);
+        }
+    }
+    qp_glyph_cache_remove_font(&font);
+}
+#endif // QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0
+
+TEST_F(QpDrawText, Benchmark) {
+    using clock = std::chrono::steady_clock;
+    ASSERT_NE(nullptr, load(true));
+
+    // Warm up, as a status screen would be after its first frame
+    qp_drawtext(device, 0, 0, font, BENCHMARK_STRING);
+    display.viewports = 0;
+    display.transfers = 0;
+
+    auto start = clock::now();
+#ifdef BENCHMARK_CYCLES
+    uint64_t start_cycles = BENCHMARK_CYCLES();
+#endif
+    for (int i = 0; i < BENCHMARK_DRAWS; i++) {
+        qp_drawtext(device, 0, 0, font, BENCHMARK_STRING);
+    }
+#ifdef BENCHMARK_CYCLES
+    uint64_t cycles = BENCHMARK_CYCLES() - start_cycles;
+#endif
+    double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    EXPECT_EQ(0, verify_text(BENCHMARK_STRING, 0, 0));
+
+    double glyphs = (double)BENCHMARK_DRAWS * strlen(BENCHMARK_STRING);
+    std::cout << "[ BENCHMARK] " << (QUANTUM_PAINTER_GLYPH_CACHE_SIZE > 0 ? "cached  " : "streamed") << std::fixed << std::setprecision(0) << " " << glyphs / elapsed << " glyphs/s";
+#ifdef BENCHMARK_CYCLES
+    std::cout << " (" << cycles / glyphs << " cycles/glyph)";
+#endif
+    std::cout << std::setprecision(1) << ", " << display.viewports / (double)BENCHMARK_DRAWS << " viewports and " << display.transfers / (double)BENCHMARK_DRAWS << " transfers per string" << std::endl;
+}
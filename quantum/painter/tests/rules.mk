@@ -0,0 +1,39 @@
+qp_codec_DEFS := -DMATRIX_ROWS=1 -DMATRIX_COLS=1 -DQUANTUM_PAINTER_ENABLE -DQUANTUM_PAINTER_SUPPORTS_256_PALETTE=1 -DQUANTUM_PAINTER_SUPPORTS_LZ=1
+qp_codec_INC := $(QUANTUM_PATH)/painter
+
+qp_codec_SRC := \
+	$(QUANTUM_PATH)/painter/tests/qp_codec_tests.cpp \
+	$(QUANTUM_PATH)/painter/qp_draw_codec.c \
+	$(QUANTUM_PATH)/painter/qp_stream.c
+
+qp_drawimage_DEFS := -DMATRIX_ROWS=1 -DMATRIX_COLS=1 -DQUANTUM_PAINTER_ENABLE -DQUANTUM_PAINTER_DRAW_QUEUE_SIZE=4
+qp_drawimage_INC := $(QUANTUM_PATH)/painter
+
+qp_drawimage_SRC := \
+	$(QUANTUM_PATH)/painter/tests/qp_drawimage_tests.cpp \
+	$(QUANTUM_PATH)/painter/qp_draw_image.c \
+	$(QUANTUM_PATH)/painter/qp_draw_core.c \
+	$(QUANTUM_PATH)/painter/qp_draw_codec.c \
+	$(QUANTUM_PATH)/painter/qp_comms.c \
+	$(QUANTUM_PATH)/painter/qp_stream.c \
+	$(QUANTUM_PATH)/painter/qgf.c \
+	$(QUANTUM_PATH)/deferred_exec.c
+
+qp_drawtext_DEFS := -DMATRIX_ROWS=1 -DMATRIX_COLS=1 -DQUANTUM_PAINTER_ENABLE
+qp_drawtext_INC := $(QUANTUM_PATH)/painter $(QUANTUM_PATH)/unicode
+
+qp_drawtext_SRC := \
+	$(QUANTUM_PATH)/painter/tests/qp_drawtext_tests.cpp \
+	$(QUANTUM_PATH)/painter/qp_draw_text.c \
+	$(QUANTUM_PATH)/painter/qp_draw_core.c \
+	$(QUANTUM_PATH)/painter/qp_draw_codec.c \
+	$(QUANTUM_PATH)/painter/qp_glyph_cache.c \
+	$(QUANTUM_PATH)/painter/qp_comms.c \
+	$(QUANTUM_PATH)/painter/qp_stream.c \
+	$(QUANTUM_PATH)/painter/qff.c \
+	$(QUANTUM_PATH)/painter/qgf.c \
+	$(QUANTUM_PATH)/unicode/utf8.c
+
+qp_drawtext_cache_DEFS := $(qp_drawtext_DEFS) -DQUANTUM_PAINTER_GLYPH_CACHE_SIZE=512
+qp_drawtext_cache_INC := $(qp_drawtext_INC)
+qp_drawtext_cache_SRC := $(qp_drawtext_SRC)
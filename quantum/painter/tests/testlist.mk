@@ -0,0 +1,4 @@
+TEST_LIST += qp_codec
+TEST_LIST += qp_drawimage
+TEST_LIST += qp_drawtext
+TEST_LIST += qp_drawtext_cache
@@ -213,6 +213,100 @@ report_mouse_t pointing_device_adjust_by_defines(report_mouse_t mouse_report) {
     return mouse_report;
 }
 
+#ifdef POINTING_DEVICE_ACCUMULATE_MOTION
+// Holds back at most two reports' worth of motion, so a host that stops polling for a while doesn't get a jump after
+#    define MOTION_ACCUMULATOR_LIMIT (((int32_t)XY_REPORT_MAX * 2) << POINTING_DEVICE_MOTION_SHIFT)
+#    define SCROLL_ACCUMULATOR_LIMIT (INT8_MAX * 2)
+
+static pointing_device_motion_t accumulated_motion = {0};
+static int32_t                  accumulated_v      = 0;
+static int32_t                  accumulated_h      = 0;
+
+/**
+ * @brief Weak function allowing for keyboard level scaling of sensor motion
+ *
+ * Takes the motion from a single sensor read, in fixed point with POINTING_DEVICE_MOTION_SHIFT fractional bits, and
+ * returns it scaled. Fractions of a count are kept, so this is the place for CPI scaling or acceleration curves.
+ *
+ * @param[in] motion pointing_device_motion_t
+ * @return pointing_device_motion_t
+ */
+__attribute__((weak)) pointing_device_motion_t pointing_device_motion_kb(pointing_device_motion_t motion) {
+    return pointing_device_motion_user(motion);
+}
+
+/**
+ * @brief Weak function allowing for user level scaling of sensor motion
+ *
+ * @param[in] motion pointing_device_motion_t
+ * @return pointing_device_motion_t
+ */
+__attribute__((weak)) pointing_device_motion_t pointing_device_motion_user(pointing_device_motion_t motion) {
+    return motion;
+}
+
+static inline int32_t pointing_device_motion_clamp(int32_t value, int32_t limit) {
+    return value > limit ? limit : (value < -limit ? -limit : value);
+}
+
+/**
+ * @brief Takes the whole counts out of an accumulated axis, leaving the remainder
+ *
+ * @param[in,out] accumulated fixed point motion on one axis
+ * @return mouse_xy_report_t whole counts, limited to the report range
+ */
+static mouse_xy_report_t pointing_device_take_xy(int32_t *accumulated) {
+    int32_t counts = pointing_device_motion_clamp(*accumulated / (1 << POINTING_DEVICE_MOTION_SHIFT), XY_REPORT_MAX);
+    *accumulated -= counts * (1 << POINTING_DEVICE_MOTION_SHIFT);
+    return counts;
+}
+
+static int8_t pointing_device_take_hv(int32_t *accumulated) {
+    int8_t counts = pointing_device_motion_clamp(*accumulated, INT8_MAX);
+    *accumulated -= counts;
+    return counts;
+}
+
+/**
+ * @brief Accumulates mouse report motion until the host is ready for another report
+ *
+ * Adds the motion in the report to the accumulator, then, if the host is ready or the buttons have changed, replaces
+ * it with as much of the accumulated motion as fits in a report. Whatever is left over, including fractions of a
+ * count, is carried forward to the next report.
+ *
+ * @param[in,out] mouse_report report_mouse_t
+ * @return true if the report should be processed and sent now
+ */
+static bool pointing_device_accumulate(report_mouse_t *mouse_report) {
+    static uint8_t last_buttons = 0;
+
+    pointing_device_motion_t motion = {
+        .x = mouse_report->x * (1 << POINTING_DEVICE_MOTION_SHIFT),
+        .y = mouse_report->y * (1 << POINTING_DEVICE_MOTION_SHIFT),
+    };
+    motion               = pointing_device_motion_kb(motion);
+    accumulated_motion.x = pointing_device_motion_clamp(accumulated_motion.x + motion.x, MOTION_ACCUMULATOR_LIMIT);
+    accumulated_motion.y = pointing_device_motion_clamp(accumulated_motion.y + motion.y, MOTION_ACCUMULATOR_LIMIT);
+    accumulated_v        = pointing_device_motion_clamp(accumulated_v + mouse_report->v, SCROLL_ACCUMULATOR_LIMIT);
+    accumulated_h        = pointing_device_motion_clamp(accumulated_h + mouse_report->h, SCROLL_ACCUMULATOR_LIMIT);
+
+    if (mouse_report->buttons == last_buttons && !host_mouse_ready()) {
+        mouse_report->x = 0;
+        mouse_report->y = 0;
+        mouse_report->v = 0;
+        mouse_report->h = 0;
+        return false;
+    }
+
+    last_buttons    = mouse_report->buttons;
+    mouse_report->x = pointing_device_take_xy(&accumulated_motion.x);
+    mouse_report->y = pointing_device_take_xy(&accumulated_motion.y);
+    mouse_report->v = pointing_device_take_hv(&accumulated_v);
+    mouse_report->h = pointing_device_take_hv(&accumulated_h);
+    return true;
+}
+#endif
+
 /**
  * @brief Retrieves and processes pointing device data.
  *
@@ -275,6 +369,11 @@ __attribute__((weak)) void pointing_device_task(void) {
     local_mouse_report = is_keyboard_left() ? pointing_device_task_combined_kb(local_mouse_report, shared_mouse_report) : pointing_device_task_combined_kb(shared_mouse_report, local_mouse_report);
 #else
     local_mouse_report = pointing_device_adjust_by_defines(local_mouse_report);
+#    ifdef POINTING_DEVICE_ACCUMULATE_MOTION
+    if (!pointing_device_accumulate(&local_mouse_report)) {
+        return;
+    }
+#    endif
     local_mouse_report = pointing_device_task_kb(local_mouse_report);
 #endif
     // automatic mouse layer function
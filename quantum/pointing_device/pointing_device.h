@@ -96,6 +96,23 @@ typedef int32_t clamp_range_t;
 typedef int16_t clamp_range_t;
 #endif
 
+#ifdef POINTING_DEVICE_ACCUMULATE_MOTION
+#    if defined(POINTING_DEVICE_COMBINED)
+#        error "POINTING_DEVICE_ACCUMULATE_MOTION is not supported with POINTING_DEVICE_COMBINED"
+#    endif
+/* Number of fractional bits in accumulated motion */
+#    define POINTING_DEVICE_MOTION_SHIFT 8
+
+/* Sensor motion, in fixed point with POINTING_DEVICE_MOTION_SHIFT fractional bits */
+typedef struct {
+    int32_t x;
+    int32_t y;
+} pointing_device_motion_t;
+
+pointing_device_motion_t pointing_device_motion_kb(pointing_device_motion_t motion);
+pointing_device_motion_t pointing_device_motion_user(pointing_device_motion_t motion);
+#endif
+
 void           pointing_device_init(void);
 void           pointing_device_task(void);
 void           pointing_device_send(void);
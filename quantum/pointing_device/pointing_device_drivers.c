@@ -325,16 +325,38 @@ static uint16_t pmw33xx_get_cpi_wrapper(void) {
     return pmw33xx_get_cpi(0);
 }
 
+#    ifdef POINTING_DEVICE_ACCUMULATE_MOTION
+/* Clamps a sensor delta to the report range, carrying up to one more report's worth over to the next read */
+static mouse_xy_report_t pmw33xx_carry_xy(int16_t delta, mouse_xy_report_t *carry) {
+    int32_t           total  = *carry + delta;
+    mouse_xy_report_t report = CONSTRAIN_HID_XY(total);
+    *carry                   = CONSTRAIN_HID_XY(total - report);
+    return report;
+}
+#    endif
+
 report_mouse_t pmw33xx_get_report(report_mouse_t mouse_report) {
     pmw33xx_report_t report    = pmw33xx_read_burst(0);
     static bool      in_motion = false;
+#    ifdef POINTING_DEVICE_ACCUMULATE_MOTION
+    static mouse_xy_report_t carry_x = 0;
+    static mouse_xy_report_t carry_y = 0;
+#    endif
 
     if (report.motion.b.is_lifted) {
+#    ifdef POINTING_DEVICE_ACCUMULATE_MOTION
+        carry_x = carry_y = 0;
+#    endif
         return mouse_report;
     }
 
     if (!report.motion.b.is_motion) {
         in_motion = false;
+#    ifdef POINTING_DEVICE_ACCUMULATE_MOTION
+        // Motion that didn't fit in the last report still has to go out
+        mouse_report.x = pmw33xx_carry_xy(0, &carry_x);
+        mouse_report.y = pmw33xx_carry_xy(0, &carry_y);
+#    endif
         return mouse_report;
     }
 
@@ -343,8 +365,13 @@ report_mouse_t pmw33xx_get_report(report_mouse_t mouse_report) {
         pd_dprintf("PWM3360 (0): starting motion\n");
     }
 
+#    ifdef POINTING_DEVICE_ACCUMULATE_MOTION
+    mouse_report.x = pmw33xx_carry_xy(report.delta_x, &carry_x);
+    mouse_report.y = pmw33xx_carry_xy(report.delta_y, &carry_y);
+#    else
     mouse_report.x = CONSTRAIN_HID_XY(report.delta_x);
     mouse_report.y = CONSTRAIN_HID_XY(report.delta_y);
+#    endif
     return mouse_report;
 }
 
@@ -313,6 +313,21 @@ void autoshift_matrix_scan(void) {
     }
 }
 
+/** \brief Milliseconds until an in-progress auto shift times out
+ */
+uint32_t autoshift_next_deadline(void) {
+    if (!autoshift_flags.in_progress) {
+        return DEADLINE_NONE;
+    }
+    return deadline_remaining(TIMER_DIFF_16(timer_read(), autoshift_time),
+#    ifdef AUTO_SHIFT_TIMEOUT_PER_KEY
+                              get_autoshift_timeout(autoshift_lastkey, &autoshift_lastrecord)
+#    else
+                              autoshift_timeout
+#    endif
+    );
+}
+
 void autoshift_toggle(void) {
     autoshift_flags.enabled = !autoshift_flags.enabled;
     autoshift_flush_shift();
@@ -14,10 +14,12 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdlib.h>
 #include "print.h"
 #include "process_combo.h"
 #include "action_tapping.h"
 #include "action.h"
+#include "deadline.h"
 
 #ifdef COMBO_COUNT
 __attribute__((weak)) combo_t key_combos[COMBO_COUNT];
@@ -191,14 +193,31 @@ static inline uint16_t _get_combo_term(uint16_t combo_index, combo_t *combo) {
     return COMBO_TERM;
 }
 
+#ifdef COMBO_KEY_INDEX_SIZE
+// Whether any combo may have state left to reset, so clear_combos() can skip the full walk
+static bool combo_states_dirty = true;
+#endif
+
 void clear_combos(void) {
     uint16_t index = 0;
     longest_term   = 0;
+#ifdef COMBO_KEY_INDEX_SIZE
+    if (!combo_states_dirty) {
+        return;
+    }
+    combo_states_dirty = false;
+#endif
     for (index = 0; index < COMBO_LEN; ++index) {
         combo_t *combo = &key_combos[index];
         if (!COMBO_ACTIVE(combo)) {
             RESET_COMBO_STATE(combo);
         }
+#ifdef COMBO_KEY_INDEX_SIZE
+        else {
+            // still has to be reset once released
+            combo_states_dirty = true;
+        }
+#endif
     }
 }
 
@@ -278,6 +297,83 @@ static inline void _find_key_index_and_count(const uint16_t *keys, uint16_t keyc
     }
 }
 
+#ifdef COMBO_KEY_INDEX_SIZE
+/* Index of (keycode, combo) pairs sorted by keycode, so that a key event only
+ * has to visit the combos the keycode is actually part of. */
+typedef struct {
+    uint16_t keycode;
+    uint16_t combo_index;
+} combo_key_index_t;
+
+static combo_key_index_t combo_key_index[COMBO_KEY_INDEX_SIZE];
+static uint16_t          combo_key_index_length = 0;
+static bool              combo_key_index_built  = false;
+static bool              combo_key_index_valid  = false;
+
+static int combo_key_index_compare(const void *a, const void *b) {
+    const combo_key_index_t *entry_a = a;
+    const combo_key_index_t *entry_b = b;
+
+    if (entry_a->keycode != entry_b->keycode) {
+        return entry_a->keycode < entry_b->keycode ? -1 : 1;
+    }
+    return (int)entry_a->combo_index - (int)entry_b->combo_index;
+}
+
+static void build_combo_key_index(void) {
+    combo_key_index_built  = true;
+    combo_key_index_valid  = false;
+    combo_key_index_length = 0;
+
+    for (uint16_t idx = 0; idx < COMBO_LEN; ++idx) {
+        const uint16_t *keys = key_combos[idx].keys;
+        uint16_t        key;
+
+        for (uint8_t key_i = 0; (key = pgm_read_word(&keys[key_i])) != COMBO_END; key_i++) {
+            if (combo_key_index_length == COMBO_KEY_INDEX_SIZE) {
+                dprintln("combo: COMBO_KEY_INDEX_SIZE is too small, falling back to scanning all combos");
+                return;
+            }
+            combo_key_index[combo_key_index_length++] = (combo_key_index_t){
+                .keycode     = key,
+                .combo_index = idx,
+            };
+        }
+    }
+
+    qsort(combo_key_index, combo_key_index_length, sizeof(combo_key_index_t), combo_key_index_compare);
+
+    // A key listed twice in the same combo must only be processed once
+    uint16_t length = 0;
+    for (uint16_t i = 0; i < combo_key_index_length; i++) {
+        if (length && combo_key_index[length - 1].keycode == combo_key_index[i].keycode && combo_key_index[length - 1].combo_index == combo_key_index[i].combo_index) {
+            continue;
+        }
+        combo_key_index[length++] = combo_key_index[i];
+    }
+    combo_key_index_length = length;
+    combo_key_index_valid  = true;
+}
+
+/* Returns the position of the first entry for keycode, or where it would be. */
+static uint16_t combo_key_index_find(uint16_t keycode) {
+    uint16_t low = 0, high = combo_key_index_length;
+    while (low < high) {
+        uint16_t mid = low + (high - low) / 2;
+        if (combo_key_index[mid].keycode < keycode) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+void combo_key_index_invalidate(void) {
+    combo_key_index_built = false;
+}
+#endif
+
 void drop_combo_from_buffer(uint16_t combo_index) {
     /* Mark a combo as processed from the buffer. If the buffer is in the
      * beginning of the buffer, drop it.  */
@@ -423,6 +519,10 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
         return false;
     }
 
+#ifdef COMBO_KEY_INDEX_SIZE
+    combo_states_dirty = true;
+#endif
+
     bool key_is_part_of_combo = (!COMBO_DISABLED(combo) && is_combo_enabled()
 #if defined(COMBO_MUST_PRESS_IN_ORDER) || defined(COMBO_MUST_PRESS_IN_ORDER_PER_COMBO)
                                  && keys_pressed_in_order(combo_index, combo, key_index, keycode, record)
@@ -563,10 +663,25 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
     }
 #endif
 
-    for (uint16_t idx = 0; idx < COMBO_LEN; ++idx) {
-        combo_t *combo = &key_combos[idx];
-        is_combo_key |= process_single_combo(combo, keycode, record, idx);
-        no_combo_keys_pressed = no_combo_keys_pressed && (NO_COMBO_KEYS_ARE_DOWN || COMBO_ACTIVE(combo) || COMBO_DISABLED(combo));
+#ifdef COMBO_KEY_INDEX_SIZE
+    if (!combo_key_index_built) {
+        build_combo_key_index();
+    }
+
+    if (combo_key_index_valid) {
+        // Combos that don't contain the keycode are left untouched by process_single_combo()
+        for (uint16_t i = combo_key_index_find(keycode); i < combo_key_index_length && combo_key_index[i].keycode == keycode; i++) {
+            uint16_t idx = combo_key_index[i].combo_index;
+            is_combo_key |= process_single_combo(&key_combos[idx], keycode, record, idx);
+        }
+    } else
+#endif
+    {
+        for (uint16_t idx = 0; idx < COMBO_LEN; ++idx) {
+            combo_t *combo = &key_combos[idx];
+            is_combo_key |= process_single_combo(combo, keycode, record, idx);
+            no_combo_keys_pressed = no_combo_keys_pressed && (NO_COMBO_KEYS_ARE_DOWN || COMBO_ACTIVE(combo) || COMBO_DISABLED(combo));
+        }
     }
 
     if (record->event.pressed && is_combo_key) {
@@ -624,6 +739,15 @@ void combo_task(void) {
 #endif
 }
 
+uint32_t combo_next_deadline(void) {
+#ifndef COMBO_NO_TIMER
+    if (b_combo_enable && timer) {
+        return deadline_remaining(timer_elapsed(timer), longest_term + 1);
+    }
+#endif
+    return DEADLINE_NONE;
+}
+
 void combo_enable(void) {
     b_combo_enable = true;
 }
@@ -73,8 +73,13 @@ typedef struct {
 
 bool process_combo(uint16_t keycode, keyrecord_t *record);
 void combo_task(void);
+uint32_t combo_next_deadline(void);
 void process_combo_event(uint16_t combo_index, bool pressed);
 
+#ifdef COMBO_KEY_INDEX_SIZE
+void combo_key_index_invalidate(void);
+#endif
+
 void combo_enable(void);
 void combo_disable(void);
 void combo_toggle(void);
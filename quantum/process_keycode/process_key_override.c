@@ -396,6 +396,14 @@ void key_override_task(void) {
     }
 }
 
+uint32_t key_override_next_deadline(void) {
+    if (deferred_register == 0) {
+        return DEADLINE_NONE;
+    }
+
+    return deadline_remaining(timer_elapsed32(defer_reference_time), defer_delay);
+}
+
 bool process_key_override(const uint16_t keycode, const keyrecord_t *const record) {
 #ifdef BENCH_KEY_OVERRIDE
     uint16_t start = timer_read();
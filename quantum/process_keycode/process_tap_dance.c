@@ -173,6 +173,13 @@ void tap_dance_task(void) {
     }
 }
 
+uint32_t tap_dance_next_deadline(void) {
+    if (!active_td) return DEADLINE_NONE;
+
+    // The dance finishes once strictly more than the tapping term has elapsed
+    return deadline_remaining(timer_elapsed(last_tap_time), GET_TAPPING_TERM(active_td, &(keyrecord_t){}) + 1);
+}
+
 void reset_tap_dance(tap_dance_state_t *state) {
     active_td = 0;
     process_tap_dance_action_on_reset((tap_dance_action_t *)state);
@@ -49,6 +49,7 @@
 #include "action_tapping.h"
 #include "print.h"
 #include "suspend.h"
+#include "deadline.h"
 #include <stddef.h>
 #include <stdlib.h>
 
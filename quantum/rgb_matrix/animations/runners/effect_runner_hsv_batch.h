@@ -0,0 +1,30 @@
+#pragma once
+
+#ifdef RGB_MATRIX_HSV_BATCH
+
+// Colors produced by a runner, converted to RGB together once the buffer fills up
+static struct {
+    uint8_t count;
+    uint8_t led[RGB_MATRIX_HSV_BATCH_SIZE];
+    HSV     hsv[RGB_MATRIX_HSV_BATCH_SIZE];
+} hsv_batch;
+
+static void hsv_batch_flush(void) {
+    RGB rgb[RGB_MATRIX_HSV_BATCH_SIZE];
+
+    rgb_matrix_hsv_to_rgb_batch(hsv_batch.hsv, rgb, hsv_batch.count);
+    for (uint8_t j = 0; j < hsv_batch.count; j++) {
+        rgb_matrix_set_color(hsv_batch.led[j], rgb[j].r, rgb[j].g, rgb[j].b);
+    }
+    hsv_batch.count = 0;
+}
+
+static inline void hsv_batch_add(uint8_t i, HSV hsv) {
+    hsv_batch.led[hsv_batch.count] = i;
+    hsv_batch.hsv[hsv_batch.count] = hsv;
+    if (++hsv_batch.count == RGB_MATRIX_HSV_BATCH_SIZE) {
+        hsv_batch_flush();
+    }
+}
+
+#endif
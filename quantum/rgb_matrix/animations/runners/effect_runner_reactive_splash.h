@@ -26,4 +26,70 @@ bool effect_runner_reactive_splash(uint8_t start, effect_params_t* params, react
     return rgb_matrix_check_finished_leds(led_max);
 }
 
+// Returns how far from a hit effect_func can still light an LED, or -1 if the hit has faded out
+typedef int16_t (*reactive_splash_radius_f)(uint16_t tick);
+
+// Like effect_runner_reactive_splash(), but effect_func is only called for LEDs within the radius of each hit
+bool effect_runner_reactive_splash_radius(uint8_t start, effect_params_t* params, reactive_splash_f effect_func, reactive_splash_radius_f radius_func) {
+    RGB_MATRIX_USE_LIMITS(led_min, led_max);
+
+    uint8_t  count = g_last_hit_tracker.count;
+    uint16_t tick[LED_HITS_TO_REMEMBER];
+    int16_t  radius[LED_HITS_TO_REMEMBER];
+    for (uint8_t j = start; j < count; j++) {
+        tick[j]   = scale16by8(g_last_hit_tracker.tick[j], qadd8(rgb_matrix_config.speed, 1));
+        radius[j] = radius_func(tick[j]);
+    }
+
+#    ifdef RGB_MATRIX_REACTIVE_GRID
+    static HSV hsv[RGB_MATRIX_LED_COUNT];
+    for (uint8_t i = led_min; i < led_max; i++) {
+        hsv[i]   = rgb_matrix_config.hsv;
+        hsv[i].v = 0;
+    }
+
+    // Visit only the LEDs around each hit, in the same order as the LED by LED loop
+    for (uint8_t j = start; j < count; j++) {
+        if (radius[j] < 0) continue;
+        uint8_t leds[RGB_MATRIX_LED_COUNT];
+        uint8_t found = rgb_matrix_grid_query(g_last_hit_tracker.x[j], g_last_hit_tracker.y[j], radius[j], leds);
+        for (uint8_t k = 0; k < found; k++) {
+            uint8_t i = leds[k];
+            if (i < led_min || i >= led_max) continue;
+            int16_t dx   = g_led_config.point[i].x - g_last_hit_tracker.x[j];
+            int16_t dy   = g_led_config.point[i].y - g_last_hit_tracker.y[j];
+            uint8_t dist = sqrt16(dx * dx + dy * dy);
+            if (dist > radius[j]) continue;
+            hsv[i] = effect_func(hsv[i], dx, dy, dist, tick[j]);
+        }
+    }
+
+    for (uint8_t i = led_min; i < led_max; i++) {
+        RGB_MATRIX_TEST_LED_FLAGS();
+        hsv[i].v = scale8(hsv[i].v, rgb_matrix_config.hsv.v);
+        RGB rgb  = rgb_matrix_hsv_to_rgb(hsv[i]);
+        rgb_matrix_set_color(i, rgb.r, rgb.g, rgb.b);
+    }
+#    else
+    for (uint8_t i = led_min; i < led_max; i++) {
+        RGB_MATRIX_TEST_LED_FLAGS();
+        HSV hsv = rgb_matrix_config.hsv;
+        hsv.v   = 0;
+        for (uint8_t j = start; j < count; j++) {
+            int16_t dx = g_led_config.point[i].x - g_last_hit_tracker.x[j];
+            int16_t dy = g_led_config.point[i].y - g_last_hit_tracker.y[j];
+            // Reject on the bounding square before paying for the square root
+            if (dx > radius[j] || -dx > radius[j] || dy > radius[j] || -dy > radius[j]) continue;
+            uint8_t dist = sqrt16(dx * dx + dy * dy);
+            if (dist > radius[j]) continue;
+            hsv = effect_func(hsv, dx, dy, dist, tick[j]);
+        }
+        hsv.v   = scale8(hsv.v, rgb_matrix_config.hsv.v);
+        RGB rgb = rgb_matrix_hsv_to_rgb(hsv);
+        rgb_matrix_set_color(i, rgb.r, rgb.g, rgb.b);
+    }
+#    endif
+    return rgb_matrix_check_finished_leds(led_max);
+}
+
 #endif // RGB_MATRIX_KEYREACTIVE_ENABLED
@@ -26,15 +26,21 @@ static HSV SOLID_REACTIVE_CROSS_math(HSV hsv, int16_t dx, int16_t dy, uint8_t di
     return hsv;
 }
 
+// Lit at most while tick + dist < 255, the cross narrows it further
+static int16_t SOLID_REACTIVE_CROSS_radius(uint16_t tick) {
+    if (tick >= 255) return -1;
+    return 254 - tick;
+}
+
 #            ifdef ENABLE_RGB_MATRIX_SOLID_REACTIVE_CROSS
 bool SOLID_REACTIVE_CROSS(effect_params_t* params) {
-    return effect_runner_reactive_splash(qsub8(g_last_hit_tracker.count, 1), params, &SOLID_REACTIVE_CROSS_math);
+    return effect_runner_reactive_splash_radius(qsub8(g_last_hit_tracker.count, 1), params, &SOLID_REACTIVE_CROSS_math, &SOLID_REACTIVE_CROSS_radius);
 }
 #            endif
 
 #            ifdef ENABLE_RGB_MATRIX_SOLID_REACTIVE_MULTICROSS
 bool SOLID_REACTIVE_MULTICROSS(effect_params_t* params) {
-    return effect_runner_reactive_splash(0, params, &SOLID_REACTIVE_CROSS_math);
+    return effect_runner_reactive_splash_radius(0, params, &SOLID_REACTIVE_CROSS_math, &SOLID_REACTIVE_CROSS_radius);
 }
 #            endif
 
@@ -26,13 +26,20 @@ static HSV SOLID_REACTIVE_NEXUS_math(HSV hsv, int16_t dx, int16_t dy, uint8_t di
 }
 
 #            ifdef ENABLE_RGB_MATRIX_SOLID_REACTIVE_NEXUS
+// Lit while dist <= tick < dist + 255, up to 72 away, LEDs out of reach stay dark whatever their hue
+static int16_t SOLID_REACTIVE_NEXUS_radius(uint16_t tick) {
+    if (tick >= 255 + 72) return -1;
+    return tick < 72 ? tick : 72;
+}
+
 bool SOLID_REACTIVE_NEXUS(effect_params_t* params) {
-    return effect_runner_reactive_splash(qsub8(g_last_hit_tracker.count, 1), params, &SOLID_REACTIVE_NEXUS_math);
+    return effect_runner_reactive_splash_radius(qsub8(g_last_hit_tracker.count, 1), params, &SOLID_REACTIVE_NEXUS_math, &SOLID_REACTIVE_NEXUS_radius);
 }
 #            endif
 
 #            ifdef ENABLE_RGB_MATRIX_SOLID_REACTIVE_MULTINEXUS
 bool SOLID_REACTIVE_MULTINEXUS(effect_params_t* params) {
+    // Every hit sets the hue of every LED, near or not, and the last one wins
     return effect_runner_reactive_splash(0, params, &SOLID_REACTIVE_NEXUS_math);
 }
 #            endif
@@ -21,15 +21,21 @@ static HSV SOLID_REACTIVE_WIDE_math(HSV hsv, int16_t dx, int16_t dy, uint8_t dis
     return hsv;
 }
 
+// Lit while tick + dist * 5 < 255
+static int16_t SOLID_REACTIVE_WIDE_radius(uint16_t tick) {
+    if (tick >= 255) return -1;
+    return (254 - tick) / 5;
+}
+
 #            ifdef ENABLE_RGB_MATRIX_SOLID_REACTIVE_WIDE
 bool SOLID_REACTIVE_WIDE(effect_params_t* params) {
-    return effect_runner_reactive_splash(qsub8(g_last_hit_tracker.count, 1), params, &SOLID_REACTIVE_WIDE_math);
+    return effect_runner_reactive_splash_radius(qsub8(g_last_hit_tracker.count, 1), params, &SOLID_REACTIVE_WIDE_math, &SOLID_REACTIVE_WIDE_radius);
 }
 #            endif
 
 #            ifdef ENABLE_RGB_MATRIX_SOLID_REACTIVE_MULTIWIDE
 bool SOLID_REACTIVE_MULTIWIDE(effect_params_t* params) {
-    return effect_runner_reactive_splash(0, params, &SOLID_REACTIVE_WIDE_math);
+    return effect_runner_reactive_splash_radius(0, params, &SOLID_REACTIVE_WIDE_math, &SOLID_REACTIVE_WIDE_radius);
 }
 #            endif
 
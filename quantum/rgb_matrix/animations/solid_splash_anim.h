@@ -18,15 +18,21 @@ HSV SOLID_SPLASH_math(HSV hsv, int16_t dx, int16_t dy, uint8_t dist, uint16_t ti
     return hsv;
 }
 
+// Lit while dist <= tick < dist + 255
+static int16_t SOLID_SPLASH_radius(uint16_t tick) {
+    if (tick >= 255 * 2) return -1;
+    return tick < 255 ? tick : 255;
+}
+
 #            ifdef ENABLE_RGB_MATRIX_SOLID_SPLASH
 bool SOLID_SPLASH(effect_params_t* params) {
-    return effect_runner_reactive_splash(qsub8(g_last_hit_tracker.count, 1), params, &SOLID_SPLASH_math);
+    return effect_runner_reactive_splash_radius(qsub8(g_last_hit_tracker.count, 1), params, &SOLID_SPLASH_math, &SOLID_SPLASH_radius);
 }
 #            endif
 
 #            ifdef ENABLE_RGB_MATRIX_SOLID_MULTISPLASH
 bool SOLID_MULTISPLASH(effect_params_t* params) {
-    return effect_runner_reactive_splash(0, params, &SOLID_SPLASH_math);
+    return effect_runner_reactive_splash_radius(0, params, &SOLID_SPLASH_math, &SOLID_SPLASH_radius);
 }
 #            endif
 
@@ -20,13 +20,20 @@ HSV SPLASH_math(HSV hsv, int16_t dx, int16_t dy, uint8_t dist, uint16_t tick) {
 }
 
 #            ifdef ENABLE_RGB_MATRIX_SPLASH
+// Lit while dist <= tick < dist + 255, LEDs out of reach stay dark whatever their hue
+static int16_t SPLASH_radius(uint16_t tick) {
+    if (tick >= 255 * 2) return -1;
+    return tick < 255 ? tick : 255;
+}
+
 bool SPLASH(effect_params_t* params) {
-    return effect_runner_reactive_splash(qsub8(g_last_hit_tracker.count, 1), params, &SPLASH_math);
+    return effect_runner_reactive_splash_radius(qsub8(g_last_hit_tracker.count, 1), params, &SPLASH_math, &SPLASH_radius);
 }
 #            endif
 
 #            ifdef ENABLE_RGB_MATRIX_MULTISPLASH
 bool MULTISPLASH(effect_params_t* params) {
+    // Every hit changes the hue of every LED, near or not, so there is nothing to skip
     return effect_runner_reactive_splash(0, params, &SPLASH_math);
 }
 #            endif
@@ -24,15 +24,46 @@
 
 #include <lib/lib8tion/lib8tion.h>
 
+#if defined(RGB_MATRIX_KEYREACTIVE_ENABLED) && defined(RGB_MATRIX_REACTIVE_GRID)
+#    include "rgb_matrix_grid.h"
+#endif
+
+#ifdef RGB_MATRIX_FLUSH_ASYNC
+#    include <ch.h>
+#endif
+
+#ifdef RGB_MATRIX_ADAPTIVE_PACING
+#    include "latency_timer.h"
+#endif
+
 #ifndef RGB_MATRIX_CENTER
 const led_point_t k_rgb_matrix_center = {112, 32};
 #else
 const led_point_t k_rgb_matrix_center = RGB_MATRIX_CENTER;
 #endif
 
+#ifdef RGB_MATRIX_HSV_BATCH
+static RGB rgb_matrix_hsv_to_rgb_default(HSV hsv) {
+    return hsv_to_rgb(hsv);
+}
+
+// A weak alias rather than a weak definition, so the batch conversion below can tell whether it has been overridden
+RGB rgb_matrix_hsv_to_rgb(HSV hsv) __attribute__((weak, alias("rgb_matrix_hsv_to_rgb_default")));
+
+__attribute__((weak)) void rgb_matrix_hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count) {
+    if (rgb_matrix_hsv_to_rgb == rgb_matrix_hsv_to_rgb_default) {
+        hsv_to_rgb_batch(hsv, rgb, count);
+        return;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        rgb[i] = rgb_matrix_hsv_to_rgb(hsv[i]);
+    }
+}
+#else
 __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) {
     return hsv_to_rgb(hsv);
 }
+#endif
 
 // Generic effect runners
 #include "rgb_matrix_runners.inc"
@@ -136,6 +167,161 @@ static last_hit_t last_hit_buffer;
 const uint8_t k_rgb_matrix_split[2] = RGB_MATRIX_SPLIT;
 #endif
 
+#ifdef RGB_MATRIX_COMPOSITOR
+// The effect and each overlay draw into their own layer, and the layers are
+// blended into a frame when it is flushed. Overlays are only redrawn when their
+// inputs change, and only LEDs which differ from the last frame reach the driver.
+typedef struct {
+    bool     valid;
+    uint32_t inputs;    // rgb_overlay_default_inputs() when last drawn
+    uint32_t inputs_kb; // rgb_matrix_overlay_inputs_kb() when last drawn
+    uint8_t  alpha;
+    uint8_t  mask[(RGB_MATRIX_LED_COUNT + 7) / 8]; // LEDs the overlay has drawn
+    RGB      color[RGB_MATRIX_LED_COUNT];
+} rgb_overlay_t;
+
+static RGB            rgb_effect_layer[RGB_MATRIX_LED_COUNT];
+static RGB            rgb_last_frame[RGB_MATRIX_LED_COUNT];
+static bool           rgb_last_frame_valid = false;
+static rgb_overlay_t  rgb_overlays[RGB_MATRIX_OVERLAY_COUNT];
+static rgb_overlay_t *rgb_drawing_overlay = NULL; // where rgb_matrix_set_color() draws, the effect layer if NULL
+#endif // RGB_MATRIX_COMPOSITOR
+
+#ifdef RGB_MATRIX_FLUSH_ASYNC
+// The flush runs on its own thread, which sleeps while the I2C/SPI DMA transfers
+// are in flight so matrix scanning carries on. Colors are drawn into a back
+// buffer (the compositor layers, if enabled) and only copied into the driver's
+// PWM buffers when a frame is handed over. Whoever holds rgb_flush_idle owns the
+// driver buffers: the flush thread while it is sending them, the main loop
+// while it copies the next frame in.
+static THD_WORKING_AREA(rgb_flush_thread_wa, RGB_MATRIX_FLUSH_ASYNC_STACK_SIZE);
+static binary_semaphore_t rgb_flush_request;
+static binary_semaphore_t rgb_flush_idle;
+#    ifndef RGB_MATRIX_COMPOSITOR
+static RGB rgb_back_buffer[RGB_MATRIX_LED_COUNT];
+#    endif
+
+static THD_FUNCTION(rgb_flush_thread, arg) {
+    (void)arg;
+    chRegSetThreadName("rgb_flush");
+    while (true) {
+        chBSemWait(&rgb_flush_request);
+        rgb_matrix_driver.flush();
+        chBSemSignal(&rgb_flush_idle);
+    }
+}
+
+// Takes ownership of the driver buffers, returns false if a frame is still being sent and wait is false
+static bool rgb_flush_acquire(bool wait) {
+    return chBSemWaitTimeout(&rgb_flush_idle, wait ? TIME_INFINITE : TIME_IMMEDIATE) == MSG_OK;
+}
+
+static void rgb_flush_release(void) {
+    chBSemSignal(&rgb_flush_idle);
+}
+
+// Blocks until the frame in flight, if any, has been sent
+static void rgb_flush_wait(void) {
+    rgb_flush_acquire(true);
+    rgb_flush_release();
+}
+
+// Copies the back buffer into the driver buffers, which the caller must own
+static void rgb_flush_swap(void) {
+#    ifndef RGB_MATRIX_COMPOSITOR
+    for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+        rgb_matrix_driver.set_color(i, rgb_back_buffer[i].r, rgb_back_buffer[i].g, rgb_back_buffer[i].b);
+    }
+#    endif
+}
+#endif // RGB_MATRIX_FLUSH_ASYNC
+
+#ifdef RGB_MATRIX_ADAPTIVE_PACING
+uint8_t         g_rgb_matrix_led_process_limit = RGB_MATRIX_LED_PROCESS_LIMIT;
+static uint32_t rgb_render_cost[RGB_MATRIX_EFFECT_MAX]; // per LED in 1/8 ns, at least 1 once measured and 0 until then
+static uint16_t rgb_frame_interval = RGB_MATRIX_LED_FLUSH_LIMIT;
+static uint16_t rgb_render_max_us  = 0;
+#    if RGB_MATRIX_PACING_DEBUG_INTERVAL > 0
+static uint32_t rgb_pacing_debug_timer = 0;
+#    endif
+
+// Render cost per LED in ns, rounded but never below 1 once measured
+static uint16_t rgb_render_cost_ns(uint8_t effect) {
+    if (effect >= RGB_MATRIX_EFFECT_MAX || rgb_render_cost[effect] == 0) {
+        return 0;
+    }
+    return MAX((rgb_render_cost[effect] + 4) >> 3, 1);
+}
+
+// Splits the next frame into steps which fit the budget, and spaces frames out
+// so rendering takes at most RGB_MATRIX_RENDER_MAX_DUTY percent of the time.
+static void rgb_pacing_plan(uint8_t effect) {
+#    if RGB_MATRIX_PACING_DEBUG_INTERVAL > 0
+    if (debug_enable && timer_elapsed32(rgb_pacing_debug_timer) >= RGB_MATRIX_PACING_DEBUG_INTERVAL) {
+        rgb_pacing_debug_timer = timer_read32();
+        rgb_matrix_pacing_dump();
+    }
+#    endif
+
+    uint32_t cost = effect < RGB_MATRIX_EFFECT_MAX ? rgb_render_cost[effect] : 0;
+    if (cost == 0) {
+        g_rgb_matrix_led_process_limit = RGB_MATRIX_LED_PROCESS_LIMIT;
+        rgb_frame_interval             = RGB_MATRIX_LED_FLUSH_LIMIT;
+        return;
+    }
+
+    uint32_t limit = (uint32_t)RGB_MATRIX_RENDER_BUDGET_US * 1000 * 8 / cost;
+    if (limit < 1) limit = 1;
+    if (limit > RGB_MATRIX_LED_COUNT) limit = RGB_MATRIX_LED_COUNT;
+    g_rgb_matrix_led_process_limit = limit;
+
+    uint32_t interval = cost * RGB_MATRIX_LED_COUNT / (8 * 10000 * RGB_MATRIX_RENDER_MAX_DUTY);
+    if (interval < RGB_MATRIX_LED_FLUSH_LIMIT) interval = RGB_MATRIX_LED_FLUSH_LIMIT;
+    if (interval > UINT16_MAX) interval = UINT16_MAX;
+    rgb_frame_interval = interval;
+}
+
+static void rgb_pacing_measure(uint8_t effect, uint8_t iter, uint32_t elapsed_us) {
+    if (elapsed_us > rgb_render_max_us) {
+        rgb_render_max_us = elapsed_us > UINT16_MAX ? UINT16_MAX : elapsed_us;
+    }
+
+    // Init steps do extra work, and aren't representative of the effect
+    if (effect >= RGB_MATRIX_EFFECT_MAX || rgb_effect_params.init) {
+        return;
+    }
+
+    uint16_t first = (uint16_t)g_rgb_matrix_led_process_limit * iter;
+    if (first >= RGB_MATRIX_LED_COUNT) {
+        return;
+    }
+    uint16_t leds   = MIN(g_rgb_matrix_led_process_limit, RGB_MATRIX_LED_COUNT - first);
+    uint32_t sample = MIN(elapsed_us * 1000 / leds, UINT16_MAX);
+    uint32_t cost   = rgb_render_cost[effect];
+
+    // Moving average over roughly the last 8 steps, kept with 3 fractional bits so
+    // that steps shorter than the timer resolution still pull it down gradually
+    cost                    = cost ? cost - (cost >> 3) + sample : sample << 3;
+    rgb_render_cost[effect] = MAX(cost, 1);
+}
+
+rgb_matrix_pacing_t rgb_matrix_get_pacing(void) {
+    return (rgb_matrix_pacing_t){
+        .render_cost_ns    = rgb_render_cost_ns(rgb_matrix_config.mode),
+        .led_process_limit = g_rgb_matrix_led_process_limit,
+        .frame_interval    = rgb_frame_interval,
+        .render_max_us     = rgb_render_max_us,
+    };
+}
+
+void rgb_matrix_pacing_dump(void) {
+#    ifdef CONSOLE_ENABLE
+    xprintf("rgb matrix pacing: mode %u, %u ns/led, %u leds/step, %u ms/frame, max step %u us\n", rgb_matrix_config.mode, rgb_render_cost_ns(rgb_matrix_config.mode), g_rgb_matrix_led_process_limit, rgb_frame_interval, rgb_render_max_us);
+#    endif
+    rgb_render_max_us = 0;
+}
+#endif // RGB_MATRIX_ADAPTIVE_PACING
+
 EECONFIG_DEBOUNCE_HELPER(rgb_matrix, EECONFIG_RGB_MATRIX, rgb_matrix_config);
 
 void eeconfig_update_rgb_matrix(void) {
@@ -188,15 +374,37 @@ uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
 }
 
 void rgb_matrix_update_pwm_buffers(void) {
+#ifdef RGB_MATRIX_FLUSH_ASYNC
+    rgb_flush_acquire(true);
+    rgb_flush_swap();
+    rgb_matrix_driver.flush();
+    rgb_flush_release();
+#else
     rgb_matrix_driver.flush();
+#endif // RGB_MATRIX_FLUSH_ASYNC
 }
 
 void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+#ifdef RGB_MATRIX_COMPOSITOR
+    if (index < 0 || index >= RGB_MATRIX_LED_COUNT) return;
+    RGB *color = &rgb_effect_layer[index];
+    if (rgb_drawing_overlay) {
+        rgb_drawing_overlay->mask[index / 8] |= 1 << (index % 8);
+        color = &rgb_drawing_overlay->color[index];
+    }
+    color->r = red;
+    color->g = green;
+    color->b = blue;
+#elif defined(RGB_MATRIX_FLUSH_ASYNC)
+    if (index < 0 || index >= RGB_MATRIX_LED_COUNT) return;
+    rgb_back_buffer[index] = (RGB){.r = red, .g = green, .b = blue};
+#else
     rgb_matrix_driver.set_color(index, red, green, blue);
+#endif // RGB_MATRIX_COMPOSITOR
 }
 
 void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
-#if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
+#if defined(RGB_MATRIX_ENABLE) && (defined(RGB_MATRIX_SPLIT) || defined(RGB_MATRIX_COMPOSITOR) || defined(RGB_MATRIX_FLUSH_ASYNC))
     for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++)
         rgb_matrix_set_color(i, red, green, blue);
 #else
@@ -319,7 +527,11 @@ static void rgb_task_timers(void) {
 static void rgb_task_sync(void) {
     eeconfig_flush_rgb_matrix(false);
     // next task
+#ifdef RGB_MATRIX_ADAPTIVE_PACING
+    if (sync_timer_elapsed32(g_rgb_timer) >= rgb_frame_interval) rgb_task_state = STARTING;
+#else
     if (sync_timer_elapsed32(g_rgb_timer) >= RGB_MATRIX_LED_FLUSH_LIMIT) rgb_task_state = STARTING;
+#endif
 }
 
 static void rgb_task_start(void) {
@@ -396,13 +608,98 @@ static void rgb_task_render(uint8_t effect) {
     }
 }
 
+#ifdef RGB_MATRIX_COMPOSITOR
+static uint32_t rgb_overlay_default_inputs(uint8_t overlay) {
+    switch (overlay) {
+        case RGB_MATRIX_OVERLAY_INDICATORS:
+            return host_keyboard_led_state().raw;
+        case RGB_MATRIX_OVERLAY_LAYER:
+            return get_highest_layer(layer_state | default_layer_state);
+        case RGB_MATRIX_OVERLAY_CAPS_LOCK:
+#    ifdef CAPS_WORD_ENABLE
+            return host_keyboard_led_state().caps_lock | (is_caps_word_on() << 1);
+#    else
+            return host_keyboard_led_state().caps_lock;
+#    endif
+        default:
+            return 0;
+    }
+}
+
+static void rgb_overlays_update(void) {
+    for (uint8_t overlay = 0; overlay < RGB_MATRIX_OVERLAY_COUNT; overlay++) {
+        rgb_overlay_t *layer     = &rgb_overlays[overlay];
+        uint32_t       inputs    = rgb_overlay_default_inputs(overlay);
+        uint32_t       inputs_kb = rgb_matrix_overlay_inputs_kb(overlay);
+        if (layer->valid && layer->inputs == inputs && layer->inputs_kb == inputs_kb) continue;
+
+        layer->valid     = true;
+        layer->inputs    = inputs;
+        layer->inputs_kb = inputs_kb;
+        memset(layer->mask, 0, sizeof(layer->mask));
+        rgb_drawing_overlay = layer;
+        rgb_matrix_overlay_kb(overlay);
+        rgb_drawing_overlay = NULL;
+    }
+}
+
+// Blends the layers and hands the LEDs which changed to the driver, returns false if none did
+static bool rgb_compose(bool overlays) {
+    bool changed = false;
+    for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+        RGB color = rgb_effect_layer[i];
+        for (uint8_t overlay = 0; overlays && overlay < RGB_MATRIX_OVERLAY_COUNT; overlay++) {
+            rgb_overlay_t *layer = &rgb_overlays[overlay];
+            if (!(layer->mask[i / 8] & (1 << (i % 8)))) continue;
+            if (layer->alpha == UINT8_MAX) {
+                color = layer->color[i];
+            } else {
+                color.r = blend8(color.r, layer->color[i].r, layer->alpha);
+                color.g = blend8(color.g, layer->color[i].g, layer->alpha);
+                color.b = blend8(color.b, layer->color[i].b, layer->alpha);
+            }
+        }
+
+        RGB *last = &rgb_last_frame[i];
+        if (!rgb_last_frame_valid || color.r != last->r || color.g != last->g || color.b != last->b) {
+            *last = color;
+            rgb_matrix_driver.set_color(i, color.r, color.g, color.b);
+            changed = true;
+        }
+    }
+    rgb_last_frame_valid = true;
+    return changed;
+}
+#endif // RGB_MATRIX_COMPOSITOR
+
 static void rgb_task_flush(uint8_t effect) {
+#ifdef RGB_MATRIX_FLUSH_ASYNC
+    // The frame stays in the back buffer until the previous one has been sent
+    if (!rgb_flush_acquire(false)) return;
+#endif // RGB_MATRIX_FLUSH_ASYNC
+
     // update last trackers after the first full render so we can init over several frames
     rgb_last_effect = effect;
     rgb_last_enable = rgb_matrix_config.enable;
 
+#ifdef RGB_MATRIX_COMPOSITOR
+    // Identical frames are not sent again
+    if (!rgb_compose(effect != 0)) {
+#    ifdef RGB_MATRIX_FLUSH_ASYNC
+        rgb_flush_release();
+#    endif // RGB_MATRIX_FLUSH_ASYNC
+        rgb_task_state = SYNCING;
+        return;
+    }
+#endif // RGB_MATRIX_COMPOSITOR
+
     // update pwm buffers
+#ifdef RGB_MATRIX_FLUSH_ASYNC
+    rgb_flush_swap();
+    chBSemSignal(&rgb_flush_request);
+#else
     rgb_matrix_update_pwm_buffers();
+#endif // RGB_MATRIX_FLUSH_ASYNC
 
     // next task
     rgb_task_state = SYNCING;
@@ -423,16 +720,34 @@ void rgb_matrix_task(void) {
 
     switch (rgb_task_state) {
         case STARTING:
+#ifdef RGB_MATRIX_ADAPTIVE_PACING
+            rgb_pacing_plan(effect);
+#endif
+#ifdef RGB_MATRIX_COMPOSITOR
+            if (effect) rgb_overlays_update();
+#endif
             rgb_task_start();
             break;
-        case RENDERING:
+        case RENDERING: {
+#ifdef RGB_MATRIX_ADAPTIVE_PACING
+            latency_timer_t render_start = latency_timer_read();
+            uint8_t         render_iter  = rgb_effect_params.iter;
+#endif
             rgb_task_render(effect);
             if (effect) {
                 rgb_matrix_indicators();
                 rgb_matrix_indicators_advanced(&rgb_effect_params);
             }
+#ifdef RGB_MATRIX_ADAPTIVE_PACING
+            rgb_pacing_measure(effect, render_iter, latency_timer_elapsed_us(render_start));
+#endif
             break;
+        }
         case FLUSHING:
+#if defined(WS2812) && defined(WS2812_DOUBLE_BUFFER)
+            // Keep the frame until the strip can queue it, rather than waiting on it
+            if (!ws2812_ready()) break;
+#endif
             rgb_task_flush(effect);
             break;
         case SYNCING:
@@ -459,7 +774,13 @@ void rgb_matrix_indicators_advanced(effect_params_t *params) {
      * and not sure which would be better. Otherwise, this should be called from
      * rgb_task_render, right before the iter++ line.
      */
-#if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < RGB_MATRIX_LED_COUNT
+#if defined(RGB_MATRIX_ADAPTIVE_PACING)
+    // Same range the effect has just rendered with
+    uint16_t min = (uint16_t)g_rgb_matrix_led_process_limit * (params->iter - 1);
+    uint16_t max = min + g_rgb_matrix_led_process_limit;
+    if (min > RGB_MATRIX_LED_COUNT) min = RGB_MATRIX_LED_COUNT;
+    if (max > RGB_MATRIX_LED_COUNT) max = RGB_MATRIX_LED_COUNT;
+#elif defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < RGB_MATRIX_LED_COUNT
     uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * (params->iter - 1);
     uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;
     if (max > RGB_MATRIX_LED_COUNT) max = RGB_MATRIX_LED_COUNT;
@@ -478,9 +799,52 @@ __attribute__((weak)) bool rgb_matrix_indicators_advanced_user(uint8_t led_min,
     return true;
 }
 
+#ifdef RGB_MATRIX_COMPOSITOR
+__attribute__((weak)) bool rgb_matrix_overlay_kb(uint8_t overlay) {
+    return rgb_matrix_overlay_user(overlay);
+}
+
+__attribute__((weak)) bool rgb_matrix_overlay_user(uint8_t overlay) {
+    return true;
+}
+
+__attribute__((weak)) uint32_t rgb_matrix_overlay_inputs_kb(uint8_t overlay) {
+    return rgb_matrix_overlay_inputs_user(overlay);
+}
+
+__attribute__((weak)) uint32_t rgb_matrix_overlay_inputs_user(uint8_t overlay) {
+    return 0;
+}
+
+void rgb_matrix_overlay_invalidate(uint8_t overlay) {
+    if (overlay < RGB_MATRIX_OVERLAY_COUNT) {
+        rgb_overlays[overlay].valid = false;
+    }
+}
+
+void rgb_matrix_overlay_set_alpha(uint8_t overlay, uint8_t alpha) {
+    if (overlay < RGB_MATRIX_OVERLAY_COUNT) {
+        rgb_overlays[overlay].alpha = alpha;
+    }
+}
+#endif // RGB_MATRIX_COMPOSITOR
+
 void rgb_matrix_init(void) {
     rgb_matrix_driver.init();
 
+#ifdef RGB_MATRIX_COMPOSITOR
+    for (uint8_t overlay = 0; overlay < RGB_MATRIX_OVERLAY_COUNT; overlay++) {
+        rgb_overlays[overlay].alpha = UINT8_MAX;
+    }
+#endif // RGB_MATRIX_COMPOSITOR
+
+#ifdef RGB_MATRIX_FLUSH_ASYNC
+    // Above the main loop, which never yields, the thread only holds the CPU between transfers
+    chBSemObjectInit(&rgb_flush_request, true);
+    chBSemObjectInit(&rgb_flush_idle, false);
+    chThdCreateStatic(rgb_flush_thread_wa, sizeof(rgb_flush_thread_wa), NORMALPRIO + 1, rgb_flush_thread, NULL);
+#endif // RGB_MATRIX_FLUSH_ASYNC
+
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
     g_last_hit_tracker.count = 0;
     for (uint8_t i = 0; i < LED_HITS_TO_REMEMBER; ++i) {
@@ -491,6 +855,10 @@ void rgb_matrix_init(void) {
     for (uint8_t i = 0; i < LED_HITS_TO_REMEMBER; ++i) {
         last_hit_buffer.tick[i] = UINT16_MAX;
     }
+
+#    ifdef RGB_MATRIX_REACTIVE_GRID
+    rgb_matrix_grid_init(g_led_config.point, RGB_MATRIX_LED_COUNT);
+#    endif
 #endif // RGB_MATRIX_KEYREACTIVE_ENABLED
 
     if (!eeconfig_is_enabled()) {
@@ -510,8 +878,14 @@ void rgb_matrix_init(void) {
 void rgb_matrix_set_suspend_state(bool state) {
 #ifdef RGB_DISABLE_WHEN_USB_SUSPENDED
     if (state && !suspend_state) { // only run if turning off, and only once
-        rgb_task_render(0);        // turn off all LEDs when suspending
-        rgb_task_flush(0);         // and actually flash led state to LEDs
+        rgb_task_render(0); // turn off all LEDs when suspending
+#    ifdef RGB_MATRIX_FLUSH_ASYNC
+        rgb_flush_wait(); // let any frame in flight finish, so the blank one isn't held back
+        rgb_task_flush(0);
+        rgb_flush_wait(); // and make sure it has been sent before the host suspends us
+#    else
+        rgb_task_flush(0); // and actually flash led state to LEDs
+#    endif
     }
     suspend_state = state;
 #endif
@@ -46,11 +46,56 @@
 #    define RGB_MATRIX_LED_FLUSH_LIMIT 16
 #endif
 
+#ifdef RGB_MATRIX_FLUSH_ASYNC
+#    ifndef PROTOCOL_CHIBIOS
+#        error "RGB_MATRIX_FLUSH_ASYNC is only supported on ChibiOS"
+#    endif
+#    ifndef RGB_MATRIX_FLUSH_ASYNC_STACK_SIZE
+#        define RGB_MATRIX_FLUSH_ASYNC_STACK_SIZE 512
+#    endif
+#endif
+
+#if defined(RGB_MATRIX_HSV_BATCH) && !defined(RGB_MATRIX_HSV_BATCH_SIZE)
+#    define RGB_MATRIX_HSV_BATCH_SIZE 32
+#endif
+
 #ifndef RGB_MATRIX_LED_PROCESS_LIMIT
 #    define RGB_MATRIX_LED_PROCESS_LIMIT (RGB_MATRIX_LED_COUNT + 4) / 5
 #endif
 
-#if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < RGB_MATRIX_LED_COUNT
+#ifdef RGB_MATRIX_ADAPTIVE_PACING
+#    ifndef RGB_MATRIX_RENDER_BUDGET_US
+#        define RGB_MATRIX_RENDER_BUDGET_US 200
+#    endif
+#    ifndef RGB_MATRIX_RENDER_MAX_DUTY
+#        define RGB_MATRIX_RENDER_MAX_DUTY 25
+#    endif
+#    if RGB_MATRIX_RENDER_MAX_DUTY < 1 || RGB_MATRIX_RENDER_MAX_DUTY > 100
+#        error "RGB_MATRIX_RENDER_MAX_DUTY must be a percentage between 1 and 100"
+#    endif
+#    ifndef RGB_MATRIX_PACING_DEBUG_INTERVAL
+#        define RGB_MATRIX_PACING_DEBUG_INTERVAL 5000
+#    endif
+#endif
+
+#if defined(RGB_MATRIX_ADAPTIVE_PACING)
+// Chosen at the start of each frame from the measured render cost of the effect
+extern uint8_t g_rgb_matrix_led_process_limit;
+#    if defined(RGB_MATRIX_SPLIT)
+#        define RGB_MATRIX_USE_LIMITS(min, max)                                                   \
+            uint8_t min = g_rgb_matrix_led_process_limit * params->iter;                          \
+            uint8_t max = min + g_rgb_matrix_led_process_limit;                                   \
+            if (max > RGB_MATRIX_LED_COUNT) max = RGB_MATRIX_LED_COUNT;                           \
+            uint8_t k_rgb_matrix_split[2] = RGB_MATRIX_SPLIT;                                     \
+            if (is_keyboard_left() && (max > k_rgb_matrix_split[0])) max = k_rgb_matrix_split[0]; \
+            if (!(is_keyboard_left()) && (min < k_rgb_matrix_split[0])) min = k_rgb_matrix_split[0];
+#    else
+#        define RGB_MATRIX_USE_LIMITS(min, max)                          \
+            uint8_t min = g_rgb_matrix_led_process_limit * params->iter; \
+            uint8_t max = min + g_rgb_matrix_led_process_limit;          \
+            if (max > RGB_MATRIX_LED_COUNT) max = RGB_MATRIX_LED_COUNT;
+#    endif
+#elif defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < RGB_MATRIX_LED_COUNT
 #    if defined(RGB_MATRIX_SPLIT)
 #        define RGB_MATRIX_USE_LIMITS(min, max)                                                   \
             uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * params->iter;                            \
@@ -126,6 +171,24 @@ void process_rgb_matrix(uint8_t row, uint8_t col, bool pressed);
 
 void rgb_matrix_task(void);
 
+#ifdef RGB_MATRIX_ADAPTIVE_PACING
+typedef struct rgb_matrix_pacing_t {
+    uint16_t render_cost_ns;    // measured render time per LED of the current effect
+    uint8_t  led_process_limit; // LEDs rendered per task run
+    uint16_t frame_interval;    // milliseconds between frames
+    uint16_t render_max_us;     // longest single render step
+} rgb_matrix_pacing_t;
+
+/** \brief Current pacing of the RGB Matrix task */
+rgb_matrix_pacing_t rgb_matrix_get_pacing(void);
+
+/** \brief Print the pacing to the console, and restart the render_max_us measurement
+ *
+ * Also called every RGB_MATRIX_PACING_DEBUG_INTERVAL milliseconds while debug is enabled.
+ */
+void rgb_matrix_pacing_dump(void);
+#endif
+
 // This runs after another backlight effect and replaces
 // colors already set
 void rgb_matrix_indicators(void);
@@ -136,6 +199,31 @@ void rgb_matrix_indicators_advanced(effect_params_t *params);
 bool rgb_matrix_indicators_advanced_kb(uint8_t led_min, uint8_t led_max);
 bool rgb_matrix_indicators_advanced_user(uint8_t led_min, uint8_t led_max);
 
+#ifdef RGB_MATRIX_COMPOSITOR
+// Overlays drawn over the effect, from bottom to top
+enum rgb_matrix_overlays {
+    RGB_MATRIX_OVERLAY_INDICATORS,
+    RGB_MATRIX_OVERLAY_LAYER,
+    RGB_MATRIX_OVERLAY_CAPS_LOCK,
+    RGB_MATRIX_OVERLAY_USER,
+    RGB_MATRIX_OVERLAY_COUNT,
+};
+
+// Draws an overlay with rgb_matrix_set_color(), only called when its inputs change
+bool rgb_matrix_overlay_kb(uint8_t overlay);
+bool rgb_matrix_overlay_user(uint8_t overlay);
+
+// Summarises the state an overlay is drawn from, it is redrawn when the value changes
+uint32_t rgb_matrix_overlay_inputs_kb(uint8_t overlay);
+uint32_t rgb_matrix_overlay_inputs_user(uint8_t overlay);
+
+/** \brief Redraw an overlay at the start of the next frame */
+void rgb_matrix_overlay_invalidate(uint8_t overlay);
+
+/** \brief Opacity of an overlay over the layers below it, 255 (the default) replaces them */
+void rgb_matrix_overlay_set_alpha(uint8_t overlay, uint8_t alpha);
+#endif
+
 void rgb_matrix_init(void);
 
 void rgb_matrix_reload_from_eeprom(void);
@@ -0,0 +1,59 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "rgb_matrix_grid.h"
+
+#define GRID_CELLS (RGB_MATRIX_GRID_SIZE * RGB_MATRIX_GRID_SIZE)
+#define GRID_CELL(x, y) (((y) >> RGB_MATRIX_GRID_SHIFT) * RGB_MATRIX_GRID_SIZE + ((x) >> RGB_MATRIX_GRID_SHIFT))
+
+static const led_point_t *grid_points;
+
+// LED indexes sorted by cell, the LEDs of cell c are grid_leds[grid_start[c]] to grid_leds[grid_start[c + 1] - 1]
+static uint8_t grid_leds[RGB_MATRIX_LED_COUNT];
+static uint8_t grid_start[GRID_CELLS + 1];
+
+void rgb_matrix_grid_init(const led_point_t *points, uint8_t led_count) {
+    grid_points = points;
+
+    // Counting sort: count the LEDs in each cell, and turn the counts into the start of each cell
+    for (uint16_t c = 0; c <= GRID_CELLS; c++) {
+        grid_start[c] = 0;
+    }
+    for (uint8_t i = 0; i < led_count; i++) {
+        grid_start[GRID_CELL(points[i].x, points[i].y) + 1]++;
+    }
+    for (uint16_t c = 1; c <= GRID_CELLS; c++) {
+        grid_start[c] += grid_start[c - 1];
+    }
+
+    // Placing each LED advances the start of its cell to the start of the next one
+    for (uint8_t i = 0; i < led_count; i++) {
+        grid_leds[grid_start[GRID_CELL(points[i].x, points[i].y)]++] = i;
+    }
+    for (uint16_t c = GRID_CELLS; c > 0; c--) {
+        grid_start[c] = grid_start[c - 1];
+    }
+    grid_start[0] = 0;
+}
+
+uint8_t rgb_matrix_grid_query(uint8_t x, uint8_t y, uint8_t radius, uint8_t *leds) {
+    uint8_t x_min = x > radius ? x - radius : 0;
+    uint8_t x_max = x < 255 - radius ? x + radius : 255;
+    uint8_t y_min = y > radius ? y - radius : 0;
+    uint8_t y_max = y < 255 - radius ? y + radius : 255;
+    uint8_t count = 0;
+
+    for (uint8_t row = y_min >> RGB_MATRIX_GRID_SHIFT; row <= y_max >> RGB_MATRIX_GRID_SHIFT; row++) {
+        // The cells of a row are stored one after the other
+        uint8_t first = grid_start[row * RGB_MATRIX_GRID_SIZE + (x_min >> RGB_MATRIX_GRID_SHIFT)];
+        uint8_t last  = grid_start[row * RGB_MATRIX_GRID_SIZE + (x_max >> RGB_MATRIX_GRID_SHIFT) + 1];
+        for (uint8_t k = first; k < last; k++) {
+            uint8_t           i     = grid_leds[k];
+            const led_point_t point = grid_points[i];
+            if (point.x >= x_min && point.x <= x_max && point.y >= y_min && point.y <= y_max) {
+                leds[count++] = i;
+            }
+        }
+    }
+    return count;
+}
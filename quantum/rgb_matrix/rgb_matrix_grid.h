@@ -0,0 +1,23 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+#include "rgb_matrix_types.h"
+
+/*
+ * Spatial index of the LED positions, for effects which only light LEDs
+ * near a point. The 256x256 LED coordinate space is split into square cells
+ * and the LEDs are sorted by cell, so the LEDs around a point can be found
+ * without visiting every LED.
+ */
+
+// Cells are 1 << RGB_MATRIX_GRID_SHIFT units wide
+#define RGB_MATRIX_GRID_SHIFT 5
+#define RGB_MATRIX_GRID_SIZE (256 >> RGB_MATRIX_GRID_SHIFT)
+
+void rgb_matrix_grid_init(const led_point_t *points, uint8_t led_count);
+
+/* Writes the LEDs within radius units of (x, y) on both axes to leds, and returns how many were found. */
+uint8_t rgb_matrix_grid_query(uint8_t x, uint8_t y, uint8_t radius, uint8_t *leds);
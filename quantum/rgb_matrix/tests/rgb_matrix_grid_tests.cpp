@@ -0,0 +1,66 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <vector>
+
+extern "C" {
+#include "rgb_matrix_grid.h"
+}
+
+namespace {
+
+uint32_t next_random(uint32_t &state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+} // namespace
+
+TEST(RgbMatrixGrid, QueryMatchesBoundingSquare) {
+    std::vector<led_point_t> points(RGB_MATRIX_LED_COUNT);
+    uint32_t                 state = 0xCAFEF00D;
+    for (auto &point : points) {
+        point.x = next_random(state);
+        point.y = next_random(state);
+    }
+    rgb_matrix_grid_init(points.data(), RGB_MATRIX_LED_COUNT);
+
+    for (int query = 0; query < 1000; query++) {
+        uint8_t x      = next_random(state);
+        uint8_t y      = next_random(state);
+        uint8_t radius = next_random(state) % 96;
+
+        std::vector<uint8_t> expected;
+        for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+            if (abs(points[i].x - x) <= radius && abs(points[i].y - y) <= radius) {
+                expected.push_back(i);
+            }
+        }
+
+        uint8_t leds[RGB_MATRIX_LED_COUNT];
+        uint8_t found = rgb_matrix_grid_query(x, y, radius, leds);
+        std::vector<uint8_t> actual(leds, leds + found);
+        std::sort(actual.begin(), actual.end());
+        EXPECT_EQ(expected, actual) << "x " << (int)x << " y " << (int)y << " radius " << (int)radius;
+    }
+}
+
+TEST(RgbMatrixGrid, EdgesOfTheCoordinateSpace) {
+    std::vector<led_point_t> points(RGB_MATRIX_LED_COUNT, {128, 32});
+    points[0] = {0, 0};
+    points[1] = {255, 255};
+    points[2] = {255, 0};
+    rgb_matrix_grid_init(points.data(), RGB_MATRIX_LED_COUNT);
+
+    uint8_t leds[RGB_MATRIX_LED_COUNT];
+    EXPECT_EQ(1, rgb_matrix_grid_query(0, 0, 0, leds));
+    EXPECT_EQ(0, leds[0]);
+    EXPECT_EQ(1, rgb_matrix_grid_query(255, 255, 10, leds));
+    EXPECT_EQ(1, leds[0]);
+    EXPECT_EQ(RGB_MATRIX_LED_COUNT, rgb_matrix_grid_query(128, 128, 255, leds));
+}
@@ -0,0 +1,88 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Builds the reactive splash runners and the effects using them, with just
+// enough of the RGB Matrix state around them for the tests to drive.
+
+#include "rgb_matrix_reactive_effects.h"
+#include "lib/lib8tion/lib8tion.h"
+#ifdef RGB_MATRIX_REACTIVE_GRID
+#    include "rgb_matrix_grid.h"
+#endif
+
+#define ENABLE_RGB_MATRIX_SOLID_SPLASH
+#define ENABLE_RGB_MATRIX_SOLID_MULTISPLASH
+#define ENABLE_RGB_MATRIX_SPLASH
+#define ENABLE_RGB_MATRIX_MULTISPLASH
+#define ENABLE_RGB_MATRIX_SOLID_REACTIVE_CROSS
+#define ENABLE_RGB_MATRIX_SOLID_REACTIVE_MULTICROSS
+#define ENABLE_RGB_MATRIX_SOLID_REACTIVE_WIDE
+#define ENABLE_RGB_MATRIX_SOLID_REACTIVE_MULTIWIDE
+#define ENABLE_RGB_MATRIX_SOLID_REACTIVE_NEXUS
+#define ENABLE_RGB_MATRIX_SOLID_REACTIVE_MULTINEXUS
+
+led_config_t g_led_config;
+last_hit_t   g_last_hit_tracker;
+rgb_config_t rgb_matrix_config;
+uint32_t     g_rgb_timer;
+RGB          g_reactive_frame[RGB_MATRIX_LED_COUNT];
+
+// The whole frame in one step, as without RGB_MATRIX_LED_PROCESS_LIMIT
+#define RGB_MATRIX_USE_LIMITS(min, max) \
+    uint8_t min = 0;                    \
+    uint8_t max = RGB_MATRIX_LED_COUNT;
+#define RGB_MATRIX_TEST_LED_FLAGS() \
+    if (!HAS_ANY_FLAGS(g_led_config.flags[i], params->flags)) continue
+
+static RGB rgb_matrix_hsv_to_rgb(HSV hsv) {
+    return hsv_to_rgb(hsv);
+}
+
+static void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+    g_reactive_frame[index] = (RGB){.r = red, .g = green, .b = blue};
+}
+
+static bool rgb_matrix_check_finished_leds(uint8_t led_idx) {
+    return led_idx < RGB_MATRIX_LED_COUNT;
+}
+
+#define RGB_MATRIX_EFFECT(name)
+#define RGB_MATRIX_CUSTOM_EFFECT_IMPLS
+
+#include "animations/runners/effect_runner_reactive_splash.h"
+#include "animations/solid_splash_anim.h"
+#include "animations/splash_anim.h"
+#include "animations/solid_reactive_cross.h"
+#include "animations/solid_reactive_wide.h"
+#include "animations/solid_reactive_nexus.h"
+
+#define REACTIVE_BASELINE(name, math, first)                          \
+    static bool name##_baseline(effect_params_t *params) {            \
+        return effect_runner_reactive_splash(first, params, &(math)); \
+    }
+#define REACTIVE_EFFECT(name) {#name, &name, &name##_baseline}
+
+REACTIVE_BASELINE(SOLID_SPLASH, SOLID_SPLASH_math, qsub8(g_last_hit_tracker.count, 1))
+REACTIVE_BASELINE(SOLID_MULTISPLASH, SOLID_SPLASH_math, 0)
+REACTIVE_BASELINE(SPLASH, SPLASH_math, qsub8(g_last_hit_tracker.count, 1))
+REACTIVE_BASELINE(MULTISPLASH, SPLASH_math, 0)
+REACTIVE_BASELINE(SOLID_REACTIVE_CROSS, SOLID_REACTIVE_CROSS_math, qsub8(g_last_hit_tracker.count, 1))
+REACTIVE_BASELINE(SOLID_REACTIVE_MULTICROSS, SOLID_REACTIVE_CROSS_math, 0)
+REACTIVE_BASELINE(SOLID_REACTIVE_WIDE, SOLID_REACTIVE_WIDE_math, qsub8(g_last_hit_tracker.count, 1))
+REACTIVE_BASELINE(SOLID_REACTIVE_MULTIWIDE, SOLID_REACTIVE_WIDE_math, 0)
+REACTIVE_BASELINE(SOLID_REACTIVE_NEXUS, SOLID_REACTIVE_NEXUS_math, qsub8(g_last_hit_tracker.count, 1))
+REACTIVE_BASELINE(SOLID_REACTIVE_MULTINEXUS, SOLID_REACTIVE_NEXUS_math, 0)
+
+const reactive_effect_t reactive_effects[] = {
+    REACTIVE_EFFECT(SOLID_SPLASH),
+    REACTIVE_EFFECT(SOLID_MULTISPLASH),
+    REACTIVE_EFFECT(SPLASH),
+    REACTIVE_EFFECT(MULTISPLASH),
+    REACTIVE_EFFECT(SOLID_REACTIVE_CROSS),
+    REACTIVE_EFFECT(SOLID_REACTIVE_MULTICROSS),
+    REACTIVE_EFFECT(SOLID_REACTIVE_WIDE),
+    REACTIVE_EFFECT(SOLID_REACTIVE_MULTIWIDE),
+    REACTIVE_EFFECT(SOLID_REACTIVE_NEXUS),
+    REACTIVE_EFFECT(SOLID_REACTIVE_MULTINEXUS),
+};
+const uint8_t reactive_effect_count = sizeof(reactive_effects) / sizeof(reactive_effects[0]);
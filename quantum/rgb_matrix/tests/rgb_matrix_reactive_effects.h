@@ -0,0 +1,22 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "rgb_matrix_types.h"
+
+typedef struct {
+    const char *name;
+    bool (*render)(effect_params_t *params);   // the effect as rgb_matrix.c runs it
+    bool (*baseline)(effect_params_t *params); // the same math through effect_runner_reactive_splash(), visiting every LED for every hit
+} reactive_effect_t;
+
+extern led_config_t g_led_config;
+extern last_hit_t   g_last_hit_tracker;
+extern rgb_config_t rgb_matrix_config;
+
+// Colors written by the last render
+extern RGB g_reactive_frame[RGB_MATRIX_LED_COUNT];
+
+extern const reactive_effect_t reactive_effects[];
+extern const uint8_t           reactive_effect_count;
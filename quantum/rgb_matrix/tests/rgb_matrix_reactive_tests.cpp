@@ -0,0 +1,133 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#    define BENCHMARK_CYCLES() __rdtsc()
+#endif
+
+extern "C" {
+#include "rgb_matrix_reactive_effects.h"
+#ifdef RGB_MATRIX_REACTIVE_GRID
+#    include "rgb_matrix_grid.h"
+#endif
+}
+
+#ifdef RGB_MATRIX_REACTIVE_GRID
+#    define RUNNER_NAME "grid"
+#else
+#    define RUNNER_NAME "bounding square"
+#endif
+
+#define BENCHMARK_FRAMES 2000
+
+namespace {
+
+uint32_t next_random(uint32_t &state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+class RgbMatrixReactive : public ::testing::Test {
+   protected:
+    effect_params_t params = {.iter = 0, .flags = LED_FLAG_ALL, .init = false};
+
+    void SetUp() override {
+        // A 6 row full size layout, spread over the usual 224x64 area
+        for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+            uint8_t row           = i / 18;
+            uint8_t col           = i % 18;
+            g_led_config.point[i] = {(uint8_t)(col * 224 / 17), (uint8_t)(row * 64 / 5)};
+            g_led_config.flags[i] = LED_FLAG_KEYLIGHT;
+        }
+#ifdef RGB_MATRIX_REACTIVE_GRID
+        rgb_matrix_grid_init(g_led_config.point, RGB_MATRIX_LED_COUNT);
+#endif
+        rgb_matrix_config.hsv   = {85, 255, 255};
+        rgb_matrix_config.speed = 255;
+    }
+
+    // Presses on random keys, spread from fresh ones to ones that have faded out
+    void press(uint8_t count) {
+        uint32_t state           = 0x12345678;
+        g_last_hit_tracker.count = count;
+        for (uint8_t j = 0; j < count; j++) {
+            uint8_t i                   = next_random(state) % RGB_MATRIX_LED_COUNT;
+            g_last_hit_tracker.x[j]     = g_led_config.point[i].x;
+            g_last_hit_tracker.y[j]     = g_led_config.point[i].y;
+            g_last_hit_tracker.index[j] = i;
+            g_last_hit_tracker.tick[j]  = (count - 1 - j) * 600 / count;
+        }
+    }
+
+    void render(bool (*effect)(effect_params_t *), RGB *frame) {
+        memset(g_reactive_frame, 0, sizeof(g_reactive_frame));
+        EXPECT_FALSE(effect(&params));
+        memcpy(frame, g_reactive_frame, sizeof(g_reactive_frame));
+    }
+
+    double time_frames(bool (*effect)(effect_params_t *), uint64_t *cycles) {
+        using clock = std::chrono::steady_clock;
+
+        auto start = clock::now();
+#ifdef BENCHMARK_CYCLES
+        uint64_t start_cycles = BENCHMARK_CYCLES();
+#endif
+        for (int i = 0; i < BENCHMARK_FRAMES; i++) {
+            effect(&params);
+        }
+#ifdef BENCHMARK_CYCLES
+        *cycles = (BENCHMARK_CYCLES() - start_cycles) / BENCHMARK_FRAMES;
+#else
+        *cycles = 0;
+#endif
+        return std::chrono::duration<double, std::micro>(clock::now() - start).count() / BENCHMARK_FRAMES;
+    }
+};
+
+} // namespace
+
+TEST_F(RgbMatrixReactive, EffectsMatchEveryLed) {
+    for (uint8_t e = 0; e < reactive_effect_count; e++) {
+        for (uint8_t hit_count : {1, 8, LED_HITS_TO_REMEMBER}) {
+            press(hit_count);
+            RGB expected[RGB_MATRIX_LED_COUNT];
+            RGB actual[RGB_MATRIX_LED_COUNT];
+            render(reactive_effects[e].baseline, expected);
+            render(reactive_effects[e].render, actual);
+            for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+                EXPECT_TRUE(expected[i].r == actual[i].r && expected[i].g == actual[i].g && expected[i].b == actual[i].b) << reactive_effects[e].name << ", " << (int)hit_count << " hits, LED " << (int)i;
+            }
+        }
+    }
+}
+
+TEST_F(RgbMatrixReactive, Benchmark) {
+    for (uint8_t e = 0; e < reactive_effect_count; e++) {
+        if (strstr(reactive_effects[e].name, "MULTI") == NULL) continue;
+
+        press(LED_HITS_TO_REMEMBER);
+        uint64_t every_led_cycles, runner_cycles;
+        double   every_led_us = time_frames(reactive_effects[e].baseline, &every_led_cycles);
+        double   runner_us    = time_frames(reactive_effects[e].render, &runner_cycles);
+
+        std::cout << "[ BENCHMARK] " << std::left << std::setw(26) << reactive_effects[e].name << std::right << RGB_MATRIX_LED_COUNT << " LEDs, " << LED_HITS_TO_REMEMBER << " hits" << std::fixed << std::setprecision(2) << " every LED " << every_led_us << " us/frame";
+#ifdef BENCHMARK_CYCLES
+        std::cout << " (" << every_led_cycles << " cycles)";
+#endif
+        std::cout << ", " RUNNER_NAME " " << runner_us << " us/frame";
+#ifdef BENCHMARK_CYCLES
+        std::cout << " (" << runner_cycles << " cycles)";
+#endif
+        std::cout << std::endl;
+    }
+}
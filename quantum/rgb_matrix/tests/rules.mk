@@ -0,0 +1,21 @@
+RGB_MATRIX_REACTIVE_COMMON_DEFS := -DRGB_MATRIX_LED_COUNT=104 -DMATRIX_ROWS=6 -DMATRIX_COLS=18 -DRGB_MATRIX_KEYPRESSES -DLED_HITS_TO_REMEMBER=32
+
+rgb_matrix_grid_DEFS := $(RGB_MATRIX_REACTIVE_COMMON_DEFS) -DRGB_MATRIX_REACTIVE_GRID
+rgb_matrix_grid_INC := $(QUANTUM_PATH)/rgb_matrix
+
+rgb_matrix_grid_SRC := \
+	$(QUANTUM_PATH)/rgb_matrix/tests/rgb_matrix_grid_tests.cpp \
+	$(QUANTUM_PATH)/rgb_matrix/tests/rgb_matrix_reactive_tests.cpp \
+	$(QUANTUM_PATH)/rgb_matrix/tests/rgb_matrix_reactive_effects.c \
+	$(QUANTUM_PATH)/rgb_matrix/rgb_matrix_grid.c \
+	$(QUANTUM_PATH)/color.c \
+	$(LIB_PATH)/lib8tion/lib8tion.c
+
+rgb_matrix_reactive_DEFS := $(RGB_MATRIX_REACTIVE_COMMON_DEFS)
+rgb_matrix_reactive_INC := $(QUANTUM_PATH)/rgb_matrix
+
+rgb_matrix_reactive_SRC := \
+	$(QUANTUM_PATH)/rgb_matrix/tests/rgb_matrix_reactive_tests.cpp \
+	$(QUANTUM_PATH)/rgb_matrix/tests/rgb_matrix_reactive_effects.c \
+	$(QUANTUM_PATH)/color.c \
+	$(LIB_PATH)/lib8tion/lib8tion.c
@@ -1051,6 +1051,12 @@ static void rgblight_effect_dummy(animation_status_t *anim) {
 }
 
 void rgblight_task(void) {
+#    if defined(WS2812_DOUBLE_BUFFER) && !defined(RGBLIGHT_CUSTOM_DRIVER)
+    // A frame is still queued behind the one being sent, step the animation on the next run
+    if (!ws2812_ready()) {
+        return;
+    }
+#    endif
     if (rgblight_status.timer_enabled) {
         effect_func_t effect_func   = rgblight_effect_dummy;
         uint16_t      interval_time = 2000; // dummy interval
@@ -0,0 +1,49 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "matrix_delta.h"
+#include "crc.h"
+
+void split_matrix_delta_update(split_slave_matrix_delta_t *delta, const matrix_row_t published[], const matrix_row_t current[], uint8_t rows) {
+    uint8_t count = 0;
+
+    for (uint8_t row = 0; row < rows; row++) {
+        if (current[row] != published[row]) {
+            if (count < SPLIT_MATRIX_DELTA_ROWS) {
+                delta->payload.row[count]   = row;
+                delta->payload.value[count] = current[row];
+            }
+            count++;
+        }
+    }
+
+    if (count > 0) {
+        delta->payload.sequence++;
+        delta->payload.count = count <= SPLIT_MATRIX_DELTA_ROWS ? count : SPLIT_MATRIX_DELTA_RESYNC;
+        delta->checksum      = crc8(&delta->payload, sizeof(delta->payload));
+        delta->sequence      = delta->payload.sequence;
+    }
+}
+
+bool split_matrix_delta_apply(const split_slave_matrix_delta_t *delta, uint8_t *last_sequence, matrix_row_t matrix[], uint8_t rows) {
+    if (delta->checksum != crc8(&delta->payload, sizeof(delta->payload))) {
+        return false;
+    }
+    if (delta->payload.sequence == *last_sequence) {
+        // Nothing new
+        return true;
+    }
+
+    // Rows are sent as absolute values, so a delta is only usable if no sequence was missed in between
+    if (delta->payload.sequence != (uint8_t)(*last_sequence + 1) || delta->payload.count > SPLIT_MATRIX_DELTA_ROWS) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < delta->payload.count; i++) {
+        if (delta->payload.row[i] < rows) {
+            matrix[delta->payload.row[i]] = delta->payload.value[i];
+        }
+    }
+    *last_sequence = delta->payload.sequence;
+    return true;
+}
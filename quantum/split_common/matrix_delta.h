@@ -0,0 +1,42 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "matrix.h"
+
+#ifndef SPLIT_MATRIX_DELTA_ROWS
+#    define SPLIT_MATRIX_DELTA_ROWS 2
+#endif // SPLIT_MATRIX_DELTA_ROWS
+
+// More rows changed than fit in a delta, the full matrix has to be read instead
+#define SPLIT_MATRIX_DELTA_RESYNC UINT8_MAX
+
+typedef struct _split_slave_matrix_delta_t {
+    uint8_t sequence; // copy of payload.sequence, polled on its own so that idle scans only transfer one byte
+    uint8_t checksum;
+    struct {
+        uint8_t      sequence; // incremented on every change of the slave matrix
+        uint8_t      count;    // number of changed rows, or SPLIT_MATRIX_DELTA_RESYNC
+        uint8_t      row[SPLIT_MATRIX_DELTA_ROWS];
+        matrix_row_t value[SPLIT_MATRIX_DELTA_ROWS];
+    } payload;
+} split_slave_matrix_delta_t;
+
+/**
+ * @brief Records the rows that differ between the previously published and
+ * the current slave matrix in the delta, starting a new sequence if any did.
+ */
+void split_matrix_delta_update(split_slave_matrix_delta_t *delta, const matrix_row_t published[], const matrix_row_t current[], uint8_t rows);
+
+/**
+ * @brief Applies a delta read by the master on top of its copy of the slave matrix.
+ *
+ * Returns false, leaving the matrix and sequence untouched, if the delta can't
+ * be used and the full matrix has to be read instead: when it is corrupted,
+ * when an earlier delta was missed, or when too many rows changed at once.
+ */
+bool split_matrix_delta_apply(const split_slave_matrix_delta_t *delta, uint8_t *last_sequence, matrix_row_t matrix[], uint8_t rows);
@@ -0,0 +1,128 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "matrix_delta.h"
+}
+
+#define SLAVE_ROWS ((MATRIX_ROWS) / 2)
+
+class SplitMatrixDelta : public ::testing::Test {
+   protected:
+    // Slave side: the matrix last published, and the delta describing the latest change
+    matrix_row_t               published[SLAVE_ROWS] = {0};
+    split_slave_matrix_delta_t delta                 = {};
+
+    // Master side: its copy of the slave matrix, and the sequence it corresponds to
+    matrix_row_t master[SLAVE_ROWS] = {0};
+    uint8_t      last_sequence      = 0;
+
+    void slave_scan(const matrix_row_t current[]) {
+        split_matrix_delta_update(&delta, published, current, SLAVE_ROWS);
+        memcpy(published, current, sizeof(published));
+    }
+
+    bool master_read(void) {
+        return split_matrix_delta_apply(&delta, &last_sequence, master, SLAVE_ROWS);
+    }
+
+    // What the master does when a delta can't be applied
+    void master_resync(void) {
+        memcpy(master, published, sizeof(master));
+        last_sequence = delta.sequence;
+    }
+};
+
+TEST_F(SplitMatrixDelta, IdleKeepsSequence) {
+    matrix_row_t current[SLAVE_ROWS] = {0};
+    slave_scan(current);
+    EXPECT_EQ(delta.sequence, 0);
+
+    current[1] = 0x04;
+    slave_scan(current);
+    EXPECT_EQ(delta.sequence, 1);
+    slave_scan(current);
+    EXPECT_EQ(delta.sequence, 1);
+}
+
+TEST_F(SplitMatrixDelta, ChangedRowsApply) {
+    matrix_row_t current[SLAVE_ROWS] = {0};
+    current[0]                       = 0x01;
+    current[3]                       = 0x80;
+    slave_scan(current);
+
+    EXPECT_TRUE(master_read());
+    EXPECT_EQ(last_sequence, delta.sequence);
+    EXPECT_EQ(memcmp(master, current, sizeof(master)), 0);
+
+    // Reading the same delta again changes nothing
+    EXPECT_TRUE(master_read());
+    EXPECT_EQ(memcmp(master, current, sizeof(master)), 0);
+}
+
+TEST_F(SplitMatrixDelta, DroppedDeltaNeedsResync) {
+    matrix_row_t current[SLAVE_ROWS] = {0};
+    current[0]                       = 0x01;
+    slave_scan(current);
+    // The master misses this one
+    current[2] = 0x10;
+    slave_scan(current);
+
+    matrix_row_t before[SLAVE_ROWS];
+    memcpy(before, master, sizeof(before));
+    EXPECT_FALSE(master_read());
+    EXPECT_EQ(last_sequence, 0);
+    EXPECT_EQ(memcmp(master, before, sizeof(master)), 0);
+
+    // After a full read the following deltas apply again
+    master_resync();
+    current[0] = 0;
+    slave_scan(current);
+    EXPECT_TRUE(master_read());
+    EXPECT_EQ(memcmp(master, current, sizeof(master)), 0);
+}
+
+TEST_F(SplitMatrixDelta, CorruptedDeltaNeedsResync) {
+    matrix_row_t current[SLAVE_ROWS] = {0};
+    current[1]                       = 0x02;
+    slave_scan(current);
+
+    delta.payload.value[0] ^= 0x40;
+    EXPECT_FALSE(master_read());
+    EXPECT_EQ(master[1], 0);
+}
+
+TEST_F(SplitMatrixDelta, TooManyRowsNeedsResync) {
+    matrix_row_t current[SLAVE_ROWS] = {0};
+    for (uint8_t row = 0; row <= SPLIT_MATRIX_DELTA_ROWS; row++) {
+        current[row] = 1 << row;
+    }
+    slave_scan(current);
+    EXPECT_EQ(delta.payload.count, SPLIT_MATRIX_DELTA_RESYNC);
+
+    EXPECT_FALSE(master_read());
+    master_resync();
+    EXPECT_EQ(memcmp(master, current, sizeof(master)), 0);
+
+    // Back within the limit, deltas are used again
+    current[0] = 0;
+    slave_scan(current);
+    EXPECT_EQ(delta.payload.count, 1);
+    EXPECT_TRUE(master_read());
+    EXPECT_EQ(memcmp(master, current, sizeof(master)), 0);
+}
+
+TEST_F(SplitMatrixDelta, SequenceWrapsAround) {
+    matrix_row_t current[SLAVE_ROWS] = {0};
+    for (int i = 0; i < 600; i++) {
+        current[i % SLAVE_ROWS] ^= 1;
+        slave_scan(current);
+        ASSERT_TRUE(master_read()) << "change " << i;
+        ASSERT_EQ(memcmp(master, current, sizeof(master)), 0) << "change " << i;
+    }
+    EXPECT_EQ(last_sequence, 600 % 256);
+}
@@ -0,0 +1,7 @@
+split_matrix_delta_DEFS := -DMATRIX_ROWS=8 -DMATRIX_COLS=8 -DSPLIT_MATRIX_DELTA_ROWS=2 -DNO_DEBUG
+split_matrix_delta_INC := $(QUANTUM_PATH)/split_common
+
+split_matrix_delta_SRC := \
+	$(QUANTUM_PATH)/split_common/tests/matrix_delta_tests.cpp \
+	$(QUANTUM_PATH)/split_common/matrix_delta.c \
+	$(QUANTUM_PATH)/crc.c
@@ -24,6 +24,11 @@ enum serial_transaction_id {
     GET_SLAVE_MATRIX_CHECKSUM,
     GET_SLAVE_MATRIX_DATA,
 
+#ifdef SPLIT_MATRIX_DELTA_ENABLE
+    GET_SLAVE_MATRIX_SEQUENCE,
+    GET_SLAVE_MATRIX_DELTA,
+#endif // SPLIT_MATRIX_DELTA_ENABLE
+
 #ifdef SPLIT_TRANSPORT_MIRROR
     PUT_MASTER_MATRIX,
 #endif // SPLIT_TRANSPORT_MIRROR
@@ -136,6 +136,8 @@ inline static bool send_if_data_mismatch(int8_t trans_id, uint32_t *last_update,
 ////////////////////////////////////////////////////
 // Slave matrix
 
+#ifndef SPLIT_MATRIX_DELTA_ENABLE
+
 static bool slave_matrix_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
     static uint32_t     last_update                    = 0;
     static matrix_row_t last_matrix[(MATRIX_ROWS) / 2] = {0}; // last successfully-read matrix, so we can replicate if there are checksum errors
@@ -164,6 +166,73 @@ static void slave_matrix_handlers_slave(matrix_row_t master_matrix[], matrix_row
     [GET_SLAVE_MATRIX_DATA]     = trans_target2initiator_initializer(smatrix.matrix),
 // clang-format on
 
+#else // SPLIT_MATRIX_DELTA_ENABLE
+
+/**
+ * @brief Reads the complete slave matrix, used whenever the deltas can't be
+ * applied: at startup, after a lost update, when too many rows changed at once,
+ * and every FORCED_SYNC_THROTTLE_MS to recover from any undetected corruption.
+ */
+static bool slave_matrix_read_full(matrix_row_t destination[]) {
+    uint8_t checksum;
+    bool    okay = transport_read(GET_SLAVE_MATRIX_CHECKSUM, &checksum, sizeof(checksum));
+    okay         = okay && transport_read(GET_SLAVE_MATRIX_DATA, destination, sizeof(split_shmem->smatrix.matrix));
+    return okay && checksum == crc8(destination, sizeof(split_shmem->smatrix.matrix));
+}
+
+static bool slave_matrix_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    static uint32_t     last_update                    = 0;
+    static bool         synced                         = false;
+    static uint8_t      last_sequence                  = 0;
+    static matrix_row_t last_matrix[(MATRIX_ROWS) / 2] = {0}; // last successfully-read matrix, so we can replicate if there are errors
+
+    // While idle only the sequence number is transferred, like the checksum without deltas
+    uint8_t sequence;
+    bool    okay = transport_read(GET_SLAVE_MATRIX_SEQUENCE, &sequence, sizeof(sequence));
+    if (okay) {
+        bool resync = !synced || timer_elapsed32(last_update) >= FORCED_SYNC_THROTTLE_MS;
+        if (!resync && sequence != last_sequence) {
+            split_slave_matrix_delta_t delta;
+            okay   = transport_read(GET_SLAVE_MATRIX_DELTA, &delta, sizeof(delta));
+            resync = okay && !split_matrix_delta_apply(&delta, &last_sequence, last_matrix, (MATRIX_ROWS) / 2);
+        }
+
+        if (resync) {
+            matrix_row_t temp_matrix[(MATRIX_ROWS) / 2]; // holding area while we test whether or not checksum is correct
+            okay = slave_matrix_read_full(temp_matrix);
+            if (okay) {
+                // The full matrix is at least as recent as the sequence, later deltas carry absolute values so reapplying is harmless
+                memcpy(last_matrix, temp_matrix, sizeof(temp_matrix));
+                last_sequence = sequence;
+                last_update   = timer_read32();
+                synced        = true;
+            }
+        }
+    }
+    // Copy out the last-known-good matrix state to the slave matrix
+    memcpy(slave_matrix, last_matrix, sizeof(last_matrix));
+    return okay;
+}
+
+static void slave_matrix_handlers_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    split_matrix_delta_update(&split_shmem->smatrix_delta, split_shmem->smatrix.matrix, slave_matrix, (MATRIX_ROWS) / 2);
+
+    memcpy(split_shmem->smatrix.matrix, slave_matrix, sizeof(split_shmem->smatrix.matrix));
+    split_shmem->smatrix.checksum = crc8(split_shmem->smatrix.matrix, sizeof(split_shmem->smatrix.matrix));
+}
+
+// clang-format off
+#define TRANSACTIONS_SLAVE_MATRIX_MASTER() TRANSACTION_HANDLER_MASTER(slave_matrix)
+#define TRANSACTIONS_SLAVE_MATRIX_SLAVE() TRANSACTION_HANDLER_SLAVE_AUTOLOCK(slave_matrix)
+#define TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS \
+    [GET_SLAVE_MATRIX_CHECKSUM] = trans_target2initiator_initializer(smatrix.checksum), \
+    [GET_SLAVE_MATRIX_DATA]     = trans_target2initiator_initializer(smatrix.matrix), \
+    [GET_SLAVE_MATRIX_SEQUENCE] = trans_target2initiator_initializer(smatrix_delta.sequence), \
+    [GET_SLAVE_MATRIX_DELTA]    = trans_target2initiator_initializer(smatrix_delta),
+// clang-format on
+
+#endif // SPLIT_MATRIX_DELTA_ENABLE
+
 ////////////////////////////////////////////////////
 // Master matrix
 
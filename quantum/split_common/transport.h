@@ -57,6 +57,10 @@ typedef struct _split_slave_matrix_sync_t {
     matrix_row_t matrix[(MATRIX_ROWS) / 2];
 } split_slave_matrix_sync_t;
 
+#ifdef SPLIT_MATRIX_DELTA_ENABLE
+#    include "matrix_delta.h"
+#endif // SPLIT_MATRIX_DELTA_ENABLE
+
 #ifdef SPLIT_TRANSPORT_MIRROR
 typedef struct _split_master_matrix_sync_t {
     matrix_row_t matrix[(MATRIX_ROWS) / 2];
@@ -140,6 +144,10 @@ typedef struct _split_shared_memory_t {
 
     split_slave_matrix_sync_t smatrix;
 
+#ifdef SPLIT_MATRIX_DELTA_ENABLE
+    split_slave_matrix_delta_t smatrix_delta;
+#endif // SPLIT_MATRIX_DELTA_ENABLE
+
 #ifdef SPLIT_TRANSPORT_MIRROR
     split_master_matrix_sync_t mmatrix;
 #endif // SPLIT_TRANSPORT_MIRROR
@@ -20,6 +20,7 @@
 #include "keycode.h"
 #include "quantum_keycodes.h"
 #include "action_util.h"
+#include "deadline.h"
 #include <math.h>
 
 // WPM Stuff
@@ -176,3 +177,17 @@ void decay_wpm(void) {
     current_wpm = prev_wpm + (latency * ((int)next_wpm - (int)prev_wpm) / LATENCY);
 #endif
 }
+
+// WPM only needs to be recomputed when it is read, so apart from rolling over
+// to the next sample period there is nothing time-critical while typing.
+uint32_t wpm_next_deadline(void) {
+    bool active = current_wpm != 0;
+    for (int i = 0; i <= periods && !active; i++) {
+        active = period_presses[i] != 0;
+    }
+    if (!active) {
+        return DEADLINE_NONE;
+    }
+
+    return deadline_remaining(timer_elapsed32(wpm_timer), PERIOD_DURATION + 1);
+}
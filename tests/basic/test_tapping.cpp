@@ -190,3 +190,49 @@ TEST_F(Tapping, TapA_CTL_T_KeyWhileReleasingLayer) {
     run_one_scan_loop();
     VERIFY_AND_CLEAR(driver);
 }
+
+TEST_F(Tapping, RollingKeysPastWaitingBufferWhileHoldingSFT_TKeepsAllKeys) {
+    TestDriver driver;
+    InSequence s;
+    auto       mod_tap_hold_key = KeymapKey(0, 0, 3, SFT_T(KC_P));
+    const int  roll_length      = WAITING_BUFFER_SIZE + 6;
+
+    std::vector<KeymapKey> keys;
+    for (int i = 0; i < roll_length; i++) {
+        keys.push_back(KeymapKey(0, i % 10, i / 10 % 3, KC_A + i));
+    }
+    set_keymap({mod_tap_hold_key});
+    for (auto& key : keys) {
+        add_key(key);
+    }
+
+    // Nothing is reported until the mod tap is settled
+    mod_tap_hold_key.press();
+    run_one_scan_loop();
+
+    // Filling the waiting buffer settles the mod tap as a hold, no events are dropped
+    EXPECT_REPORT(driver, (KC_LSFT));
+    EXPECT_REPORT(driver, (KC_LSFT, keys[0].code));
+    for (int i = 1; i < roll_length; i++) {
+        EXPECT_REPORT(driver, (KC_LSFT, keys[i - 1].code, keys[i].code));
+        EXPECT_REPORT(driver, (KC_LSFT, keys[i].code));
+    }
+    EXPECT_REPORT(driver, (KC_LSFT));
+
+    keys[0].press();
+    run_one_scan_loop();
+    for (int i = 1; i < roll_length; i++) {
+        keys[i].press();
+        run_one_scan_loop();
+        keys[i - 1].release();
+        run_one_scan_loop();
+    }
+    keys[roll_length - 1].release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_EMPTY_REPORT(driver);
+    mod_tap_hold_key.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+}
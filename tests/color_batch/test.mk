@@ -0,0 +1,4 @@
+# Copyright 2023 QMK
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+SRC += $(QUANTUM_DIR)/color.c
@@ -0,0 +1,118 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#    define BENCHMARK_CYCLES() __rdtsc()
+#endif
+
+extern "C" {
+#include "color.h"
+}
+
+namespace {
+
+#define BENCHMARK_FRAMES 2000
+
+std::vector<HSV> random_frame(size_t count) {
+    std::vector<HSV> frame(count);
+    uint32_t         state = 0x12345678;
+    for (auto &hsv : frame) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        hsv.h = state;
+        hsv.s = state >> 8;
+        hsv.v = state >> 16;
+    }
+    return frame;
+}
+
+void per_led_frame(const HSV *hsv, RGB *rgb, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) {
+        rgb[i] = hsv_to_rgb(hsv[i]);
+    }
+}
+
+double time_frames(void (*convert)(const HSV *, RGB *, uint16_t), const std::vector<HSV> &frame, std::vector<RGB> &out, uint64_t *cycles) {
+    using clock = std::chrono::steady_clock;
+
+    auto start = clock::now();
+#ifdef BENCHMARK_CYCLES
+    uint64_t start_cycles = BENCHMARK_CYCLES();
+#endif
+    for (int i = 0; i < BENCHMARK_FRAMES; i++) {
+        convert(frame.data(), out.data(), frame.size());
+    }
+#ifdef BENCHMARK_CYCLES
+    *cycles = (BENCHMARK_CYCLES() - start_cycles) / BENCHMARK_FRAMES;
+#else
+    *cycles = 0;
+#endif
+    return std::chrono::duration<double, std::micro>(clock::now() - start).count() / BENCHMARK_FRAMES;
+}
+
+} // namespace
+
+TEST(ColorBatch, EveryColorMatchesHsvToRgb) {
+    HSV hsv[256];
+    RGB rgb[256];
+
+    for (int s = 0; s < 256; s++) {
+        for (int v = 0; v < 256; v++) {
+            for (int h = 0; h < 256; h++) {
+                hsv[h].h = h;
+                hsv[h].s = s;
+                hsv[h].v = v;
+            }
+            hsv_to_rgb_batch(hsv, rgb, 256);
+            for (int h = 0; h < 256; h++) {
+                RGB expected = hsv_to_rgb(hsv[h]);
+                ASSERT_EQ(expected.r, rgb[h].r) << "h " << h << " s " << s << " v " << v;
+                ASSERT_EQ(expected.g, rgb[h].g) << "h " << h << " s " << s << " v " << v;
+                ASSERT_EQ(expected.b, rgb[h].b) << "h " << h << " s " << s << " v " << v;
+            }
+        }
+    }
+}
+
+TEST(ColorBatch, EmptyBatch) {
+    RGB rgb;
+    rgb.r = 1;
+    rgb.g = 2;
+    rgb.b = 3;
+    hsv_to_rgb_batch(NULL, &rgb, 0);
+    EXPECT_EQ(1, rgb.r);
+    EXPECT_EQ(2, rgb.g);
+    EXPECT_EQ(3, rgb.b);
+}
+
+TEST(ColorBatch, Benchmark) {
+    for (int leds : {64, 128, 256}) {
+        auto             frame = random_frame(leds);
+        std::vector<RGB> per_led(leds);
+        std::vector<RGB> batch(leds);
+        uint64_t         per_led_cycles, batch_cycles;
+
+        double per_led_us = time_frames(per_led_frame, frame, per_led, &per_led_cycles);
+        double batch_us   = time_frames(hsv_to_rgb_batch, frame, batch, &batch_cycles);
+        EXPECT_EQ(0, memcmp(per_led.data(), batch.data(), leds * sizeof(RGB)));
+
+        std::cout << "[ BENCHMARK] " << std::setw(3) << leds << " LEDs" << std::fixed << std::setprecision(2) << " hsv_to_rgb " << per_led_us << " us/frame";
+#ifdef BENCHMARK_CYCLES
+        std::cout << " (" << per_led_cycles << " cycles)";
+#endif
+        std::cout << ", hsv_to_rgb_batch " << batch_us << " us/frame";
+#ifdef BENCHMARK_CYCLES
+        std::cout << " (" << batch_cycles << " cycles)";
+#endif
+        std::cout << std::endl;
+    }
+}
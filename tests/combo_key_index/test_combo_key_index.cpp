@@ -0,0 +1,182 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Test the combo keycode index with a large number of combos.
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+
+#define COMBO_KEY_COUNT 32
+#define PAIR_COMBO_COUNT (COMBO_KEY_COUNT * (COMBO_KEY_COUNT - 1) / 2)
+#define TRIPLE_COMBO_COUNT 4
+#define TOTAL_COMBO_COUNT (PAIR_COMBO_COUNT + TRIPLE_COMBO_COUNT)
+
+static std::vector<uint16_t> fired_combos;
+
+extern "C" {
+uint16_t COMBO_LEN = TOTAL_COMBO_COUNT;
+combo_t  key_combos[TOTAL_COMBO_COUNT];
+
+void process_combo_event(uint16_t combo_index, bool pressed) {
+    if (pressed) {
+        fired_combos.push_back(combo_index);
+    }
+}
+}
+
+namespace {
+
+// clang-format off
+const uint16_t combo_keycodes[COMBO_KEY_COUNT] = {
+    KC_A, KC_B, KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J, KC_K, KC_L, KC_M, KC_N, KC_O, KC_P,
+    KC_Q, KC_R, KC_S, KC_T, KC_U, KC_V, KC_W, KC_X, KC_Y, KC_Z, KC_1, KC_2, KC_3, KC_4, KC_5, KC_6,
+};
+// clang-format on
+
+uint16_t combo_keys[TOTAL_COMBO_COUNT][4];
+
+// Every pair of keys is a combo, plus a few three key combos overlapping them.
+uint16_t pair_combo_index(uint8_t first, uint8_t second) {
+    uint16_t index = 0;
+    for (uint8_t i = 0; i < first; i++) {
+        index += COMBO_KEY_COUNT - 1 - i;
+    }
+    return index + (second - first - 1);
+}
+
+struct ComboSetup {
+    ComboSetup() {
+        for (uint8_t i = 0; i < COMBO_KEY_COUNT; i++) {
+            for (uint8_t j = i + 1; j < COMBO_KEY_COUNT; j++) {
+                uint16_t index     = pair_combo_index(i, j);
+                combo_keys[index][0] = combo_keycodes[i];
+                combo_keys[index][1] = combo_keycodes[j];
+                combo_keys[index][2] = COMBO_END;
+                key_combos[index]    = (combo_t)COMBO_ACTION(combo_keys[index]);
+            }
+        }
+        for (uint8_t t = 0; t < TRIPLE_COMBO_COUNT; t++) {
+            uint16_t index       = PAIR_COMBO_COUNT + t;
+            combo_keys[index][0] = combo_keycodes[t * 3];
+            combo_keys[index][1] = combo_keycodes[t * 3 + 1];
+            combo_keys[index][2] = combo_keycodes[t * 3 + 2];
+            combo_keys[index][3] = COMBO_END;
+            key_combos[index]    = (combo_t)COMBO_ACTION(combo_keys[index]);
+        }
+    }
+} combo_setup;
+
+class ComboKeyIndex : public TestFixture {
+   public:
+    void SetUp() override {
+        fired_combos.clear();
+
+        for (uint8_t i = 0; i < COMBO_KEY_COUNT; i++) {
+            keys.push_back(KeymapKey(0, i % MATRIX_COLS, i / MATRIX_COLS, combo_keycodes[i]));
+        }
+        for (const KeymapKey& key : keys) {
+            add_key(key);
+        }
+        add_key(key_enter);
+    }
+
+    std::vector<KeymapKey> keys;
+    KeymapKey              key_enter = KeymapKey(0, 9, 3, KC_ENT);
+};
+
+} // namespace
+
+TEST_F(ComboKeyIndex, EveryPairComboTriggers) {
+    TestDriver driver;
+    EXPECT_ANY_REPORT(driver).Times(AnyNumber());
+
+    for (uint8_t i = 0; i < COMBO_KEY_COUNT; i++) {
+        for (uint8_t j = i + 1; j < COMBO_KEY_COUNT; j++) {
+            fired_combos.clear();
+            tap_combo({keys[i], keys[j]});
+            idle_for(COMBO_TERM + 1);
+
+            ASSERT_EQ(fired_combos.size(), 1u) << "keys " << +i << " and " << +j;
+            EXPECT_EQ(fired_combos[0], pair_combo_index(i, j));
+        }
+    }
+
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(ComboKeyIndex, LongerOverlappingComboWins) {
+    TestDriver driver;
+    EXPECT_ANY_REPORT(driver).Times(AnyNumber());
+
+    for (uint8_t t = 0; t < TRIPLE_COMBO_COUNT; t++) {
+        fired_combos.clear();
+        tap_combo({keys[t * 3], keys[t * 3 + 1], keys[t * 3 + 2]});
+        idle_for(COMBO_TERM + 1);
+
+        ASSERT_EQ(fired_combos.size(), 1u);
+        EXPECT_EQ(fired_combos[0], PAIR_COMBO_COUNT + t);
+    }
+
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(ComboKeyIndex, NonComboKeyPassesThrough) {
+    TestDriver driver;
+
+    EXPECT_REPORT(driver, (KC_ENT));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_key(key_enter);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_A));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_key(keys[0]);
+    idle_for(COMBO_TERM + 1);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_TRUE(fired_combos.empty());
+}
+
+// Reports the cost of a key event with TOTAL_COMBO_COUNT combos defined.
+TEST_F(ComboKeyIndex, PerEventCost) {
+    TestDriver driver;
+    EXPECT_ANY_REPORT(driver).Times(AnyNumber());
+
+    const unsigned iterations = 2000;
+    using clock               = std::chrono::steady_clock;
+
+    clock::duration combo_time = clock::duration::zero();
+    for (unsigned n = 0; n < iterations; n++) {
+        uint8_t i = n % COMBO_KEY_COUNT;
+        uint8_t j = (i + 1 + n / COMBO_KEY_COUNT % (COMBO_KEY_COUNT - 1)) % COMBO_KEY_COUNT;
+
+        auto start = clock::now();
+        tap_combo({keys[i], keys[j]});
+        combo_time += clock::now() - start;
+        idle_for(COMBO_TERM + 1);
+    }
+
+    clock::duration other_time = clock::duration::zero();
+    for (unsigned n = 0; n < iterations; n++) {
+        auto start = clock::now();
+        tap_key(key_enter);
+        other_time += clock::now() - start;
+    }
+
+    // tap_combo() generates four key events, tap_key() two
+    auto per_event_ns = [](clock::duration total, unsigned events) { return std::chrono::duration_cast<std::chrono::nanoseconds>(total).count() / events; };
+    std::cout << "[ BENCHMARK] " << TOTAL_COMBO_COUNT << " combos: " << per_event_ns(combo_time, iterations * 4) << " ns per combo key event, " << per_event_ns(other_time, iterations * 2) << " ns per non-combo key event" << std::endl;
+
+    EXPECT_EQ(fired_combos.size(), iterations);
+    VERIFY_AND_CLEAR(driver);
+}
@@ -0,0 +1,250 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Test the deferred executor scheduler with large numbers of timers.
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+
+#define TIMER_COUNT MAX_DEFERRED_EXECUTORS
+
+extern "C" {
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+namespace {
+
+struct fired_t {
+    uintptr_t id;
+    uint32_t  trigger_time;
+    uint32_t  now;
+};
+
+std::vector<fired_t> fired;
+std::vector<uint32_t> repeat_delays;
+uint32_t              end_time = 0;
+
+uint32_t record_once(uint32_t trigger_time, void *cb_arg) {
+    fired.push_back({(uintptr_t)cb_arg, trigger_time, timer_read32()});
+    return 0;
+}
+
+uint32_t record_repeating(uint32_t trigger_time, void *cb_arg) {
+    fired.push_back({(uintptr_t)cb_arg, trigger_time, timer_read32()});
+    return repeat_delays[(uintptr_t)cb_arg];
+}
+
+void run_until(uint32_t end) {
+    while (timer_read32() < end) {
+        advance_time(1);
+        deferred_exec_task();
+    }
+}
+
+class DeferredExec : public TestFixture {
+   protected:
+    std::vector<deferred_token> tokens;
+
+    void SetUp() override {
+        fired.clear();
+        repeat_delays.clear();
+        // The fixture resets the timer between tests, but the task throttles against its last execution time
+        set_time(end_time + 1000);
+        deferred_exec_task();
+    }
+
+    void TearDown() override {
+        for (auto token : tokens) {
+            cancel_deferred_exec(token);
+        }
+        end_time = timer_read32();
+    }
+};
+
+} // namespace
+
+TEST_F(DeferredExec, ThousandsOfTimersFireInOrder) {
+    uint32_t start = timer_read32();
+    for (uintptr_t i = 0; i < TIMER_COUNT; ++i) {
+        deferred_token token = defer_exec(1 + (i * 7919) % 2000, record_once, (void *)i);
+        ASSERT_NE(token, INVALID_DEFERRED_TOKEN);
+        tokens.push_back(token);
+    }
+
+    run_until(start + 2001);
+
+    ASSERT_EQ(fired.size(), TIMER_COUNT);
+    for (size_t i = 0; i < fired.size(); ++i) {
+        EXPECT_EQ(fired[i].trigger_time, start + 1 + (fired[i].id * 7919) % 2000);
+        EXPECT_EQ(fired[i].now, fired[i].trigger_time);
+        if (i > 0) {
+            EXPECT_LE(fired[i - 1].trigger_time, fired[i].trigger_time);
+        }
+    }
+}
+
+TEST_F(DeferredExec, TableFullAndReuse) {
+    for (uintptr_t i = 0; i < TIMER_COUNT; ++i) {
+        tokens.push_back(defer_exec(100, record_once, (void *)i));
+    }
+    EXPECT_EQ(defer_exec(100, record_once, NULL), INVALID_DEFERRED_TOKEN);
+
+    // Freeing a slot allows a new executor, and the stale token must not refer to it
+    deferred_token stale = tokens[TIMER_COUNT / 2];
+    EXPECT_TRUE(cancel_deferred_exec(stale));
+    deferred_token fresh = defer_exec(100, record_once, NULL);
+    EXPECT_NE(fresh, INVALID_DEFERRED_TOKEN);
+    EXPECT_NE(fresh, stale);
+    EXPECT_FALSE(cancel_deferred_exec(stale));
+    EXPECT_FALSE(extend_deferred_exec(stale, 10));
+    tokens.push_back(fresh);
+}
+
+TEST_F(DeferredExec, StaleTokenOnLargeTable) {
+    // An empty table hands out the same slot every time, so each reuse only differs in its generation
+    deferred_token stale = defer_exec(100, record_once, NULL);
+    ASSERT_NE(stale, INVALID_DEFERRED_TOKEN);
+    EXPECT_TRUE(cancel_deferred_exec(stale));
+
+    for (int i = 0; i < UINT8_MAX; ++i) {
+        deferred_token fresh = defer_exec(100, record_once, NULL);
+        ASSERT_NE(fresh, INVALID_DEFERRED_TOKEN);
+        ASSERT_NE(fresh, stale) << "reuse " << i;
+        EXPECT_FALSE(cancel_deferred_exec(stale)) << "reuse " << i;
+        EXPECT_FALSE(extend_deferred_exec(stale, 10)) << "reuse " << i;
+        EXPECT_TRUE(cancel_deferred_exec(fresh));
+    }
+}
+
+TEST_F(DeferredExec, CancelAndExtend) {
+    uint32_t start = timer_read32();
+    for (uintptr_t i = 0; i < TIMER_COUNT; ++i) {
+        tokens.push_back(defer_exec(1 + i % 500, record_once, (void *)i));
+    }
+
+    // Cancel every third, push every fifth out past the rest
+    for (size_t i = 0; i < TIMER_COUNT; i += 3) {
+        EXPECT_TRUE(cancel_deferred_exec(tokens[i]));
+    }
+    for (size_t i = 1; i < TIMER_COUNT; i += 5) {
+        if (i % 3 != 0) {
+            EXPECT_TRUE(extend_deferred_exec(tokens[i], 1000));
+        }
+    }
+
+    run_until(start + 1001);
+
+    std::vector<int> seen(TIMER_COUNT, 0);
+    for (auto &f : fired) {
+        seen[f.id]++;
+        if (f.id % 5 == 1) {
+            EXPECT_EQ(f.trigger_time, start + 1000);
+        } else {
+            EXPECT_EQ(f.trigger_time, start + 1 + f.id % 500);
+        }
+    }
+    for (size_t i = 0; i < TIMER_COUNT; ++i) {
+        EXPECT_EQ(seen[i], i % 3 == 0 ? 0 : 1) << "timer " << i;
+    }
+}
+
+TEST_F(DeferredExec, RepeatingTimers) {
+    uint32_t start = timer_read32();
+    for (uintptr_t i = 0; i < 64; ++i) {
+        repeat_delays.push_back(1 + i);
+        tokens.push_back(defer_exec(1 + i, record_repeating, (void *)i));
+    }
+
+    run_until(start + 640);
+
+    std::vector<int> seen(64, 0);
+    for (auto &f : fired) {
+        seen[f.id]++;
+        EXPECT_EQ(f.now, f.trigger_time);
+    }
+    for (size_t i = 0; i < 64; ++i) {
+        EXPECT_EQ(seen[i], 640 / (i + 1)) << "timer " << i;
+    }
+}
+
+TEST_F(DeferredExec, OverdueTimersRunOncePerPass) {
+    uint32_t start = timer_read32();
+    repeat_delays.push_back(1);
+    repeat_delays.push_back(50);
+    tokens.push_back(defer_exec(1, record_repeating, (void *)0));
+    tokens.push_back(defer_exec(5, record_repeating, (void *)1));
+
+    // Stall the main loop well past both triggers
+    advance_time(100);
+    deferred_exec_task();
+
+    ASSERT_EQ(fired.size(), 2);
+    EXPECT_EQ(fired[0].id, 0);
+    EXPECT_EQ(fired[1].id, 1);
+
+    // The one millisecond timer stays behind, but must not starve the other
+    fired.clear();
+    run_until(start + 160);
+    int fast_count = 0, slow_count = 0;
+    for (auto &f : fired) {
+        if (f.id == 0) {
+            fast_count++;
+        } else {
+            slow_count++;
+        }
+    }
+    EXPECT_EQ(fast_count, 60);
+    EXPECT_EQ(slow_count, 3);
+}
+
+TEST_F(DeferredExec, CallbackReschedules) {
+    static deferred_token chained;
+    static int            chain_count;
+    chain_count = 0;
+
+    auto chain = [](uint32_t trigger_time, void *cb_arg) -> uint32_t {
+        // Cancel ourselves and queue a replacement, then ask to repeat -- the repeat must be ignored
+        cancel_deferred_exec(chained);
+        if (++chain_count < 10) {
+            chained = defer_exec(3, (deferred_exec_callback)cb_arg, cb_arg);
+        }
+        return 1;
+    };
+
+    uint32_t start = timer_read32();
+    chained        = defer_exec(3, chain, (void *)(deferred_exec_callback)chain);
+    run_until(start + 100);
+    EXPECT_EQ(chain_count, 10);
+}
+
+TEST_F(DeferredExec, IdleCost) {
+    using clock = std::chrono::steady_clock;
+
+    for (uintptr_t i = 0; i < TIMER_COUNT; ++i) {
+        tokens.push_back(defer_exec(1000000 + i, record_once, (void *)i));
+    }
+
+    const unsigned iterations = 100000;
+    auto           begin      = clock::now();
+    for (unsigned n = 0; n < iterations; ++n) {
+        advance_time(1);
+        deferred_exec_task();
+    }
+    auto idle_time = clock::now() - begin;
+
+    begin = clock::now();
+    for (unsigned n = 0; n < 1000; ++n) {
+        deferred_token token = defer_exec(1 + n, record_once, NULL);
+        EXPECT_TRUE(cancel_deferred_exec(tokens[n]));
+        tokens[n] = token;
+    }
+    auto churn_time = clock::now() - begin;
+
+    std::cout << "[ BENCHMARK] " << TIMER_COUNT << " timers: " << std::chrono::duration_cast<std::chrono::nanoseconds>(idle_time).count() / iterations << " ns per idle task, " << std::chrono::duration_cast<std::chrono::nanoseconds>(churn_time).count() / 1000 << " ns per insert and cancel" << std::endl;
+    EXPECT_TRUE(fired.empty());
+}
@@ -0,0 +1,9 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "test_common.h"
+
+#define LAYER_STATE_32BIT
+#define LAYER_RESOLUTION_CACHE
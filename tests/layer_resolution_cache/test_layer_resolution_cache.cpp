@@ -0,0 +1,89 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Test the resolved layers cache, and measure key to action lookups against the number of layers.
+
+#include <chrono>
+#include <iostream>
+
+#include "keyboard_report_util.hpp"
+#include "test_common.hpp"
+
+using testing::_;
+using testing::InSequence;
+
+class LayerResolutionCache : public TestFixture {};
+
+TEST_F(LayerResolutionCache, FollowsLayerStateChanges) {
+    TestDriver driver;
+    InSequence s;
+    auto       key_a    = KeymapKey(0, 0, 0, KC_A);
+    auto       key_b    = KeymapKey(3, 0, 0, KC_B);
+    auto       key_trns = KeymapKey(5, 0, 0, KC_TRNS);
+
+    set_keymap({key_a, key_b, key_trns});
+
+    layer_on(3);
+    layer_on(5);
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 3);
+    EXPECT_REPORT(driver, (KC_B));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_key(key_a);
+    VERIFY_AND_CLEAR(driver);
+
+    layer_off(3);
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 0);
+    EXPECT_REPORT(driver, (KC_A));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_key(key_a);
+    VERIFY_AND_CLEAR(driver);
+
+    default_layer_set((layer_state_t)1 << 3);
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 3);
+    default_layer_set(1);
+}
+
+TEST_F(LayerResolutionCache, FollowsKeymapChanges) {
+    auto key_a    = KeymapKey(0, 0, 0, KC_A);
+    auto key_trns = KeymapKey(2, 0, 0, KC_TRNS);
+
+    set_keymap({key_a, key_trns});
+
+    layer_on(2);
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 0);
+
+    // The fixture invalidates the cache when the keymap changes, like dynamic keymaps do
+    set_keymap({key_a, KeymapKey(2, 0, 0, KC_B)});
+    EXPECT_EQ(layer_switch_get_layer(key_a.position), 2);
+    layer_off(2);
+}
+
+TEST_F(LayerResolutionCache, BenchmarkKeyToActionByLayerCount) {
+    using clock             = std::chrono::steady_clock;
+    const int     lookups   = 10000;
+    const keypos_t position = {.col = 0, .row = 0};
+
+    for (uint8_t layer_count = 1; layer_count <= MAX_LAYER; layer_count *= 2) {
+        set_keymap({KeymapKey(0, 0, 0, KC_A)});
+        for (uint8_t layer = 1; layer < layer_count; layer++) {
+            add_key(KeymapKey(layer, 0, 0, KC_TRNS));
+        }
+        layer_state_set(((layer_state_t)-1 >> (MAX_LAYER - layer_count)) & ~(layer_state_t)1);
+
+        auto start = clock::now();
+        for (int i = 0; i < lookups; i++) {
+            layer_resolution_cache_invalidate();
+            EXPECT_EQ(store_or_get_action(true, position).key.code, KC_A);
+        }
+        auto uncached = clock::now() - start;
+
+        start = clock::now();
+        for (int i = 0; i < lookups; i++) {
+            EXPECT_EQ(store_or_get_action(true, position).key.code, KC_A);
+        }
+        auto cached = clock::now() - start;
+
+        std::cout << "[ BENCHMARK] " << +layer_count << " layers: " << std::chrono::duration_cast<std::chrono::nanoseconds>(uncached).count() / lookups << " ns uncached, " << std::chrono::duration_cast<std::chrono::nanoseconds>(cached).count() / lookups << " ns cached per key to action lookup" << std::endl;
+    }
+    layer_clear();
+}
@@ -100,6 +100,7 @@ void TestFixture::add_key(KeymapKey key) {
     }
 
     this->keymap.push_back(key);
+    layer_resolution_cache_invalidate();
 }
 
 void TestFixture::tap_key(KeymapKey key, unsigned delay_ms) {
@@ -127,6 +128,7 @@ void TestFixture::tap_combo(const std::vector<KeymapKey>& chord_keys, unsigned d
 
 void TestFixture::set_keymap(std::initializer_list<KeymapKey> keys) {
     this->keymap.clear();
+    layer_resolution_cache_invalidate();
     for (auto& key : keys) {
         add_key(key);
     }
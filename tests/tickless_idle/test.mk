@@ -0,0 +1,6 @@
+# Copyright 2023 QMK
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+TICKLESS_IDLE_ENABLE = yes
+CAPS_WORD_ENABLE = yes
+DEFERRED_EXEC_ENABLE = yes
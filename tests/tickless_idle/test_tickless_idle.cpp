@@ -0,0 +1,130 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Test the next deadline reporting used by tickless idle.
+
+#include "action_util.h"
+#include "keyboard_report_util.hpp"
+#include "test_common.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+
+static uint32_t user_deadline = DEADLINE_NONE;
+
+extern "C" uint32_t next_deadline_user(void) {
+    return user_deadline;
+}
+
+static uint32_t deferred_callback(uint32_t trigger_time, void *cb_arg) {
+    return 0;
+}
+
+class TicklessIdle : public TestFixture {};
+
+TEST_F(TicklessIdle, NothingPendingWhenIdle) {
+    TestDriver driver;
+
+    EXPECT_NO_REPORT(driver);
+    idle_for(10);
+    EXPECT_EQ(action_next_deadline(), DEADLINE_NONE);
+    EXPECT_EQ(keyboard_next_deadline(), DEADLINE_NONE);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(TicklessIdle, ModTapHoldStillResolves) {
+    TestDriver driver;
+    InSequence s;
+    auto       mod_tap_key = KeymapKey(0, 1, 0, SFT_T(KC_P));
+
+    set_keymap({mod_tap_key});
+
+    EXPECT_NO_REPORT(driver);
+    mod_tap_key.press();
+    run_one_scan_loop();
+    EXPECT_GT(action_next_deadline(), 0);
+    EXPECT_LE(action_next_deadline(), TAPPING_TERM);
+    VERIFY_AND_CLEAR(driver);
+
+    // The hold is only decided by the tick at the end of the tapping term
+    EXPECT_REPORT(driver, (KC_LSFT));
+    idle_for(TAPPING_TERM);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_EMPTY_REPORT(driver);
+    mod_tap_key.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_EQ(action_next_deadline(), DEADLINE_NONE);
+}
+
+TEST_F(TicklessIdle, ModTapTapStillResolves) {
+    TestDriver driver;
+    InSequence s;
+    auto       mod_tap_key = KeymapKey(0, 1, 0, SFT_T(KC_P));
+
+    set_keymap({mod_tap_key});
+
+    EXPECT_NO_REPORT(driver);
+    mod_tap_key.press();
+    idle_for(TAPPING_TERM - 1);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_P));
+    EXPECT_EMPTY_REPORT(driver);
+    mod_tap_key.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    // Waiting out the tapping term for a second tap
+    EXPECT_NO_REPORT(driver);
+    idle_for(TAPPING_TERM);
+    EXPECT_EQ(action_next_deadline(), DEADLINE_NONE);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(TicklessIdle, OneShotModTimesOut) {
+    TestDriver driver;
+    auto       osm_key     = KeymapKey(0, 0, 0, OSM(MOD_LSFT), KC_LSFT);
+    auto       regular_key = KeymapKey(0, 1, 0, KC_A);
+
+    set_keymap({osm_key, regular_key});
+
+    EXPECT_NO_REPORT(driver);
+    tap_key(osm_key);
+    EXPECT_GT(action_next_deadline(), 0);
+    EXPECT_LE(action_next_deadline(), ONESHOT_TIMEOUT);
+    idle_for(ONESHOT_TIMEOUT);
+    EXPECT_EQ(get_oneshot_mods(), 0);
+    EXPECT_EQ(action_next_deadline(), DEADLINE_NONE);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_A));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_key(regular_key);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(TicklessIdle, FeatureDeadlines) {
+    TestDriver driver;
+    EXPECT_ANY_REPORT(driver).Times(AnyNumber());
+
+    caps_word_on();
+    EXPECT_EQ(keyboard_next_deadline(), CAPS_WORD_IDLE_TIMEOUT);
+    caps_word_off();
+    EXPECT_EQ(keyboard_next_deadline(), DEADLINE_NONE);
+
+    deferred_token token = defer_exec(100, deferred_callback, NULL);
+    EXPECT_EQ(keyboard_next_deadline(), 100);
+    idle_for(40);
+    EXPECT_EQ(keyboard_next_deadline(), 60);
+    cancel_deferred_exec(token);
+    EXPECT_EQ(keyboard_next_deadline(), DEADLINE_NONE);
+
+    user_deadline = 42;
+    EXPECT_EQ(keyboard_next_deadline(), 42);
+    user_deadline = DEADLINE_NONE;
+    VERIFY_AND_CLEAR(driver);
+}
@@ -59,9 +59,10 @@ uint8_t keyboard_leds(void);
 void    send_keyboard(report_keyboard_t *report);
 void    send_mouse(report_mouse_t *report);
 void    send_extra(report_extra_t *report);
+bool    mouse_ready(void);
 
 /* host struct */
-host_driver_t chibios_driver = {keyboard_leds, send_keyboard, send_mouse, send_extra};
+host_driver_t chibios_driver = {keyboard_leds, send_keyboard, send_mouse, send_extra, mouse_ready};
 
 #ifdef VIRTSER_ENABLE
 void virtser_task(void);
@@ -205,6 +206,7 @@ void protocol_pre_task(void) {
 void protocol_post_task(void) {
 #ifdef CONSOLE_ENABLE
     console_task();
+    usb_report_queue_stats_task();
 #endif
 #ifdef MIDI_ENABLE
     midi_ep_task();
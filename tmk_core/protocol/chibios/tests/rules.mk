@@ -0,0 +1,6 @@
+usb_report_queue_DEFS := -DMATRIX_ROWS=1 -DMATRIX_COLS=1
+usb_report_queue_INC := $(TMK_PATH)/protocol $(TMK_PATH)/protocol/chibios
+
+usb_report_queue_SRC := \
+	$(TMK_PATH)/protocol/chibios/tests/usb_report_queue_tests.cpp \
+	$(TMK_PATH)/protocol/chibios/usb_report_queue.c
@@ -0,0 +1,303 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "usb_report_queue.h"
+}
+
+namespace {
+
+report_keyboard_t keys(uint8_t mods, std::initializer_list<uint8_t> pressed) {
+    report_keyboard_t report = {};
+    report.mods              = mods;
+    int i                    = 0;
+    for (uint8_t key : pressed) {
+        report.keys[i++] = key;
+    }
+    return report;
+}
+
+report_mouse_t mouse(uint8_t buttons, int8_t x, int8_t y) {
+    report_mouse_t report = {};
+    report.buttons        = buttons;
+    report.x              = x;
+    report.y              = y;
+    return report;
+}
+
+class UsbReportQueue : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        usb_report_queue_init(&queue);
+    }
+
+    // Stages a keyboard report, recording it if it was to be transmitted straight away
+    void push_keys(const report_keyboard_t &report) {
+        record(usb_report_queue_push(&queue, USB_REPORT_KEYS, 0, &report, sizeof(report)));
+    }
+
+    void push_mouse(const report_mouse_t &report) {
+        record(usb_report_queue_push(&queue, USB_REPORT_MOUSE, 0, &report, sizeof(report)));
+    }
+
+    // Completes every transmission, as the host polls
+    void drain(void) {
+        while (queue.busy) {
+            record(usb_report_queue_transmitted(&queue));
+        }
+    }
+
+    void record(const usb_report_t *report) {
+        if (report) {
+            sent.emplace_back(report->data, report->data + report->size);
+        }
+    }
+
+    template <typename T>
+    std::vector<uint8_t> bytes(const T &report) {
+        return std::vector<uint8_t>((const uint8_t *)&report, (const uint8_t *)&report + sizeof(report));
+    }
+
+    usb_report_queue_t                queue;
+    std::vector<std::vector<uint8_t>> sent;
+};
+
+} // namespace
+
+TEST_F(UsbReportQueue, IdleEndpointTransmitsStraightAway) {
+    push_keys(keys(0, {0x04}));
+    ASSERT_EQ(1u, sent.size());
+    EXPECT_EQ(bytes(keys(0, {0x04})), sent[0]);
+    EXPECT_TRUE(queue.busy);
+
+    drain();
+    EXPECT_FALSE(queue.busy);
+    EXPECT_EQ(1u, sent.size());
+}
+
+TEST_F(UsbReportQueue, TapIsNotMerged) {
+    push_keys(keys(0, {}));
+    push_keys(keys(0, {0x04}));
+    push_keys(keys(0, {}));
+    drain();
+    ASSERT_EQ(3u, sent.size());
+    EXPECT_EQ(bytes(keys(0, {0x04})), sent[1]);
+    EXPECT_EQ(bytes(keys(0, {})), sent[2]);
+    EXPECT_EQ(0u, queue.coalesced);
+}
+
+TEST_F(UsbReportQueue, PressOrderIsPreserved) {
+    push_keys(keys(0, {}));
+    push_keys(keys(0, {0x05}));
+    push_keys(keys(0, {0x05, 0x04}));
+    drain();
+    ASSERT_EQ(3u, sent.size());
+    EXPECT_EQ(bytes(keys(0, {0x05})), sent[1]);
+}
+
+TEST_F(UsbReportQueue, ShiftReleasedAfterPressIsNotMerged) {
+    push_keys(keys(0, {}));
+    push_keys(keys(0x02, {}));
+    push_keys(keys(0x02, {0x04}));
+    push_keys(keys(0, {0x04}));
+    drain();
+    ASSERT_EQ(4u, sent.size());
+    EXPECT_EQ(bytes(keys(0x02, {0x04})), sent[2]);
+}
+
+TEST_F(UsbReportQueue, ReleasesAreMerged) {
+    push_keys(keys(0x02, {0x04, 0x05}));
+    push_keys(keys(0x02, {0x05}));
+    push_keys(keys(0, {0x05}));
+    push_keys(keys(0, {}));
+    drain();
+    ASSERT_EQ(2u, sent.size());
+    EXPECT_EQ(bytes(keys(0, {})), sent[1]);
+    EXPECT_EQ(2u, queue.coalesced);
+}
+
+TEST_F(UsbReportQueue, PressAfterReleaseIsMerged) {
+    push_keys(keys(0x02, {0x04}));
+    push_keys(keys(0, {0x04}));
+    push_keys(keys(0, {0x04, 0x05}));
+    drain();
+    ASSERT_EQ(2u, sent.size());
+    EXPECT_EQ(bytes(keys(0, {0x04, 0x05})), sent[1]);
+}
+
+TEST_F(UsbReportQueue, RepressIsNotMerged) {
+    push_keys(keys(0, {0x04, 0x05}));
+    push_keys(keys(0, {0x05}));
+    push_keys(keys(0, {0x05, 0x04}));
+    drain();
+    ASSERT_EQ(3u, sent.size());
+}
+
+TEST_F(UsbReportQueue, DuplicatesAreMerged) {
+    push_keys(keys(0, {}));
+    push_keys(keys(0, {0x04}));
+    push_keys(keys(0, {0x04}));
+    drain();
+    ASSERT_EQ(2u, sent.size());
+    EXPECT_EQ(1u, queue.coalesced);
+}
+
+TEST_F(UsbReportQueue, MouseMotionIsSummed) {
+    push_mouse(mouse(0, 1, 1));
+    push_mouse(mouse(0, 2, -3));
+    push_mouse(mouse(0, 3, -4));
+    push_mouse(mouse(1, 1, 0));
+    push_mouse(mouse(1, 100, 0));
+    push_mouse(mouse(1, 100, 0));
+    drain();
+    ASSERT_EQ(4u, sent.size());
+    EXPECT_EQ(bytes(mouse(0, 5, -7)), sent[1]);
+    EXPECT_EQ(bytes(mouse(1, 101, 0)), sent[2]);
+    EXPECT_EQ(bytes(mouse(1, 100, 0)), sent[3]); // would have overflowed
+}
+
+TEST_F(UsbReportQueue, FullQueueKeepsLatestState) {
+    push_keys(keys(0, {}));
+    for (uint8_t i = 0; i < USB_REPORT_QUEUE_DEPTH + 2; i++) {
+        push_keys(keys(0, {0x04}));
+        push_keys(keys(0, {}));
+    }
+    push_keys(keys(0, {0x07}));
+    EXPECT_EQ(USB_REPORT_QUEUE_DEPTH, queue.count);
+    EXPECT_LT(0u, queue.dropped);
+
+    drain();
+    EXPECT_EQ(bytes(keys(0, {0x07})), sent.back());
+}
+
+TEST_F(UsbReportQueue, SharedEndpointStreamsAreKeptApart) {
+    report_extra_t system   = {3, 0};
+    report_extra_t consumer = {4, 0x00E9};
+    record(usb_report_queue_push(&queue, USB_REPORT_VALUE, system.report_id, &system, sizeof(system)));
+    record(usb_report_queue_push(&queue, USB_REPORT_VALUE, consumer.report_id, &consumer, sizeof(consumer)));
+    consumer.usage = 0;
+    record(usb_report_queue_push(&queue, USB_REPORT_VALUE, consumer.report_id, &consumer, sizeof(consumer)));
+    system.usage = 0x81;
+    record(usb_report_queue_push(&queue, USB_REPORT_VALUE, system.report_id, &system, sizeof(system)));
+    drain();
+    ASSERT_EQ(4u, sent.size());
+    EXPECT_EQ(0u, queue.coalesced);
+}
+
+TEST_F(UsbReportQueue, UsageChangeIsNotMerged) {
+    report_extra_t consumer = {4, 0x00EA};
+    record(usb_report_queue_push(&queue, USB_REPORT_VALUE, consumer.report_id, &consumer, sizeof(consumer)));
+    consumer.usage = 0x00E2;
+    record(usb_report_queue_push(&queue, USB_REPORT_VALUE, consumer.report_id, &consumer, sizeof(consumer)));
+    consumer.usage = 0;
+    record(usb_report_queue_push(&queue, USB_REPORT_VALUE, consumer.report_id, &consumer, sizeof(consumer)));
+    drain();
+    ASSERT_EQ(3u, sent.size());
+    EXPECT_EQ(0x00E2, ((const report_extra_t *)sent[1].data())->usage);
+    EXPECT_EQ(0, ((const report_extra_t *)sent[2].data())->usage);
+    EXPECT_EQ(0u, queue.coalesced);
+}
+
+TEST_F(UsbReportQueue, UnchangedValueIsMerged) {
+    report_extra_t consumer = {4, 0x00EA};
+    record(usb_report_queue_push(&queue, USB_REPORT_VALUE, consumer.report_id, &consumer, sizeof(consumer)));
+    record(usb_report_queue_push(&queue, USB_REPORT_VALUE, consumer.report_id, &consumer, sizeof(consumer)));
+    consumer.usage = 0;
+    record(usb_report_queue_push(&queue, USB_REPORT_VALUE, consumer.report_id, &consumer, sizeof(consumer)));
+    drain();
+    ASSERT_EQ(2u, sent.size());
+    EXPECT_EQ(0, ((const report_extra_t *)sent[1].data())->usage);
+}
+
+// A shared endpoint full of other reports must still deliver the key release
+TEST_F(UsbReportQueue, FullQueueMakesRoomForAnotherStream) {
+    push_keys(keys(0, {0x04}));
+    for (uint8_t i = 0; i < USB_REPORT_QUEUE_DEPTH; i++) {
+        report_extra_t consumer = {4, (uint16_t)(0x00E0 + i)};
+        record(usb_report_queue_push(&queue, USB_REPORT_VALUE, consumer.report_id, &consumer, sizeof(consumer)));
+        push_mouse(mouse(i % 2, 1, 0));
+    }
+    EXPECT_EQ(USB_REPORT_QUEUE_DEPTH, queue.count);
+
+    push_keys(keys(0, {}));
+    drain();
+    EXPECT_EQ(bytes(keys(0, {})), sent.back());
+    EXPECT_LT(0u, queue.dropped);
+
+    // The last of each stream made it, and no motion was lost
+    report_extra_t consumer = {4, (uint16_t)(0x00E0 + USB_REPORT_QUEUE_DEPTH - 1)};
+    int            motion   = 0;
+    bool           seen     = false;
+    for (const auto &report : sent) {
+        if (report.size() == sizeof(report_mouse_t)) {
+            motion += ((const report_mouse_t *)report.data())->x;
+        } else if (report == bytes(consumer)) {
+            seen = true;
+        }
+    }
+    EXPECT_TRUE(seen);
+    EXPECT_EQ(USB_REPORT_QUEUE_DEPTH, motion);
+}
+
+// Typing far faster than anyone can, with the host polling every eighth scan: the host must see every press and release
+TEST_F(UsbReportQueue, HostSeesEveryTransition) {
+    uint32_t          state = 0x12345678;
+    report_keyboard_t held  = {};
+    int               presses[256] = {}, releases[256] = {};
+
+    push_keys(held);
+    for (int scan = 0; scan < 20000; scan++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        if (state % 16 == 0) {
+            uint8_t key  = 0x04 + (state >> 8) % 8;
+            int     slot = -1;
+            for (int i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+                if (held.keys[i] == key) {
+                    slot = i;
+                }
+            }
+            if (slot >= 0) {
+                held.keys[slot] = 0;
+                releases[key]++;
+            } else {
+                for (int i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+                    if (!held.keys[i]) {
+                        held.keys[i] = key;
+                        presses[key]++;
+                        break;
+                    }
+                }
+            }
+            push_keys(held);
+        }
+        if (scan % 8 == 7 && queue.busy) {
+            record(usb_report_queue_transmitted(&queue));
+        }
+    }
+    drain();
+    ASSERT_EQ(0u, queue.dropped);
+    EXPECT_LT(0u, queue.coalesced);
+    EXPECT_EQ(bytes(held), sent.back());
+
+    int seen_presses[256] = {}, seen_releases[256] = {};
+    for (size_t i = 1; i < sent.size(); i++) {
+        for (uint8_t key = 0x04; key < 0x0C; key++) {
+            bool before = memchr(&sent[i - 1][2], key, KEYBOARD_REPORT_KEYS);
+            bool after  = memchr(&sent[i][2], key, KEYBOARD_REPORT_KEYS);
+            seen_presses[key] += !before && after;
+            seen_releases[key] += before && !after;
+        }
+    }
+    for (uint8_t key = 0x04; key < 0x0C; key++) {
+        EXPECT_EQ(presses[key], seen_presses[key]) << "key " << (int)key;
+        EXPECT_EQ(releases[key], seen_releases[key]) << "key " << (int)key;
+    }
+}
@@ -43,6 +43,8 @@
 #include "usb_device_state.h"
 #include "usb_descriptor.h"
 #include "usb_driver.h"
+#include "usb_report_queue.h"
+#include "timer.h"
 
 #ifdef NKRO_ENABLE
 #    include "keycode_config.h"
@@ -103,6 +105,59 @@ union {
             NULL, /* SETUP buffer (not a SETUP endpoint) */
 #endif
 
+/* Report IDs of reports which may be sent on the shared endpoint, 0 otherwise */
+#ifdef KEYBOARD_SHARED_EP
+#    define KEYBOARD_REPORT_ID REPORT_ID_KEYBOARD
+#else
+#    define KEYBOARD_REPORT_ID 0
+#endif
+#ifdef MOUSE_SHARED_EP
+#    define MOUSE_REPORT_ID REPORT_ID_MOUSE
+#else
+#    define MOUSE_REPORT_ID 0
+#endif
+#ifdef JOYSTICK_SHARED_EP
+#    define JOYSTICK_REPORT_ID REPORT_ID_JOYSTICK
+#else
+#    define JOYSTICK_REPORT_ID 0
+#endif
+#ifdef DIGITIZER_SHARED_EP
+#    define DIGITIZER_REPORT_ID REPORT_ID_DIGITIZER
+#else
+#    define DIGITIZER_REPORT_ID 0
+#endif
+
+/* Reports which may be waiting on the shared endpoint at the same time */
+enum shared_ep_streams {
+#ifdef KEYBOARD_SHARED_EP
+    SHARED_STREAM_KEYBOARD_BOOT,
+    SHARED_STREAM_KEYBOARD,
+#endif
+#ifdef NKRO_ENABLE
+    SHARED_STREAM_NKRO,
+#endif
+#if defined(MOUSE_ENABLE) && defined(MOUSE_SHARED_EP)
+    SHARED_STREAM_MOUSE,
+#endif
+#ifdef EXTRAKEY_ENABLE
+    SHARED_STREAM_SYSTEM,
+    SHARED_STREAM_CONSUMER,
+#endif
+#ifdef PROGRAMMABLE_BUTTON_ENABLE
+    SHARED_STREAM_PROGRAMMABLE_BUTTON,
+#endif
+#if defined(JOYSTICK_ENABLE) && defined(JOYSTICK_SHARED_EP)
+    SHARED_STREAM_JOYSTICK,
+#endif
+#if defined(DIGITIZER_ENABLE) && defined(DIGITIZER_SHARED_EP)
+    SHARED_STREAM_DIGITIZER,
+#endif
+    SHARED_EP_STREAMS,
+};
+
+// Otherwise the latest state of every report can't be guaranteed to reach the host
+_Static_assert(USB_REPORT_QUEUE_DEPTH >= SHARED_EP_STREAMS, "USB_REPORT_QUEUE_DEPTH must be at least the number of reports sharing an endpoint");
+
 /* HID specific constants */
 #define HID_GET_REPORT 0x01
 #define HID_GET_IDLE 0x02
@@ -130,23 +185,25 @@ static const USBDescriptor *usb_get_descriptor_cb(USBDriver *usbp, uint8_t dtype
 }
 
 /*
- * USB notification callback that does nothing.  Needed to work around bugs in
- * some USB LLDs that fail to resume the waiting thread when the notification
- * callback pointer is NULL.
+ * IN notification callback for the HID report endpoints, which sends the next
+ * queued report.
  */
-static void dummy_usb_cb(USBDriver *usbp, usbep_t ep) {
-    (void)usbp;
-    (void)ep;
-}
+static void report_transmitted_cb(USBDriver *usbp, usbep_t ep);
+
+#if SHARED_EPSIZE > USB_REPORT_QUEUE_REPORT_SIZE || KEYBOARD_EPSIZE > USB_REPORT_QUEUE_REPORT_SIZE
+#    error "USB_REPORT_QUEUE_REPORT_SIZE is too small for the HID report endpoints"
+#endif
 
 #ifndef KEYBOARD_SHARED_EP
 /* keyboard endpoint state structure */
 static USBInEndpointState kbd_ep_state;
+/* keyboard report queue */
+static usb_report_queue_t kbd_report_queue;
 /* keyboard endpoint initialization structure (IN) - see USBEndpointConfig comment at top of file */
 static const USBEndpointConfig kbd_ep_config = {
     USB_EP_MODE_TYPE_INTR,  /* Interrupt EP */
     NULL,                   /* SETUP packet notification callback */
-    dummy_usb_cb,           /* IN notification callback */
+    report_transmitted_cb,  /* IN notification callback */
     NULL,                   /* OUT notification callback */
     KEYBOARD_EPSIZE,        /* IN maximum packet size */
     0,                      /* OUT maximum packet size */
@@ -159,12 +216,14 @@ static const USBEndpointConfig kbd_ep_config = {
 #if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
 /* mouse endpoint state structure */
 static USBInEndpointState mouse_ep_state;
+/* mouse report queue */
+static usb_report_queue_t mouse_report_queue;
 
 /* mouse endpoint initialization structure (IN) - see USBEndpointConfig comment at top of file */
 static const USBEndpointConfig mouse_ep_config = {
     USB_EP_MODE_TYPE_INTR,  /* Interrupt EP */
     NULL,                   /* SETUP packet notification callback */
-    dummy_usb_cb,           /* IN notification callback */
+    report_transmitted_cb,  /* IN notification callback */
     NULL,                   /* OUT notification callback */
     MOUSE_EPSIZE,           /* IN maximum packet size */
     0,                      /* OUT maximum packet size */
@@ -177,12 +236,14 @@ static const USBEndpointConfig mouse_ep_config = {
 #ifdef SHARED_EP_ENABLE
 /* shared endpoint state structure */
 static USBInEndpointState shared_ep_state;
+/* shared report queue */
+static usb_report_queue_t shared_report_queue;
 
 /* shared endpoint initialization structure (IN) - see USBEndpointConfig comment at top of file */
 static const USBEndpointConfig shared_ep_config = {
     USB_EP_MODE_TYPE_INTR,  /* Interrupt EP */
     NULL,                   /* SETUP packet notification callback */
-    dummy_usb_cb,           /* IN notification callback */
+    report_transmitted_cb,  /* IN notification callback */
     NULL,                   /* OUT notification callback */
     SHARED_EPSIZE,          /* IN maximum packet size */
     0,                      /* OUT maximum packet size */
@@ -195,12 +256,14 @@ static const USBEndpointConfig shared_ep_config = {
 #if defined(JOYSTICK_ENABLE) && !defined(JOYSTICK_SHARED_EP)
 /* joystick endpoint state structure */
 static USBInEndpointState joystick_ep_state;
+/* joystick report queue */
+static usb_report_queue_t joystick_report_queue;
 
 /* joystick endpoint initialization structure (IN) - see USBEndpointConfig comment at top of file */
 static const USBEndpointConfig joystick_ep_config = {
     USB_EP_MODE_TYPE_INTR,  /* Interrupt EP */
     NULL,                   /* SETUP packet notification callback */
-    dummy_usb_cb,           /* IN notification callback */
+    report_transmitted_cb,  /* IN notification callback */
     NULL,                   /* OUT notification callback */
     JOYSTICK_EPSIZE,        /* IN maximum packet size */
     0,                      /* OUT maximum packet size */
@@ -213,12 +276,14 @@ static const USBEndpointConfig joystick_ep_config = {
 #if defined(DIGITIZER_ENABLE) && !defined(DIGITIZER_SHARED_EP)
 /* digitizer endpoint state structure */
 static USBInEndpointState digitizer_ep_state;
+/* digitizer report queue */
+static usb_report_queue_t digitizer_report_queue;
 
 /* digitizer endpoint initialization structure (IN) - see USBEndpointConfig comment at top of file */
 static const USBEndpointConfig digitizer_ep_config = {
     USB_EP_MODE_TYPE_INTR,  /* Interrupt EP */
     NULL,                   /* SETUP packet notification callback */
-    dummy_usb_cb,           /* IN notification callback */
+    report_transmitted_cb,  /* IN notification callback */
     NULL,                   /* OUT notification callback */
     DIGITIZER_EPSIZE,       /* IN maximum packet size */
     0,                      /* OUT maximum packet size */
@@ -228,6 +293,34 @@ static const USBEndpointConfig digitizer_ep_config = {
 };
 #endif
 
+/* Report queue of a HID report endpoint, NULL for any other endpoint */
+static usb_report_queue_t *report_queue_for(usbep_t ep) {
+    switch (ep) {
+#ifndef KEYBOARD_SHARED_EP
+        case KEYBOARD_IN_EPNUM:
+            return &kbd_report_queue;
+#endif
+#if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+        case MOUSE_IN_EPNUM:
+            return &mouse_report_queue;
+#endif
+#ifdef SHARED_EP_ENABLE
+        case SHARED_IN_EPNUM:
+            return &shared_report_queue;
+#endif
+#if defined(JOYSTICK_ENABLE) && !defined(JOYSTICK_SHARED_EP)
+        case JOYSTICK_IN_EPNUM:
+            return &joystick_report_queue;
+#endif
+#if defined(DIGITIZER_ENABLE) && !defined(DIGITIZER_SHARED_EP)
+        case DIGITIZER_IN_EPNUM:
+            return &digitizer_report_queue;
+#endif
+        default:
+            return NULL;
+    }
+}
+
 #ifdef USB_ENDPOINTS_ARE_REORDERABLE
 typedef struct {
     size_t              queue_capacity_in;
@@ -506,6 +599,13 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
 
         case USB_EVENT_CONFIGURED:
             osalSysLockFromISR();
+            /* Any transmissions in progress were aborted */
+            for (usbep_t ep = 1; ep <= MAX_ENDPOINTS; ep++) {
+                usb_report_queue_t *queue = report_queue_for(ep);
+                if (queue) {
+                    usb_report_queue_init(queue);
+                }
+            }
             /* Enable the endpoints specified into the configuration. */
 #ifndef KEYBOARD_SHARED_EP
             usbInitEndpointI(usbp, KEYBOARD_IN_EPNUM, &kbd_ep_config);
@@ -821,6 +921,66 @@ __attribute__((weak)) void restart_usb_driver(USBDriver *usbp) {
  * ---------------------------------------------------------
  */
 
+/* Stages a report, starting its transmission straight away if the endpoint is
+ * free. Never waits for the endpoint: see usb_report_queue.h.
+ * must be called from a locked state */
+static void send_report_I(uint8_t endpoint, usb_report_kind_t kind, uint8_t report_id, void *report, size_t size) {
+    const usb_report_t *next = usb_report_queue_push(report_queue_for(endpoint), kind, report_id, report, size);
+    if (next) {
+        usbStartTransmitI(&USB_DRIVER, endpoint, next->data, next->size);
+    }
+}
+
+void send_report(uint8_t endpoint, usb_report_kind_t kind, uint8_t report_id, void *report, size_t size) {
+    osalSysLock();
+    if (usbGetDriverStateI(&USB_DRIVER) == USB_ACTIVE) {
+        send_report_I(endpoint, kind, report_id, report, size);
+    }
+    osalSysUnlock();
+}
+
+/* IN transfer complete callback (called from ISR, unlocked state) */
+static void report_transmitted_cb(USBDriver *usbp, usbep_t ep) {
+    osalSysLockFromISR();
+    const usb_report_t *next = usb_report_queue_transmitted(report_queue_for(ep));
+    if (next) {
+        usbStartTransmitI(usbp, ep, next->data, next->size);
+    }
+    osalSysUnlockFromISR();
+}
+
+#ifdef CONSOLE_ENABLE
+/* Prints the report queue counters when they have changed, at most once a second */
+void usb_report_queue_stats_task(void) {
+    static uint32_t last_print = 0;
+    static uint32_t last_total = 0;
+
+    if (timer_elapsed32(last_print) < 1000) {
+        return;
+    }
+    last_print = timer_read32();
+
+    uint32_t total = 0;
+    for (usbep_t ep = 1; ep <= MAX_ENDPOINTS; ep++) {
+        usb_report_queue_t *queue = report_queue_for(ep);
+        if (queue) {
+            total += queue->coalesced + queue->dropped;
+        }
+    }
+    if (total == last_total) {
+        return;
+    }
+    last_total = total;
+
+    for (usbep_t ep = 1; ep <= MAX_ENDPOINTS; ep++) {
+        usb_report_queue_t *queue = report_queue_for(ep);
+        if (queue) {
+            dprintf("usb ep%u reports: %u coalesced, %u dropped\n", ep, queue->coalesced, queue->dropped);
+        }
+    }
+}
+#endif
+
 /* Idle requests timer code
  * callback (called from ISR, unlocked state) */
 static void keyboard_idle_timer_cb(struct ch_virtual_timer *timer, void *arg) {
@@ -842,8 +1002,8 @@ static void keyboard_idle_timer_cb(struct ch_virtual_timer *timer, void *arg) {
     if (keyboard_idle && keyboard_protocol) {
 #endif /* NKRO_ENABLE */
         /* TODO: are we sure we want the KBD_ENDPOINT? */
-        if (!usbGetTransmitStatusI(usbp, KEYBOARD_IN_EPNUM)) {
-            usbStartTransmitI(usbp, KEYBOARD_IN_EPNUM, (uint8_t *)&keyboard_report_sent, KEYBOARD_EPSIZE);
+        if (!report_queue_for(KEYBOARD_IN_EPNUM)->busy) {
+            send_report_I(KEYBOARD_IN_EPNUM, USB_REPORT_KEYS, KEYBOARD_REPORT_ID, &keyboard_report_sent, KEYBOARD_REPORT_SIZE);
         }
         /* rearm the timer */
         chVTSetI(&keyboard_idle_timer, 4 * TIME_MS2I(keyboard_idle), keyboard_idle_timer_cb, (void *)usbp);
@@ -859,27 +1019,6 @@ uint8_t keyboard_leds(void) {
     return keyboard_led_state;
 }
 
-void send_report(uint8_t endpoint, void *report, size_t size) {
-    osalSysLock();
-    if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-        osalSysUnlock();
-        return;
-    }
-
-    if (usbGetTransmitStatusI(&USB_DRIVER, endpoint)) {
-        /* Need to either suspend, or loop and call unlock/lock during
-         * every iteration - otherwise the system will remain locked,
-         * no interrupts served, so USB not going through as well.
-         * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-        if (osalThreadSuspendTimeoutS(&(&USB_DRIVER)->epc[endpoint]->in_state->thread, TIME_MS2I(10)) == MSG_TIMEOUT) {
-            osalSysUnlock();
-            return;
-        }
-    }
-    usbStartTransmitI(&USB_DRIVER, endpoint, report, size);
-    osalSysUnlock();
-}
-
 /* prepare and start sending a report IN
  * not callable from ISR or locked state */
 void send_keyboard(report_keyboard_t *report) {
@@ -888,16 +1027,20 @@ void send_keyboard(report_keyboard_t *report) {
 
     /* If we're in Boot Protocol, don't send any report ID or other funky fields */
     if (!keyboard_protocol) {
-        send_report(ep, &report->mods, 8);
+        send_report(ep, USB_REPORT_KEYS, 0, &report->mods, 8);
     } else {
+        usb_report_kind_t kind      = USB_REPORT_KEYS;
+        uint8_t           report_id = KEYBOARD_REPORT_ID;
 #ifdef NKRO_ENABLE
         if (keymap_config.nkro) {
-            ep   = SHARED_IN_EPNUM;
-            size = sizeof(struct nkro_report);
+            ep        = SHARED_IN_EPNUM;
+            size      = sizeof(struct nkro_report);
+            kind      = USB_REPORT_BITMAP;
+            report_id = REPORT_ID_NKRO;
         }
 #endif
 
-        send_report(ep, report, size);
+        send_report(ep, kind, report_id, report, size);
     }
 
     keyboard_report_sent = *report;
@@ -910,11 +1053,20 @@ void send_keyboard(report_keyboard_t *report) {
 
 void send_mouse(report_mouse_t *report) {
 #ifdef MOUSE_ENABLE
-    send_report(MOUSE_IN_EPNUM, report, sizeof(report_mouse_t));
+    send_report(MOUSE_IN_EPNUM, USB_REPORT_MOUSE, MOUSE_REPORT_ID, report, sizeof(report_mouse_t));
     mouse_report_sent = *report;
 #endif
 }
 
+/* Whether a mouse report would be transmitted straight away, rather than queued */
+bool mouse_ready(void) {
+#ifdef MOUSE_ENABLE
+    return !report_queue_for(MOUSE_IN_EPNUM)->busy;
+#else
+    return true;
+#endif
+}
+
 /* ---------------------------------------------------------
  *                   Extrakey functions
  * ---------------------------------------------------------
@@ -922,25 +1074,25 @@ void send_mouse(report_mouse_t *report) {
 
 void send_extra(report_extra_t *report) {
 #ifdef EXTRAKEY_ENABLE
-    send_report(SHARED_IN_EPNUM, report, sizeof(report_extra_t));
+    send_report(SHARED_IN_EPNUM, USB_REPORT_VALUE, report->report_id, report, sizeof(report_extra_t));
 #endif
 }
 
 void send_programmable_button(report_programmable_button_t *report) {
 #ifdef PROGRAMMABLE_BUTTON_ENABLE
-    send_report(SHARED_IN_EPNUM, report, sizeof(report_programmable_button_t));
+    send_report(SHARED_IN_EPNUM, USB_REPORT_BITMAP, report->report_id, report, sizeof(report_programmable_button_t));
 #endif
 }
 
 void send_joystick(report_joystick_t *report) {
 #ifdef JOYSTICK_ENABLE
-    send_report(JOYSTICK_IN_EPNUM, report, sizeof(report_joystick_t));
+    send_report(JOYSTICK_IN_EPNUM, USB_REPORT_VALUE, JOYSTICK_REPORT_ID, report, sizeof(report_joystick_t));
 #endif
 }
 
 void send_digitizer(report_digitizer_t *report) {
 #ifdef DIGITIZER_ENABLE
-    send_report(DIGITIZER_IN_EPNUM, report, sizeof(report_digitizer_t));
+    send_report(DIGITIZER_IN_EPNUM, USB_REPORT_VALUE, DIGITIZER_REPORT_ID, report, sizeof(report_digitizer_t));
 #endif
 }
 
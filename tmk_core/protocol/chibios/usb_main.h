@@ -60,4 +60,7 @@ int8_t sendchar(uint8_t c);
 /* Flush output (send everything immediately) */
 void console_flush_output(void);
 
+/* Print the HID report queue counters when they change */
+void usb_report_queue_stats_task(void);
+
 #endif /* CONSOLE_ENABLE */
@@ -0,0 +1,197 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string.h>
+
+#include "usb_report_queue.h"
+
+#ifdef MOUSE_EXTENDED_REPORT
+#    define MOUSE_XY_MAX INT16_MAX
+#else
+#    define MOUSE_XY_MAX INT8_MAX
+#endif
+
+static inline int32_t clamp_axis(int32_t value, int32_t limit) {
+    return value > limit ? limit : (value < -limit ? -limit : value);
+}
+
+static inline bool axis_fits(int32_t value, int32_t limit) {
+    return value == clamp_axis(value, limit);
+}
+
+static inline usb_report_t *usb_report_queue_at(usb_report_queue_t *queue, uint8_t index) {
+    return &queue->pending[(queue->head + index) % USB_REPORT_QUEUE_DEPTH];
+}
+
+static inline bool usb_report_same_stream(const usb_report_t *report, usb_report_kind_t kind, uint8_t report_id, uint8_t size) {
+    return report->kind == kind && report->report_id == report_id && report->size == size;
+}
+
+void usb_report_queue_init(usb_report_queue_t *queue) {
+    memset(queue, 0, sizeof(usb_report_queue_t));
+}
+
+/* Most recent report from the same stream as the last waiting report, ahead of it in the queue, or NULL if unknown */
+static const usb_report_t *usb_report_queue_before_last(usb_report_queue_t *queue) {
+    const usb_report_t *last = usb_report_queue_at(queue, queue->count - 1);
+    for (int8_t i = queue->count - 2; i >= 0; --i) {
+        const usb_report_t *report = usb_report_queue_at(queue, i);
+        if (usb_report_same_stream(report, last->kind, last->report_id, last->size)) {
+            return report;
+        }
+    }
+    return usb_report_same_stream(&queue->sent, last->kind, last->report_id, last->size) ? &queue->sent : NULL;
+}
+
+/* Bits changed going from before to queued must all be releases, and untouched by next */
+static bool usb_report_bits_mergeable(const uint8_t *before, const uint8_t *queued, const uint8_t *next, uint8_t size) {
+    for (uint8_t i = 0; i < size; ++i) {
+        if ((queued[i] & ~before[i]) || ((before[i] ^ queued[i]) & (queued[i] ^ next[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool usb_report_has_key(const uint8_t *keys, uint8_t key) {
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; ++i) {
+        if (keys[i] == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* As above, for a 6KRO key array where the position of each key is irrelevant */
+static bool usb_report_keys_mergeable(const uint8_t *before, const uint8_t *queued, const uint8_t *next) {
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; ++i) {
+        if (queued[i] && !usb_report_has_key(before, queued[i])) {
+            return false; // pressed
+        }
+        if (before[i] && !usb_report_has_key(queued, before[i]) && usb_report_has_key(next, before[i])) {
+            return false; // released, then pressed again
+        }
+    }
+    return true;
+}
+
+static bool usb_report_mergeable(const usb_report_t *before, const usb_report_t *queued, const uint8_t *next) {
+    if (queued->kind == USB_REPORT_MOUSE) {
+        const report_mouse_t *mouse = (const report_mouse_t *)next;
+        return queued->mouse.buttons == mouse->buttons && axis_fits(queued->mouse.x + mouse->x, MOUSE_XY_MAX) && axis_fits(queued->mouse.y + mouse->y, MOUSE_XY_MAX) && axis_fits(queued->mouse.v + mouse->v, INT8_MAX) && axis_fits(queued->mouse.h + mouse->h, INT8_MAX);
+    }
+
+    if (memcmp(queued->data, next, queued->size) == 0) {
+        return true;
+    }
+    if (!before) {
+        return false;
+    }
+    if (queued->kind == USB_REPORT_VALUE) {
+        // Any change in a value is something the host needs to see, unless the waiting report changed nothing
+        return memcmp(before->data, queued->data, queued->size) == 0;
+    }
+    if (queued->kind == USB_REPORT_KEYS) {
+        uint8_t prefix = queued->size - KEYBOARD_REPORT_KEYS;
+        return usb_report_bits_mergeable(before->data, queued->data, next, prefix) && usb_report_keys_mergeable(&before->data[prefix], &queued->data[prefix], &next[prefix]);
+    }
+    return usb_report_bits_mergeable(before->data, queued->data, next, queued->size);
+}
+
+static void usb_report_merge(usb_report_t *queued, const uint8_t *next) {
+    if (queued->kind == USB_REPORT_MOUSE) {
+        const report_mouse_t *mouse = (const report_mouse_t *)next;
+        queued->mouse.buttons       = mouse->buttons;
+        queued->mouse.x             = clamp_axis(queued->mouse.x + mouse->x, MOUSE_XY_MAX);
+        queued->mouse.y             = clamp_axis(queued->mouse.y + mouse->y, MOUSE_XY_MAX);
+        queued->mouse.v             = clamp_axis(queued->mouse.v + mouse->v, INT8_MAX);
+        queued->mouse.h             = clamp_axis(queued->mouse.h + mouse->h, INT8_MAX);
+#ifdef MOUSE_EXTENDED_REPORT
+        queued->mouse.boot_x = clamp_axis(queued->mouse.x, 127);
+        queued->mouse.boot_y = clamp_axis(queued->mouse.y, 127);
+#endif
+    } else {
+        memcpy(queued->data, next, queued->size);
+    }
+}
+
+/* Makes room by dropping the oldest waiting report which has a later report from the same stream waiting behind it */
+static bool usb_report_queue_evict(usb_report_queue_t *queue) {
+    for (uint8_t i = 0; i + 1 < queue->count; ++i) {
+        usb_report_t *older = usb_report_queue_at(queue, i);
+        for (uint8_t j = i + 1; j < queue->count; ++j) {
+            usb_report_t *later = usb_report_queue_at(queue, j);
+            if (!usb_report_same_stream(later, older->kind, older->report_id, older->size)) {
+                continue;
+            }
+            if (older->kind == USB_REPORT_MOUSE) {
+                // Keep the motion, only the button state in between is lost
+                report_mouse_t buttons = later->mouse;
+                *later                 = *older;
+                usb_report_merge(later, (const uint8_t *)&buttons);
+            }
+            for (; i + 1 < queue->count; ++i) {
+                *usb_report_queue_at(queue, i) = *usb_report_queue_at(queue, i + 1);
+            }
+            queue->count--;
+            return true;
+        }
+    }
+    return false;
+}
+
+static const usb_report_t *usb_report_queue_pop(usb_report_queue_t *queue) {
+    if (queue->count == 0) {
+        queue->busy = false;
+        return NULL;
+    }
+    queue->sent = queue->pending[queue->head];
+    queue->head = (queue->head + 1) % USB_REPORT_QUEUE_DEPTH;
+    queue->count--;
+    queue->busy = true;
+    return &queue->sent;
+}
+
+const usb_report_t *usb_report_queue_push(usb_report_queue_t *queue, usb_report_kind_t kind, uint8_t report_id, const void *data, uint8_t size) {
+    if (size > USB_REPORT_QUEUE_REPORT_SIZE) {
+        queue->dropped++;
+        return NULL;
+    }
+
+    if (queue->count > 0) {
+        usb_report_t *last = usb_report_queue_at(queue, queue->count - 1);
+        if (usb_report_same_stream(last, kind, report_id, size) && usb_report_mergeable(usb_report_queue_before_last(queue), last, data)) {
+            usb_report_merge(last, data);
+            queue->coalesced++;
+            return NULL;
+        }
+
+        if (queue->count == USB_REPORT_QUEUE_DEPTH) {
+            // No room: overwrite the latest waiting report from this stream, so the host still ends up in this state
+            queue->dropped++;
+            for (int8_t i = queue->count - 1; i >= 0; --i) {
+                usb_report_t *report = usb_report_queue_at(queue, i);
+                if (usb_report_same_stream(report, kind, report_id, size)) {
+                    usb_report_merge(report, data);
+                    return NULL;
+                }
+            }
+            // Nothing from this stream is waiting, so it must be queued; drop a stale report from another stream
+            if (!usb_report_queue_evict(queue)) {
+                return NULL;
+            }
+        }
+    }
+
+    usb_report_t *slot = usb_report_queue_at(queue, queue->count++);
+    memcpy(slot->data, data, size);
+    slot->size      = size;
+    slot->kind      = kind;
+    slot->report_id = report_id;
+
+    return queue->busy ? NULL : usb_report_queue_pop(queue);
+}
+
+const usb_report_t *usb_report_queue_transmitted(usb_report_queue_t *queue) {
+    return usb_report_queue_pop(queue);
+}
@@ -0,0 +1,71 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "report.h"
+
+/* -------------------------
+ *   Per-endpoint report queue
+ * -------------------------
+ *
+ * Reports are staged here rather than waiting for the IN endpoint to become free, and are transmitted from the
+ * endpoint's IN-complete callback. A new report is merged into the last one still waiting if the host would end up
+ * seeing the same sequence of presses and releases, otherwise it is queued behind it. If the queue is full, the last
+ * waiting report from the same stream is overwritten regardless, or if there's none, an older report from a stream
+ * with a later one waiting is dropped to make room, so that the host always ends up in the latest state of every
+ * stream. This relies on the queue being at least as deep as the number of streams sharing the endpoint.
+ *
+ * None of these functions lock; the caller is responsible for that.
+ */
+
+/* Number of reports that can wait for each IN endpoint, in addition to the one being transmitted. Must be at least
+ * the number of reports sharing an endpoint. */
+#ifndef USB_REPORT_QUEUE_DEPTH
+#    define USB_REPORT_QUEUE_DEPTH 8
+#endif
+
+/* Largest report which can be queued */
+#ifndef USB_REPORT_QUEUE_REPORT_SIZE
+#    define USB_REPORT_QUEUE_REPORT_SIZE 32
+#endif
+
+/* How a report may be merged with the one before it */
+typedef enum {
+    USB_REPORT_BITMAP, // NKRO, programmable buttons -- merged if the earlier report only released bits the later one leaves alone
+    USB_REPORT_KEYS,   // 6KRO keyboard, as above with the trailing key array treated as a set
+    USB_REPORT_MOUSE,  // relative mouse -- motion is summed while the buttons don't change
+    USB_REPORT_VALUE,  // usages, axes, absolute positions -- only merged if the earlier report changed nothing
+} usb_report_kind_t;
+
+typedef struct {
+    union {
+        uint8_t        data[USB_REPORT_QUEUE_REPORT_SIZE];
+        report_mouse_t mouse;
+    };
+    uint8_t size;
+    uint8_t kind;
+    uint8_t report_id; // distinguishes the reports sharing an endpoint, 0 if there's only one
+} usb_report_t;
+
+typedef struct {
+    usb_report_t pending[USB_REPORT_QUEUE_DEPTH];
+    usb_report_t sent; // being transmitted if busy, otherwise the last report transmitted
+    uint8_t      head;
+    uint8_t      count;
+    bool         busy;
+    uint16_t     coalesced; // reports merged into one already waiting
+    uint16_t     dropped;   // waiting reports overwritten or dropped because the queue was full
+} usb_report_queue_t;
+
+/* Empties the queue, for when the endpoint is (re)configured */
+void usb_report_queue_init(usb_report_queue_t *queue);
+
+/* Stages a report. Returns the report to start transmitting if the endpoint was idle, otherwise NULL */
+const usb_report_t *usb_report_queue_push(usb_report_queue_t *queue, usb_report_kind_t kind, uint8_t report_id, const void *data, uint8_t size);
+
+/* Marks the current transmission as complete. Returns the next report to transmit, or NULL if there's none waiting */
+const usb_report_t *usb_report_queue_transmitted(usb_report_queue_t *queue);
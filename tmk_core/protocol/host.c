@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "host.h"
 #include "util.h"
 #include "debug.h"
+#include "latency_trace.h"
 
 #ifdef DIGITIZER_ENABLE
 #    include "digitizer.h"
@@ -75,7 +76,10 @@ led_t host_keyboard_led_state(void) {
 void host_keyboard_send(report_keyboard_t *report) {
 #ifdef BLUETOOTH_ENABLE
     if (where_to_send() == OUTPUT_BLUETOOTH) {
+        LATENCY_TRACE_BEGIN(LATENCY_STAGE_REPORT);
         bluetooth_send_keyboard(report);
+        LATENCY_TRACE_END(LATENCY_STAGE_REPORT);
+        LATENCY_TRACE_REPORT_SENT();
         return;
     }
 #endif
@@ -95,7 +99,10 @@ void host_keyboard_send(report_keyboard_t *report) {
         report->report_id = REPORT_ID_KEYBOARD;
 #endif
     }
+    LATENCY_TRACE_BEGIN(LATENCY_STAGE_REPORT);
     (*driver->send_keyboard)(report);
+    LATENCY_TRACE_END(LATENCY_STAGE_REPORT);
+    LATENCY_TRACE_REPORT_SENT();
 
     if (debug_keyboard) {
         dprint("keyboard_report: ");
@@ -126,6 +133,17 @@ void host_mouse_send(report_mouse_t *report) {
     (*driver->send_mouse)(report);
 }
 
+bool host_mouse_ready(void) {
+#ifdef BLUETOOTH_ENABLE
+    if (where_to_send() == OUTPUT_BLUETOOTH) {
+        return true;
+    }
+#endif
+
+    if (!driver || !driver->mouse_ready) return true;
+    return (*driver->mouse_ready)();
+}
+
 void host_system_send(uint16_t usage) {
     if (usage == last_system_usage) return;
     last_system_usage = usage;